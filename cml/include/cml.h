@@ -3,16 +3,21 @@
 
 // core-math-lib (cml)
 #include <cml_AABB.h>
+#include <cml_AABBTree.h>
 #include <cml_AABR.h>
+#include <cml_Batch.h>
 #include <cml_Cone.h>
 #include <cml_ConvexHull.h>
 #include <cml_CoordinateSystem.h>
 #include <cml_Cuboid.h>
 #include <cml_Cylinder.h>
 #include <cml_EulerAngles.h>
+#include <cml_FrustumCuller.h>
 #include <cml_Funnel.h>
 #include <cml_HV.h>
+#include <cml_MeshBVH.h>
 #include <cml_OBB.h>
+#include <cml_PathSmoother.h>
 #include <cml_Plane.h>
 #include <cml_Ray.h>
 #include <cml_Rectangle.h>
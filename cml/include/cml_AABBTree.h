@@ -0,0 +1,244 @@
+#pragma once
+
+
+#include <vector>
+#include <limits>
+#include <dpl_ReadOnly.h>
+#include "cml_AABB.h"
+
+
+namespace dpl
+{
+	class ThreadPool;
+}
+
+namespace cml
+{
+	/*
+		Dynamic bounding volume hierarchy over the fat AABBs of moving objects(incremental BVH).
+
+		Each object(proxy) is a leaf with bounds enlarged by the margin, so small moves do not change the tree.
+		Leaves are inserted next to the sibling with the lowest surface area cost and the tree is balanced with rotations,
+		so insert, remove and move take O(log n).
+		When most of the objects moved, rebuild creates the whole hierarchy again(in parallel if pool is given).
+		Proxy IDs stay valid until the proxy is removed(also after rebuild).
+	*/
+	class	AABBTree
+	{
+	public: // subtypes
+		struct	Node
+		{
+			Vec3		min;
+			uint32_t	parent;
+			Vec3		max;
+			uint32_t	height;			// 0 for leaf, INVALID_INDEX for unused node.
+			uint32_t	children[2];	// INVALID_INDEX for leaf.
+			uint32_t	userData;
+		};
+
+	public: // constants
+		static const uint32_t	INVALID_INDEX				= std::numeric_limits<uint32_t>::max();
+		static const uint32_t	MAX_HEIGHT					= 64;	// Trees up to 2 * MAX_HEIGHT - 1 are traversed without heap allocations.
+		static const uint32_t	PARALLEL_BUILD_THRESHOLD	= 4096;	// Minimal number of leaves in the subtree built by a separate task.
+		static constexpr float	DEFAULT_MARGIN				= 0.1f;
+		static constexpr float	DISPLACEMENT_FACTOR			= 2.f;	// Fat bounds are extended in the direction of the movement.
+		static constexpr float	MAX_MARGIN_FACTOR			= 4.f;	// Fat bounds larger than margin * MAX_MARGIN_FACTOR are shrunk on move.
+
+	public: // subtypes
+		/*
+			Stack of the depth-first traversal of the subtree with the given height.
+			It holds at most one node per level(two on the deepest one), so height + 1 entries,
+			which are kept in place unless the subtree is higher than 2 * MAX_HEIGHT - 1.
+		*/
+		template<typename T>
+		class	TraversalStack
+		{
+		private: // data
+			T				m_local[2 * MAX_HEIGHT];
+			std::vector<T>	m_heap;
+			T*				m_data;
+			uint32_t		m_size;
+
+		public: // lifecycle
+			CLASS_CTOR		TraversalStack(		const uint32_t		HEIGHT)
+				: m_data(m_local)
+				, m_size(0)
+			{
+				if(HEIGHT >= 2 * MAX_HEIGHT)
+				{
+					m_heap.resize(HEIGHT + 1);
+					m_data = m_heap.data();
+				}
+			}
+
+			CLASS_CTOR		TraversalStack(		const TraversalStack&	OTHER) = delete;
+
+			TraversalStack&	operator=(			const TraversalStack&	OTHER) = delete;
+
+		public: // functions
+			inline bool		empty() const
+			{
+				return m_size == 0;
+			}
+
+			inline void		push(				const T&			VALUE)
+			{
+				m_data[m_size++] = VALUE;
+			}
+
+			inline T		pop()
+			{
+				return m_data[--m_size];
+			}
+		};
+
+	public: // data
+		dpl::ReadOnly<std::vector<Node>,	AABBTree> nodes;
+		dpl::ReadOnly<uint32_t,				AABBTree> root;
+		dpl::ReadOnly<uint32_t,				AABBTree> numProxies;
+		dpl::ReadOnly<float,				AABBTree> margin;
+
+	private: // data
+		std::vector<uint32_t> m_freeNodes;
+
+	public: // lifecycle
+		CLASS_CTOR					AABBTree(			const float			MARGIN = DEFAULT_MARGIN);
+
+	public: // functions
+		inline bool					empty() const
+		{
+			return root() == INVALID_INDEX;
+		}
+
+		inline uint32_t				get_height() const
+		{
+			return empty()? 0 : nodes()[root()].height;
+		}
+
+		inline AABB					get_fat_bounds(		const uint32_t		PROXY) const
+		{
+			return AABB(nodes()[PROXY].min, nodes()[PROXY].max);
+		}
+
+		inline uint32_t				get_userData(		const uint32_t		PROXY) const
+		{
+			return nodes()[PROXY].userData;
+		}
+
+		/*
+			Returns ID of the new proxy.
+		*/
+		uint32_t					insert(				const AABB&			BOUNDS,
+														const uint32_t		USER_DATA);
+
+		void						remove(				const uint32_t		PROXY);
+
+		/*
+			Returns true if proxy was reinserted(new bounds are not inside of the fat bounds or fat bounds are too large).
+			DISPLACEMENT is the predicted movement of the object.
+		*/
+		bool						move(				const uint32_t		PROXY,
+														const AABB&			BOUNDS,
+														const Vec3&			DISPLACEMENT = Vec3(0.f, 0.f, 0.f));
+
+		/*
+			Creates hierarchy again from the current fat bounds(median split along the longest axis of the centroids).
+			Subtrees larger than PARALLEL_BUILD_THRESHOLD are built in parallel if pool is given.
+		*/
+		void						rebuild(			dpl::ThreadPool*	pool = nullptr);
+
+		void						clear();
+
+		/*
+			Sum of the surface areas of the internal nodes divided by the area of the root(quality of the tree, lower is better).
+		*/
+		float						calculate_area_ratio() const;
+
+	public: // queries
+		/*
+			Calls FUNCTION(PROXY) for each proxy with fat bounds that intersect the SHAPE(any type accepted by AABB::intersects).
+			Query stops when FUNCTION returns false.
+		*/
+		template<typename ShapeT, typename FunctionT>
+		void						query(				const ShapeT&		SHAPE,
+														FunctionT&&			function) const
+		{
+			if(empty()) return;
+
+			TraversalStack<uint32_t> stack(get_height());
+			stack.push(root());
+
+			while(!stack.empty())
+			{
+				const uint32_t	NODE_INDEX	= stack.pop();
+				const Node&		NODE		= nodes()[NODE_INDEX];
+				if(!overlaps(NODE, SHAPE)) continue;
+
+				if(NODE.height == 0)
+				{
+					if(!function(NODE_INDEX)) return;
+				}
+				else
+				{
+					stack.push(NODE.children[0]);
+					stack.push(NODE.children[1]);
+				}
+			}
+		}
+
+		/*
+			Appends IDs of the proxies intersecting the SHAPE to the output.
+		*/
+		template<typename ShapeT>
+		inline void					query(				const ShapeT&		SHAPE,
+														std::vector<uint32_t>& output) const
+		{
+			query(SHAPE, [&](const uint32_t PROXY){ output.push_back(PROXY); return true; });
+		}
+
+	private: // functions
+		template<typename ShapeT>
+		static inline bool			overlaps(			const Node&			NODE,
+														const ShapeT&		SHAPE)
+		{
+			return AABB(NODE.min, NODE.max).intersects(SHAPE);
+		}
+
+		static inline bool			overlaps(			const Node&			NODE,
+														const AABB&			BOX)
+		{
+			const Vec3 MIN = BOX.min();
+			const Vec3 MAX = BOX.max();
+			return NODE.min.x <= MAX.x && MIN.x <= NODE.max.x
+				&& NODE.min.y <= MAX.y && MIN.y <= NODE.max.y
+				&& NODE.min.z <= MAX.z && MIN.z <= NODE.max.z;
+		}
+
+		uint32_t					allocate_node();
+
+		void						free_node(			const uint32_t		NODE_INDEX);
+
+		void						insert_leaf(		const uint32_t		LEAF);
+
+		void						remove_leaf(		const uint32_t		LEAF);
+
+		/*
+			Rebalances nodes from NODE_INDEX to the root and updates their bounds and heights.
+		*/
+		void						refit_upwards(		uint32_t			nodeIndex);
+
+		/*
+			Rotates the node if its subtrees differ in height by more than 1, returns node that took its place.
+		*/
+		uint32_t					balance(			const uint32_t		NODE_INDEX);
+
+		struct	BuildData;
+
+		void						build_node(			BuildData&			data,
+														const uint32_t		BEGIN,
+														const uint32_t		END,
+														const uint32_t		FIRST_INTERNAL,
+														const uint32_t		PARENT,
+														dpl::ThreadPool*	pool);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,321 @@
+#pragma once
+
+
+#include <bit>
+#include <vector>
+#include <dpl_ReadOnly.h>
+#include "cml_utilities.h"
+
+
+namespace dpl
+{
+	class ThreadPool;
+}
+
+namespace cml
+{
+	class Ray;
+	class AABB;
+	class OBB;
+	class Sphere;
+	class Plane;
+	class ConvexHull;
+	class EulerAngles;
+
+
+
+	/*
+		Result of the batch test: bit N is set if object N passed the test.
+	*/
+	class	BatchMask
+	{
+	public: // data
+		dpl::ReadOnly<std::vector<uint64_t>,	BatchMask> words;
+		dpl::ReadOnly<uint32_t,					BatchMask> size;
+
+	public: // lifecycle
+		CLASS_CTOR				BatchMask()
+			: size(0)
+		{
+
+		}
+
+	public: // functions
+		inline bool				at(					const uint32_t		INDEX) const
+		{
+			return (words()[INDEX >> 6] >> (INDEX & 63)) & 1;
+		}
+
+		uint32_t				count() const;
+
+		/*
+			Calls FUNCTION(INDEX) for each set bit.
+		*/
+		template<typename FunctionT>
+		inline void				for_each_set(		FunctionT&&			function) const
+		{
+			for(uint32_t wordID = 0; wordID < words().size(); ++wordID)
+			{
+				for(uint64_t word = words()[wordID]; word != 0; word &= word - 1)
+				{
+					function((wordID << 6) + static_cast<uint32_t>(std::countr_zero(word)));
+				}
+			}
+		}
+
+	public: // kernel output
+		/*
+			Resizes mask to NEW_SIZE bits, all cleared.
+		*/
+		void					reset(				const uint32_t		NEW_SIZE);
+
+		inline void				set_lanes(			const uint32_t		FIRST_INDEX,
+													const uint32_t		LANE_BITS)
+		{
+			(*words)[FIRST_INDEX >> 6] |= uint64_t(LANE_BITS) << (FIRST_INDEX & 63);
+		}
+
+		/*
+			Clears bits of the padding lanes.
+		*/
+		void					clear_tail();
+	};
+
+
+	/*
+		Structure of arrays of AABBs, tested in groups of BATCH_WIDTH boxes(SSE/AVX when available).
+		Batch tests give exactly the same results as the scalar AABB functions.
+	*/
+	class	AABBPacket
+	{
+	public: // constants
+		static const uint32_t BATCH_WIDTH = 8; // Arrays are padded to the multiple of this value.
+
+	public: // data
+		dpl::ReadOnly<uint32_t, AABBPacket> size;
+
+	private: // data
+		std::vector<float> m_centerX;
+		std::vector<float> m_centerY;
+		std::vector<float> m_centerZ;
+		std::vector<float> m_halfWidth;
+		std::vector<float> m_halfHeight;
+		std::vector<float> m_halfDepth;
+
+	public: // lifecycle
+		CLASS_CTOR				AABBPacket()
+			: size(0)
+		{
+
+		}
+
+		CLASS_CTOR				AABBPacket(			const AABB*			BOXES,
+													const uint32_t		NUM_BOXES);
+
+		/*
+			Packet of the world bounds(see transform_bounds).
+		*/
+		CLASS_CTOR				AABBPacket(			const AABB*			LOCAL_BOXES,
+													const Mat4*			TRANSFORMATIONS,
+													const uint32_t		NUM_BOXES,
+													dpl::ThreadPool*	pool = nullptr);
+
+	public: // functions
+		void					reserve(			const uint32_t		NUM_BOXES);
+
+		void					clear();
+
+		void					add(				const AABB&			BOX);
+
+		void					set(				const uint32_t		INDEX,
+													const AABB&			BOX);
+
+		AABB					get(				const uint32_t		INDEX) const;
+
+		/*
+			Replaces content with the world bounds(see transform_bounds), without the intermediate array of AABBs.
+		*/
+		void					reset(				const AABB*			LOCAL_BOXES,
+													const Mat4*			TRANSFORMATIONS,
+													const uint32_t		NUM_BOXES,
+													dpl::ThreadPool*	pool = nullptr);
+
+	public: // batch tests
+		void					above(				const Plane&		PLANE,
+													BatchMask&			result) const;
+
+		void					intersects(			const Plane&		PLANE,
+													BatchMask&			result) const;
+
+		/*
+			Frustum culling: bit is set if box is not entirely above any of the faces.
+		*/
+		void					intersects(			const ConvexHull&	HULL,
+													BatchMask&			result) const;
+
+		void					intersects(			const Ray&			RAY,
+													BatchMask&			result) const;
+
+	private: // functions
+		void					resize_padded(		const uint32_t		NEW_SIZE);
+	};
+
+
+	/*
+		Structure of arrays of spheres, tested in groups of BATCH_WIDTH spheres(SSE/AVX when available).
+		Batch tests give exactly the same results as the scalar Sphere functions.
+	*/
+	class	SpherePacket
+	{
+	public: // constants
+		static const uint32_t BATCH_WIDTH = AABBPacket::BATCH_WIDTH;
+
+	public: // data
+		dpl::ReadOnly<uint32_t, SpherePacket> size;
+
+	private: // data
+		std::vector<float> m_centerX;
+		std::vector<float> m_centerY;
+		std::vector<float> m_centerZ;
+		std::vector<float> m_radius;
+
+	public: // lifecycle
+		CLASS_CTOR				SpherePacket()
+			: size(0)
+		{
+
+		}
+
+		CLASS_CTOR				SpherePacket(		const Sphere*		SPHERES,
+													const uint32_t		NUM_SPHERES);
+
+	public: // functions
+		void					reserve(			const uint32_t		NUM_SPHERES);
+
+		void					clear();
+
+		void					add(				const Sphere&		SPHERE);
+
+		void					set(				const uint32_t		INDEX,
+													const Sphere&		SPHERE);
+
+		Sphere					get(				const uint32_t		INDEX) const;
+
+	public: // batch tests
+		void					above(				const Plane&		PLANE,
+													BatchMask&			result) const;
+
+		void					below(				const Plane&		PLANE,
+													BatchMask&			result) const;
+
+		void					intersects(			const Plane&		PLANE,
+													BatchMask&			result) const;
+
+		/*
+			Frustum culling: bit is set if sphere is not entirely above any of the faces.
+		*/
+		void					intersects(			const ConvexHull&	HULL,
+													BatchMask&			result) const;
+
+		void					intersects(			const Ray&			RAY,
+													BatchMask&			result) const;
+
+	private: // functions
+		void					resize_padded(		const uint32_t		NEW_SIZE);
+	};
+
+
+
+	/*
+		Structure of arrays of EulerAngles(yaw -> pitch -> roll), converted in groups of BATCH_WIDTH angles(SSE/AVX when available).
+		FAST conversions use LaneMath approximations of sin/cos and atan2: components of the quaternions and angles
+		differ from the scalar results by less than 1e-6, elements of the matrices by less than 2e-6.
+		PRECISE conversions give exactly the same results as the scalar EulerAngles functions.
+	*/
+	class	EulerAnglesPacket
+	{
+	public: // subtypes
+		enum class Precision
+		{
+			FAST,
+			PRECISE
+		};
+
+	public: // constants
+		static const uint32_t BATCH_WIDTH = AABBPacket::BATCH_WIDTH;
+
+	public: // data
+		dpl::ReadOnly<uint32_t, EulerAnglesPacket> size;
+
+	private: // data
+		std::vector<float> m_yaw;
+		std::vector<float> m_pitch;
+		std::vector<float> m_roll;
+
+	public: // lifecycle
+		CLASS_CTOR				EulerAnglesPacket()
+			: size(0)
+		{
+
+		}
+
+		CLASS_CTOR				EulerAnglesPacket(	const EulerAngles*	ANGLES,
+													const uint32_t		NUM_ANGLES);
+
+		CLASS_CTOR				EulerAnglesPacket(	const Quat*			ROTATIONS,
+													const uint32_t		NUM_ROTATIONS,
+													const Precision		PRECISION = Precision::FAST);
+
+	public: // functions
+		void					reserve(			const uint32_t		NUM_ANGLES);
+
+		void					clear();
+
+		void					add(				const EulerAngles&	ANGLES);
+
+		void					set(				const uint32_t		INDEX,
+													const EulerAngles&	ANGLES);
+
+		EulerAngles				get(				const uint32_t		INDEX) const;
+
+	public: // conversions
+		/*
+			Replaces content with angles extracted from the quaternions(see EulerAngles::set_from_quat).
+		*/
+		void					reset(				const Quat*			ROTATIONS,
+													const uint32_t		NUM_ROTATIONS,
+													const Precision		PRECISION = Precision::FAST);
+
+		/*
+			Writes size quaternions to the output(see EulerAngles::to_quat).
+		*/
+		void					to_quats(			Quat*				output,
+													const Precision		PRECISION = Precision::FAST) const;
+
+		/*
+			Writes size rotation matrices to the output(same as glm::mat3_cast of the quaternions).
+		*/
+		void					to_matrices(		Mat3*				output,
+													const Precision		PRECISION = Precision::FAST) const;
+
+	private: // functions
+		void					resize_padded(		const uint32_t		NEW_SIZE);
+	};
+
+	/*
+		Batch bounds update: output[N] receives LOCAL_BOXES[N] transformed by TRANSFORMATIONS[N].
+		World AABB is the smallest box enclosing the transformed one(same as AABB of the OBB from AABB::operator*).
+		Instances are split into chunks processed in parallel if pool is given.
+	*/
+	void	transform_bounds(	const AABB*			LOCAL_BOXES,
+								const Mat4*			TRANSFORMATIONS,
+								const uint32_t		NUM_INSTANCES,
+								AABB*				output,
+								dpl::ThreadPool*	pool = nullptr);
+
+	void	transform_bounds(	const AABB*			LOCAL_BOXES,
+								const Mat4*			TRANSFORMATIONS,
+								const uint32_t		NUM_INSTANCES,
+								OBB*				output,
+								dpl::ThreadPool*	pool = nullptr);
+}
\ No newline at end of file
@@ -114,7 +114,19 @@ namespace cml
 		/*
 			Converts yaw -> pitch -> roll to quaternion.
 		*/
-		Quat			to_quat() const;
+		inline Quat		to_quat() const
+		{
+			return to_quat(yaw(), pitch(), roll());
+		}
+
+		static Quat		to_quat(			const float			YAW_RADIANS,
+											const float			PITCH_RADIANS,
+											const float			ROLL_RADIANS);
+
+		/*
+			Returns yaw, pitch, roll extracted from given quaternion, packed to xyz respectively(same values as set_from_quat).
+		*/
+		static Vec3		calculate_angles(	const Quat&			ROTATION);
 
 		/*
 			Packs yaw -> pitch -> roll to xyz respectively.
@@ -0,0 +1,116 @@
+#pragma once
+
+
+#include <vector>
+#include <limits>
+#include <dpl_ReadOnly.h>
+#include "cml_AABBTree.h"
+
+
+namespace dpl
+{
+	class ThreadPool;
+}
+
+namespace cml
+{
+	class ConvexHull;
+
+
+	/*
+		Collects user data of the AABBTree proxies visible from many views(one per render target).
+
+		Each view is a ConvexHull(camera frustum or any other set of planes with normals pointing outwards).
+		Tree is traversed with a mask of planes that still have to be tested: children skip planes their parent is entirely below of,
+		subtrees inside of all planes are gathered without tests.
+		Plane that rejected a node is remembered per view and tested first in the next cull(coherence between frames).
+		Upper levels of the tree are split into tasks processed in parallel if pool is given.
+	*/
+	class	FrustumCuller
+	{
+	public: // constants
+		static const uint32_t MAX_PLANES	= 32;
+		static const uint32_t TASK_HEIGHT	= 8;	// Subtrees with this height or lower are culled by a single task.
+
+	private: // subtypes
+		struct	FrustumPlane
+		{
+			Vec3	normal;
+			Vec3	absNormal;
+			float	distance;
+		};
+
+		struct	View
+		{
+			std::vector<FrustumPlane>	planes;
+			std::vector<uint8_t>		lastPlanes;	// Plane that rejected the node in the previous cull(indexed by node).
+		};
+
+		struct	Task
+		{
+			uint32_t				view;
+			uint32_t				node;
+			uint32_t				mask;
+			std::vector<uint32_t>	visible;
+		};
+
+	public: // data
+		dpl::ReadOnly<std::vector<std::vector<uint32_t>>, FrustumCuller> visible; // User data of the visible proxies per view.
+
+	private: // data
+		std::vector<View>	m_views;
+		std::vector<Task>	m_tasks;
+		uint32_t			m_numTasks = 0;
+
+	public: // functions
+		/*
+			Extracts 6 planes from the OpenGL clip space(Gribb-Hartmann): left, right, bottom, top, near, far.
+		*/
+		static ConvexHull		extract_frustum(	const Mat4&			VIEW_PROJECTION);
+
+		/*
+			Overwrites visible lists, list N contains user data of the proxies(fat bounds) that intersect FRUSTUMS[N].
+			Order of the user data is the same with and without pool.
+		*/
+		void					cull(				const AABBTree&		TREE,
+													const ConvexHull*	FRUSTUMS,
+													const uint32_t		NUM_VIEWS,
+													dpl::ThreadPool*	pool = nullptr);
+
+		inline const std::vector<uint32_t>&	get_visible(const uint32_t	VIEW) const
+		{
+			return visible()[VIEW];
+		}
+
+		void					clear();
+
+	private: // functions
+		void					prepare_view(		const AABBTree&		TREE,
+													const ConvexHull&	FRUSTUM,
+													View&				view);
+
+		/*
+			Tests the node against planes in the mask, clears bits of the planes that node is entirely below of.
+			Returns false if node is entirely above any plane.
+		*/
+		static bool				classify(			const AABBTree::Node& NODE,
+													const FrustumPlane*	PLANES,
+													const uint32_t		NUM_PLANES,
+													uint8_t&			lastPlane,
+													uint32_t&			mask);
+
+		/*
+			Creates tasks for the visible subtrees of TASK_HEIGHT or lower(or entirely visible ones).
+		*/
+		void					split(				const AABBTree&		TREE,
+													const uint32_t		VIEW,
+													const uint32_t		NODE_INDEX,
+													uint32_t			mask);
+
+		static void				cull_subtree(		const AABBTree&		TREE,
+													View&				view,
+													const uint32_t		NODE_INDEX,
+													const uint32_t		MASK,
+													std::vector<uint32_t>& output);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+
+
+#include <cmath>
+#include <stdint.h>
+
+#if defined(__AVX__)
+#define CML_LANES_NAMESPACE avx
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CML_LANES_SSE
+#define CML_LANES_NAMESPACE sse
+#include <emmintrin.h>
+#else
+#define CML_LANES_NAMESPACE scalar
+#endif
+
+
+namespace cml
+{
+	/*
+		Layout of Lanes depends on the compilation flags, so each variant is placed in its own inline namespace.
+		Translation units compiled with different instruction sets(e.g. /arch:AVX for one file) use distinct types instead of breaking ODR.
+	*/
+	inline namespace CML_LANES_NAMESPACE
+	{
+		/*
+			Registers of the widest instruction set enabled for the compilation(AVX, SSE or scalar fallback).
+			Kernels are written once against this interface.
+			Note: masked(M, A) returns A in the lanes where M is set and zero elsewhere, select(M, A, B) returns B instead of zero.
+		*/
+#if defined(__AVX__)
+		struct	Lanes
+		{
+			using	Reg		= __m256;
+			using	Mask	= __m256;
+
+			static const uint32_t WIDTH = 8;
+
+			static inline Reg		load(		const float*	DATA)					{ return _mm256_loadu_ps(DATA); }
+			static inline void		store(		float*			data,	const Reg A)	{ _mm256_storeu_ps(data, A); }
+			static inline Reg		set(		const float		VALUE)					{ return _mm256_set1_ps(VALUE); }
+			static inline Reg		add(		const Reg A,	const Reg B)			{ return _mm256_add_ps(A, B); }
+			static inline Reg		sub(		const Reg A,	const Reg B)			{ return _mm256_sub_ps(A, B); }
+			static inline Reg		mul(		const Reg A,	const Reg B)			{ return _mm256_mul_ps(A, B); }
+			static inline Reg		div(		const Reg A,	const Reg B)			{ return _mm256_div_ps(A, B); }
+			static inline Reg		min(		const Reg A,	const Reg B)			{ return _mm256_min_ps(A, B); }
+			static inline Reg		max(		const Reg A,	const Reg B)			{ return _mm256_max_ps(A, B); }
+			static inline Reg		sqrt(		const Reg A)							{ return _mm256_sqrt_ps(A); }
+			static inline Reg		abs(		const Reg A)							{ return _mm256_andnot_ps(_mm256_set1_ps(-0.f), A); }
+			static inline Mask		less(		const Reg A,	const Reg B)			{ return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+			static inline Mask		less_equal(	const Reg A,	const Reg B)			{ return _mm256_cmp_ps(A, B, _CMP_LE_OQ); }
+			static inline Mask		greater(	const Reg A,	const Reg B)			{ return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+			static inline Mask		both(		const Mask A,	const Mask B)			{ return _mm256_and_ps(A, B); }
+			static inline Mask		either(		const Mask A,	const Mask B)			{ return _mm256_or_ps(A, B); }
+			static inline Mask		only_first(	const Mask A,	const Mask B)			{ return _mm256_andnot_ps(B, A); }
+			static inline Mask		none()													{ return _mm256_setzero_ps(); }
+			static inline Reg		masked(		const Mask M,	const Reg A)			{ return _mm256_and_ps(M, A); }
+			static inline Reg		select(		const Mask M,	const Reg A, const Reg B)	{ return _mm256_blendv_ps(B, A, M); }
+			static inline Mask		all()													{ return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+			static inline uint32_t	bits(		const Mask M)							{ return static_cast<uint32_t>(_mm256_movemask_ps(M)); }
+		};
+#elif defined(CML_LANES_SSE)
+		struct	Lanes
+		{
+			using	Reg		= __m128;
+			using	Mask	= __m128;
+
+			static const uint32_t WIDTH = 4;
+
+			static inline Reg		load(		const float*	DATA)					{ return _mm_loadu_ps(DATA); }
+			static inline void		store(		float*			data,	const Reg A)	{ _mm_storeu_ps(data, A); }
+			static inline Reg		set(		const float		VALUE)					{ return _mm_set1_ps(VALUE); }
+			static inline Reg		add(		const Reg A,	const Reg B)			{ return _mm_add_ps(A, B); }
+			static inline Reg		sub(		const Reg A,	const Reg B)			{ return _mm_sub_ps(A, B); }
+			static inline Reg		mul(		const Reg A,	const Reg B)			{ return _mm_mul_ps(A, B); }
+			static inline Reg		div(		const Reg A,	const Reg B)			{ return _mm_div_ps(A, B); }
+			static inline Reg		min(		const Reg A,	const Reg B)			{ return _mm_min_ps(A, B); }
+			static inline Reg		max(		const Reg A,	const Reg B)			{ return _mm_max_ps(A, B); }
+			static inline Reg		sqrt(		const Reg A)							{ return _mm_sqrt_ps(A); }
+			static inline Reg		abs(		const Reg A)							{ return _mm_andnot_ps(_mm_set1_ps(-0.f), A); }
+			static inline Mask		less(		const Reg A,	const Reg B)			{ return _mm_cmplt_ps(A, B); }
+			static inline Mask		less_equal(	const Reg A,	const Reg B)			{ return _mm_cmple_ps(A, B); }
+			static inline Mask		greater(	const Reg A,	const Reg B)			{ return _mm_cmpgt_ps(A, B); }
+			static inline Mask		both(		const Mask A,	const Mask B)			{ return _mm_and_ps(A, B); }
+			static inline Mask		either(		const Mask A,	const Mask B)			{ return _mm_or_ps(A, B); }
+			static inline Mask		only_first(	const Mask A,	const Mask B)			{ return _mm_andnot_ps(B, A); }
+			static inline Mask		none()													{ return _mm_setzero_ps(); }
+			static inline Reg		masked(		const Mask M,	const Reg A)			{ return _mm_and_ps(M, A); }
+			static inline Reg		select(		const Mask M,	const Reg A, const Reg B)	{ return _mm_or_ps(_mm_and_ps(M, A), _mm_andnot_ps(M, B)); }
+			static inline Mask		all()													{ return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+			static inline uint32_t	bits(		const Mask M)							{ return static_cast<uint32_t>(_mm_movemask_ps(M)); }
+		};
+#else
+		struct	Lanes
+		{
+			using	Reg		= float;
+			using	Mask	= bool;
+
+			static const uint32_t WIDTH = 1;
+
+			static inline Reg		load(		const float*	DATA)					{ return *DATA; }
+			static inline void		store(		float*			data,	const Reg A)	{ *data = A; }
+			static inline Reg		set(		const float		VALUE)					{ return VALUE; }
+			static inline Reg		add(		const Reg A,	const Reg B)			{ return A + B; }
+			static inline Reg		sub(		const Reg A,	const Reg B)			{ return A - B; }
+			static inline Reg		mul(		const Reg A,	const Reg B)			{ return A * B; }
+			static inline Reg		div(		const Reg A,	const Reg B)			{ return A / B; }
+			static inline Reg		min(		const Reg A,	const Reg B)			{ return (A < B)? A : B; }
+			static inline Reg		max(		const Reg A,	const Reg B)			{ return (A > B)? A : B; }
+			static inline Reg		sqrt(		const Reg A)							{ return std::sqrt(A); }
+			static inline Reg		abs(		const Reg A)							{ return std::abs(A); }
+			static inline Mask		less(		const Reg A,	const Reg B)			{ return A < B; }
+			static inline Mask		less_equal(	const Reg A,	const Reg B)			{ return A <= B; }
+			static inline Mask		greater(	const Reg A,	const Reg B)			{ return A > B; }
+			static inline Mask		both(		const Mask A,	const Mask B)			{ return A && B; }
+			static inline Mask		either(		const Mask A,	const Mask B)			{ return A || B; }
+			static inline Mask		only_first(	const Mask A,	const Mask B)			{ return A && !B; }
+			static inline Mask		none()													{ return false; }
+			static inline Reg		masked(		const Mask M,	const Reg A)			{ return M? A : 0.f; }
+			static inline Reg		select(		const Mask M,	const Reg A, const Reg B)	{ return M? A : B; }
+			static inline Mask		all()													{ return true; }
+			static inline uint32_t	bits(		const Mask M)							{ return M? 1 : 0; }
+		};
+#endif
+
+
+		/*
+			Polynomial(minimax) approximations evaluated on Lanes.
+		*/
+		struct	LaneMath
+		{
+			/*
+				Sine and cosine of X in range <-PI, +PI>(absolute error is below 2.5e-7).
+				Arguments outside of the <-PI/2, +PI/2> are reflected: sin(PI - X) = sin(X), cos(PI - X) = -cos(X).
+			*/
+			static inline void			sin_cos(	const Lanes::Reg	X,
+													Lanes::Reg&			sin,
+													Lanes::Reg&			cos)
+			{
+				const Lanes::Reg	HALF_PI = Lanes::set(1.57079633f);
+				const Lanes::Mask	ABOVE	= Lanes::greater(X, HALF_PI);
+				const Lanes::Mask	BELOW	= Lanes::less(X, Lanes::sub(Lanes::set(0.f), HALF_PI));
+				const Lanes::Reg	R		= Lanes::select(ABOVE, Lanes::sub(Lanes::set(3.14159265f), X), 
+											  Lanes::select(BELOW, Lanes::sub(Lanes::set(-3.14159265f), X), X));
+				const Lanes::Reg	R2		= Lanes::mul(R, R);
+
+				sin = Lanes::add(Lanes::mul(Lanes::set(2.59049034e-06f), R2), Lanes::set(-1.98008987e-04f));
+				sin = Lanes::add(Lanes::mul(sin, R2), Lanes::set(8.33289977e-03f));
+				sin = Lanes::add(Lanes::mul(sin, R2), Lanes::set(-1.66666478e-01f));
+				sin = Lanes::add(Lanes::mul(Lanes::mul(sin, R2), R), R);
+
+				cos = Lanes::add(Lanes::mul(Lanes::set(2.31540762e-05f), R2), Lanes::set(-1.38537132e-03f));
+				cos = Lanes::add(Lanes::mul(cos, R2), Lanes::set(4.16635871e-02f));
+				cos = Lanes::add(Lanes::mul(cos, R2), Lanes::set(-4.99999046e-01f));
+				cos = Lanes::add(Lanes::mul(cos, R2), Lanes::set(9.99999940e-01f));
+				cos = Lanes::select(Lanes::either(ABOVE, BELOW), Lanes::sub(Lanes::set(0.f), cos), cos);
+			}
+
+			/*
+				atan2(Y, X) in range <-PI, +PI>, zero if both arguments are zero(absolute error is below 4e-7 radians).
+			*/
+			static inline Lanes::Reg	atan2(		const Lanes::Reg	Y,
+													const Lanes::Reg	X)
+			{
+				const Lanes::Reg ZERO	= Lanes::set(0.f);
+				const Lanes::Reg ABS_X	= Lanes::abs(X);
+				const Lanes::Reg ABS_Y	= Lanes::abs(Y);
+				const Lanes::Reg MAX	= Lanes::max(ABS_X, ABS_Y);
+				const Lanes::Reg T		= Lanes::masked(Lanes::greater(MAX, ZERO), Lanes::div(Lanes::min(ABS_X, ABS_Y), MAX));
+				const Lanes::Reg T2		= Lanes::mul(T, T);
+
+				Lanes::Reg	angle = Lanes::add(Lanes::mul(Lanes::set(-4.05468326e-03f), T2), Lanes::set(2.18633749e-02f));
+							angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(-5.59129193e-02f));
+							angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(9.64223966e-02f));
+							angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(-1.39086455e-01f));
+							angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(1.99465692e-01f));
+							angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(-3.33298624e-01f));
+							angle = Lanes::mul(Lanes::add(Lanes::mul(angle, T2), Lanes::set(9.99999344e-01f)), T);
+							angle = Lanes::select(Lanes::greater(ABS_Y, ABS_X), Lanes::sub(Lanes::set(1.57079633f), angle), angle);
+							angle = Lanes::select(Lanes::less(X, ZERO), Lanes::sub(Lanes::set(3.14159265f), angle), angle);
+				return		Lanes::select(Lanes::less(Y, ZERO), Lanes::sub(ZERO, angle), angle);
+			}
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <optional>
+#include <dpl_ReadOnly.h>
+#include <dpl_ThreadPool.h>
+#include "cml_TriangleMesh.h"
+
+
+namespace cml
+{
+	class Ray;
+	class AABB;
+	class OBB;
+	class Sphere;
+
+
+
+	/*
+		Bounding volume hierarchy over the triangles of the TriangleMesh(binned SAH build).
+
+		Hierarchy keeps a pointer to the mesh, so the mesh must outlive it.
+		When mesh vertices move(same topology), call refit instead of build.
+
+		Nodes are 32 bytes, or 16 bytes when quantized(bounds are snapped outwards to the 16 bit grid of the root bounds,
+		so queries stay conservative, but traversal visits slightly more nodes).
+	*/
+	class	MeshBVH
+	{
+	public: // subtypes
+		struct	Node
+		{
+			Vec3		min;
+			uint32_t	index;		// First child(internal node) or first triangle(leaf).
+			Vec3		max;
+			uint32_t	count;		// Number of triangles(0 for internal node, children are at index and index+1).
+		};
+
+		struct	QuantizedNode
+		{
+			uint16_t	min[3];
+			uint16_t	max[3];
+			uint32_t	data;		// [31] leaf flag, [30:4] first child or triangle, [3:0] number of triangles - 1.
+		};
+
+		struct	Settings
+		{
+			uint32_t	maxLeafSize;	// Must be in range [1, 16].
+			uint32_t	numBins;		// Number of SAH bins per axis, must be in range [2, 64].
+			bool		bQuantized;
+
+			CLASS_CTOR	Settings(	const uint32_t	MAX_LEAF_SIZE	= 4,
+									const uint32_t	NUM_BINS		= 16,
+									const bool		bQUANTIZED		= false)
+				: maxLeafSize(MAX_LEAF_SIZE)
+				, numBins(NUM_BINS)
+				, bQuantized(bQUANTIZED)
+			{
+
+			}
+		};
+
+		struct	RayHit
+		{
+			float		distance;
+			uint32_t	triangle;		// Offset of the first index of the triangle / 3.
+			Vec2		barycentric;	// Weights of the second and third vertex.
+		};
+
+		struct	ClosestPoint
+		{
+			Vec3		point;
+			float		distance;
+			uint32_t	triangle;
+		};
+
+	public: // constants
+		static const uint32_t PARALLEL_BUILD_THRESHOLD	= 4096;	// Minimal number of triangles in the subtree built by a separate task.
+		static const uint32_t MAX_DEPTH					= 64;
+
+	public: // data
+		dpl::ReadOnly<Settings, MeshBVH> settings;
+
+	private: // data
+		const TriangleMesh*			m_mesh;
+		std::vector<Node>			m_nodes;
+		std::vector<QuantizedNode>	m_quantizedNodes;
+		std::vector<uint32_t>		m_triangles;	// Triangle IDs in leaf order.
+		std::atomic_uint32_t		m_numNodes;		// Used during the build.
+		Vec3						m_gridOrigin;	// Dequantization of the node bounds.
+		Vec3						m_gridScale;
+
+	public: // lifecycle
+		CLASS_CTOR					MeshBVH();
+
+		CLASS_CTOR					MeshBVH(			const MeshBVH&		OTHER) = delete;
+
+		MeshBVH&					operator=(			const MeshBVH&		OTHER) = delete;
+
+	public: // functions
+		inline bool					empty() const
+		{
+			return get_numNodes() == 0;
+		}
+
+		inline uint32_t				get_numNodes() const
+		{
+			return settings().bQuantized? static_cast<uint32_t>(m_quantizedNodes.size()) : static_cast<uint32_t>(m_nodes.size());
+		}
+
+		inline const TriangleMesh*	get_mesh() const
+		{
+			return m_mesh;
+		}
+
+		/*
+			Builds hierarchy over all triangles of the mesh.
+			Subtrees larger than PARALLEL_BUILD_THRESHOLD are built in parallel if pool is given.
+		*/
+		void						build(				const TriangleMesh&	MESH,
+														const Settings&		SETTINGS = Settings(),
+														dpl::ThreadPool*	pool = nullptr);
+
+		/*
+			Updates bounds after the mesh vertices were moved.
+			Note: Number of triangles and indices must not change.
+		*/
+		void						refit();
+
+		void						clear();
+
+	public: // queries
+		std::optional<RayHit>		raycast(			const Ray&			RAY,
+														const float			MAX_DISTANCE = FLOAT_INFINITY) const;
+
+		/*
+			Casts NUM_RAYS rays, hits[N] receives the result of RAYS[N].
+			Rays are split into chunks processed in parallel if pool is given.
+		*/
+		void						raycast(			const Ray*			RAYS,
+														const uint32_t		NUM_RAYS,
+														std::optional<RayHit>* hits,
+														dpl::ThreadPool*	pool = nullptr,
+														const float			MAX_DISTANCE = FLOAT_INFINITY) const;
+
+		/*
+			Returns closest point on the mesh within MAX_DISTANCE.
+		*/
+		std::optional<ClosestPoint>	closest_point(		const Vec3&			POINT,
+														const float			MAX_DISTANCE = FLOAT_INFINITY) const;
+
+		/*
+			Returns true if any triangle overlaps the volume.
+			If output is given, IDs of all overlapping triangles are appended to it.
+		*/
+		bool						overlaps(			const AABB&			BOX,
+														std::vector<uint32_t>* output = nullptr) const;
+
+		bool						overlaps(			const Sphere&		SPHERE,
+														std::vector<uint32_t>* output = nullptr) const;
+
+		bool						overlaps(			const OBB&			BOX,
+														std::vector<uint32_t>* output = nullptr) const;
+
+	private: // build
+		struct	BuildData;
+
+		void						build_node(			BuildData&			data,
+														const uint32_t		NODE_INDEX,
+														const uint32_t		BEGIN,
+														const uint32_t		END,
+														const uint32_t		DEPTH,
+														dpl::ThreadPool*	pool);
+
+		void						quantize();
+
+	private: // traversal
+		inline bool					is_leaf(			const uint32_t		NODE_INDEX,
+														uint32_t&			first,
+														uint32_t&			count) const;
+
+		inline void					get_bounds(			const uint32_t		NODE_INDEX,
+														Vec3&				min,
+														Vec3&				max) const;
+
+		/*
+			Calls LEAF(FIRST, COUNT) for each leaf with bounds accepted by VISIT(MIN, MAX).
+			Traversal stops when LEAF returns false.
+		*/
+		template<typename VisitT, typename LeafT>
+		void						traverse(			VisitT&&			visit,
+														LeafT&&				leaf) const;
+
+		std::array<Vec3, 3>			get_triangle(		const uint32_t		TRIANGLE_ID) const;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+
+#include <vector>
+#include <limits>
+#include <dpl_ReadOnly.h>
+#include "cml_Funnel.h"
+
+
+namespace dpl
+{
+	class ThreadPool;
+}
+
+namespace cml
+{
+	/*
+		String pulling(funnel algorithm) of the portal corridors of many agents at once.
+
+		Agent is a circle with given radius: funnel sides are tangent to the circles around portal vertices,
+		corners are portal vertices moved by the radius away from the wall.
+		Corners of all paths are written into one arena, path N owns corners[paths[N].firstCorner, + paths[N].numCorners).
+		Results of the previous smooth call are kept for the incremental queries.
+	*/
+	class	PathSmoother
+	{
+	public: // subtypes
+		struct	Portal
+		{
+			Vec2	left;	// As seen when moving along the corridor.
+			Vec2	right;
+		};
+
+		struct	Corner
+		{
+			Vec2		point;
+			uint32_t	portal;	// Index of the portal with the corner vertex(INVALID_INDEX for start and goal).
+			Side		side;	// Side of the vertex in the portal(eNONE for start and goal).
+		};
+
+		/*
+			Incremental query: If only the first numChangedPortals portals(and the start) differ from the corridor of the previous path,
+			smoothing stops at the first corner that was also found previously behind the changed portals and the rest is copied.
+			Note: Portals behind the changed ones and the radius must be the same as in the previous query.
+		*/
+		struct	Query
+		{
+			Vec2			start;
+			Vec2			goal;
+			const Portal*	portals;
+			uint32_t		numPortals;
+			float			radius;
+			uint32_t		previousPath;		// Index of the path from the previous smooth call or INVALID_INDEX.
+			uint32_t		numChangedPortals;
+		};
+
+		struct	Path
+		{
+			uint32_t	firstCorner;
+			uint32_t	numCorners;		// Includes start and goal.
+			uint32_t	numPortals;
+			uint32_t	numReused;		// Corners copied from the previous path.
+		};
+
+	public: // constants
+		static const uint32_t INVALID_INDEX		= std::numeric_limits<uint32_t>::max();
+		static const uint32_t QUERY_CHUNK_SIZE	= 64; // Number of queries processed by a separate task.
+
+	public: // data
+		dpl::ReadOnly<std::vector<Path>,	PathSmoother> paths;
+		dpl::ReadOnly<std::vector<Corner>,	PathSmoother> corners;
+
+	private: // data
+		std::vector<Path>	m_previousPaths;
+		std::vector<Corner>	m_previousCorners;
+
+	public: // functions
+		/*
+			Smooths all queries, path N is the result of QUERIES[N].
+			Queries are split into chunks processed in parallel if pool is given.
+		*/
+		void					smooth(				const Query*		QUERIES,
+													const uint32_t		NUM_QUERIES,
+													dpl::ThreadPool*	pool = nullptr);
+
+		inline const Corner*	get_corners(		const uint32_t		PATH_INDEX) const
+		{
+			return corners().data() + paths()[PATH_INDEX].firstCorner;
+		}
+
+		inline uint32_t			get_numCorners(		const uint32_t		PATH_INDEX) const
+		{
+			return paths()[PATH_INDEX].numCorners;
+		}
+
+		void					clear();
+
+	private: // functions
+		/*
+			Writes corners of the query to the output(capacity of numPortals + 2) and returns the path.
+		*/
+		Path					smooth_path(		const Query&		QUERY,
+													Corner*				output) const;
+
+		const Path*				find_previous(		const Query&		QUERY) const;
+	};
+}
\ No newline at end of file
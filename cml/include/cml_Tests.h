@@ -0,0 +1,27 @@
+#pragma once
+
+
+#include <stdint.h>
+
+
+namespace cml
+{
+	/*
+		Benchmark of TriangleMesh::generate_normals on a terrain grid of GRID_SIZE x GRID_SIZE vertices.
+		Serial loop is compared with thread pools of 2, 4, ... hardware_concurrency workers,
+		for coherent indices(grid order) and incoherent ones(shuffled triangles and vertices).
+		Prints average times and the largest difference from the serial normals.
+	*/
+	void test_normals_scaling(	const uint32_t		GRID_SIZE,
+								const uint64_t		NUM_TESTS);
+
+	/*
+		Compares batch kernels of AABBPacket and SpherePacket with the scalar AABB and Sphere functions
+		on NUM_OBJECTS random objects and NUM_TESTS random planes, hulls and rays(results must be exactly the same).
+		Also checks AABB::above/below against the signed distance of the box center and
+		transform_bounds against the scalar AABB * Mat4 path(largest difference is printed).
+		Prints number of mismatches per kernel and returns their sum.
+	*/
+	uint64_t test_batch_equivalence(	const uint32_t		NUM_OBJECTS,
+										const uint32_t		NUM_TESTS);
+}
\ No newline at end of file
@@ -9,6 +9,11 @@
 #pragma warning( push )
 #pragma warning( disable : 26451) // Arithmetic overflow.
 
+namespace dpl
+{
+	class ThreadPool;
+}
+
 namespace cml
 {
 	class TriangleMesh
@@ -21,17 +26,62 @@ namespace cml
 		using	Vertices2D		= std::vector<Vec2>;
 		using	Vertices2DArray	= std::vector<const Vertices2D*>;
 
+		enum class NormalWeighting
+		{
+			UNIFORM,	// Each adjacent triangle contributes equally.
+			AREA,		// Contribution is proportional to the area of the triangle.
+			ANGLE		// Contribution is proportional to the angle of the triangle at the vertex.
+		};
+
+		enum class TriangulationMethod
+		{
+			DELAUNAY,	// Constrained Delaunay triangulation(poly2tri), well shaped triangles.
+			MONOTONE	// Sweep into monotone polygons, much faster for large polygons with many holes, but triangles may be thin.
+		};
+
+		/*
+			Rendering cost of the mesh, simulated with FIFO caches.
+		*/
+		struct	Statistics
+		{
+			uint32_t	numVertices		= 0;
+			uint32_t	numTriangles	= 0;
+			float		ACMR			= 0.f;	// Average cache miss ratio: transformed vertices per triangle(0.5 - 3.0, lower is better).
+			float		ATVR			= 0.f;	// Average transformed vertex ratio: transformed vertices per vertex(1.0 is optimal).
+			float		overfetch		= 0.f;	// Fetched vertex data / size of the vertex buffer(1.0 is optimal).
+			uint64_t	vertexBytes		= 0;
+			uint64_t	indexBytes		= 0;	// With the smallest index type that fits(16 or 32 bit).
+		};
+
+		struct	OptimizationReport
+		{
+			Statistics	before;
+			Statistics	after;
+		};
+
+	public: // constants
+		static const uint32_t DEFAULT_CACHE_SIZE	= 16;	// Entries of the post-transform vertex cache.
+		static const uint32_t FETCH_CACHE_LINES		= 64;	// Lines(64 bytes) of the vertex fetch cache.
+
 	public: // data
 		dpl::ReadOnly<Vertices,	TriangleMesh> vertices;
 		dpl::ReadOnly<Indices,	TriangleMesh> indices;
 
 	public: // functions
+		/*
+			Replaces vertices and indices with the triangulation of the polygon with holes(in the plane of the RPS).
+			Triangles are wound in TARGET_ORIENTATION(as returned by calculate_polygon_orientation).
+			Note: Holes must be inside of the border and must not overlap each other.
+			Note: Monotone pieces are triangulated in parallel if pool is given(MONOTONE method only).
+		*/
 		void			triangulate(			const CoordinateSystem& RPS,
 												const uint32_t			X_2D_INDEX,
 												const uint32_t			Y_2D_INDEX,
 												const Vertices2D&		BORDER_POLYGON,
 												const Vertices2DArray&	HOLE_POLYGONS,
-												const Orientation		TARGET_ORIENTATION);
+												const Orientation		TARGET_ORIENTATION,
+												const TriangulationMethod METHOD	= TriangulationMethod::DELAUNAY,
+												dpl::ThreadPool*		pool		= nullptr);
 
 		inline void		reset()
 		{
@@ -82,14 +132,75 @@ namespace cml
 
 		void			flip();
 
-		void			generate_normals(		Vec3*					output) const;
+		/*
+			Overwrites output[get_numVertices()] with vertex normals(zero for vertices that do not belong to any triangle).
+			If pool is given, triangles are split between its workers, each accumulating into its own buffer(no shared writes),
+			then buffers are gathered per vertex in parallel.
+			Buffers are bounded by the range of vertices referenced by the worker, if together they would be larger than twice the number of vertices
+			(incoherent indices), each vertex gathers normals of its adjacent triangles instead.
+			Note: Order of the summation(rounding) depends on the number of workers.
+		*/
+		void			generate_normals(		Vec3*					output,
+												const NormalWeighting	WEIGHTING	= NormalWeighting::UNIFORM,
+												dpl::ThreadPool*		pool		= nullptr) const;
 
-		inline Normals	generate_normals() const
+		inline Normals	generate_normals(		const NormalWeighting	WEIGHTING	= NormalWeighting::UNIFORM,
+												dpl::ThreadPool*		pool		= nullptr) const
 		{
-			Normals output(get_numVertices(), Vec3(0.f, 0.f, 0.f));			
-			generate_normals(output.data());
+			Normals output(get_numVertices());
+			generate_normals(output.data(), WEIGHTING, pool);
 			return output;
 		}
+
+	public: // optimization
+		Statistics			calculate_statistics(	const uint32_t			CACHE_SIZE = DEFAULT_CACHE_SIZE) const;
+
+		/*
+			Merges vertices closer than TOLERANCE(exact duplicates if 0) and removes triangles that collapsed.
+			Vertices keep the position and the order of their first occurrence.
+		*/
+		OptimizationReport	weld_vertices(			const float				TOLERANCE);
+
+		/*
+			Reorders triangles to reuse the post-transform vertex cache(Tipsify, linear time).
+		*/
+		OptimizationReport	optimize_vertex_cache(	const uint32_t			CACHE_SIZE = DEFAULT_CACHE_SIZE);
+
+		/*
+			Reorders vertices in the order of the first use by the indices(unused vertices are moved to the end).
+		*/
+		OptimizationReport	optimize_vertex_fetch();
+
+		/*
+			Welds vertices, then optimizes vertex cache and vertex fetch.
+		*/
+		OptimizationReport	optimize(				const float				WELD_TOLERANCE,
+													const uint32_t			CACHE_SIZE = DEFAULT_CACHE_SIZE);
+
+		/*
+			Returns false if the mesh has too many vertices for 16 bit indices.
+		*/
+		bool				get_16bit_indices(		std::vector<uint16_t>&	output) const;
+
+	private: // triangulation
+		void			triangulate_delaunay(	const Vertices2D&		BORDER_POLYGON,
+												const Vertices2DArray&	HOLE_POLYGONS,
+												const Orientation		TARGET_ORIENTATION,
+												Vertices2D&				vertices2D);
+
+		void			triangulate_monotone(	const Vertices2D&		BORDER_POLYGON,
+												const Vertices2DArray&	HOLE_POLYGONS,
+												const Orientation		TARGET_ORIENTATION,
+												dpl::ThreadPool*		pool,
+												Vertices2D&				vertices2D);
+
+	private: // normals
+		/*
+			Parallel generation for incoherent indices: normals are stored per triangle and gathered per vertex(CSR adjacency).
+		*/
+		void			generate_normals_by_adjacency(	Vec3*					output,
+														const NormalWeighting	WEIGHTING,
+														dpl::ThreadPool&		pool) const;
 	};
 }
 
@@ -382,7 +382,7 @@ namespace cml
 
 	bool		AABB::above(				const Plane&		plane) const
 	{
-		float signedDistance = calculate_dot(plane.normal, center() - plane.distance());
+		float signedDistance = calculate_dot(plane.normal(), center()) - plane.distance();
 
 		if(signedDistance <= 0.f)
 			return false;
@@ -392,7 +392,7 @@ namespace cml
 
 	bool		AABB::below(				const Plane&		plane) const
 	{
-		float signedDistance = calculate_dot(plane.normal, center() - plane.distance());
+		float signedDistance = calculate_dot(plane.normal(), center()) - plane.distance();
 
 		if(signedDistance >= 0.f)
 			return false;
@@ -0,0 +1,403 @@
+#include "../include/cml_AABBTree.h"
+#include <dpl_ThreadPool.h>
+#include <dpl_GeneralException.h>
+#include <algorithm>
+#include <bit>
+#include <string>
+
+
+namespace cml
+{
+	namespace
+	{
+		inline float	half_area(				const Vec3&			MIN,
+												const Vec3&			MAX)
+		{
+			const Vec3 SIZE = MAX - MIN;
+			return SIZE.x * SIZE.y + SIZE.y * SIZE.z + SIZE.z * SIZE.x;
+		}
+
+		inline bool		contains(				const Vec3&			OUTER_MIN,
+												const Vec3&			OUTER_MAX,
+												const Vec3&			INNER_MIN,
+												const Vec3&			INNER_MAX)
+		{
+			return OUTER_MIN.x <= INNER_MIN.x && OUTER_MIN.y <= INNER_MIN.y && OUTER_MIN.z <= INNER_MIN.z
+				&& INNER_MAX.x <= OUTER_MAX.x && INNER_MAX.y <= OUTER_MAX.y && INNER_MAX.z <= OUTER_MAX.z;
+		}
+
+		inline void		fit_children(			std::vector<AABBTree::Node>& nodes,
+												const uint32_t		NODE_INDEX)
+		{
+			AABBTree::Node&			node	= nodes[NODE_INDEX];
+			const AABBTree::Node&	LEFT	= nodes[node.children[0]];
+			const AABBTree::Node&	RIGHT	= nodes[node.children[1]];
+			node.min	= glm::min(LEFT.min, RIGHT.min);
+			node.max	= glm::max(LEFT.max, RIGHT.max);
+			node.height	= 1 + std::max(LEFT.height, RIGHT.height);
+		}
+	}
+
+
+	struct	AABBTree::BuildData
+	{
+		std::vector<uint32_t>	leaves;
+		std::vector<uint32_t>	internals;	// Subtree of N leaves uses N - 1 consecutive internal nodes, the first one is its root.
+		std::vector<Vec3>		centroids;	// Indexed by node.
+	};
+
+
+
+//=====> AABBTree public: // lifecycle
+	CLASS_CTOR		AABBTree::AABBTree(					const float			MARGIN)
+		: root(INVALID_INDEX)
+		, numProxies(0)
+		, margin(MARGIN)
+	{
+		if(MARGIN < 0.f)
+			throw dpl::GeneralException(this, __LINE__, "Invalid margin: " + std::to_string(MARGIN));
+	}
+
+//=====> AABBTree public: // functions
+	uint32_t		AABBTree::insert(					const AABB&			BOUNDS,
+														const uint32_t		USER_DATA)
+	{
+		const uint32_t LEAF = allocate_node();
+		Node& leaf		= (*nodes)[LEAF];
+		leaf.min		= BOUNDS.min() - Vec3(margin());
+		leaf.max		= BOUNDS.max() + Vec3(margin());
+		leaf.height		= 0;
+		leaf.children[0]= INVALID_INDEX;
+		leaf.children[1]= INVALID_INDEX;
+		leaf.userData	= USER_DATA;
+
+		insert_leaf(LEAF);
+		++(*numProxies);
+		return LEAF;
+	}
+
+	void			AABBTree::remove(					const uint32_t		PROXY)
+	{
+#ifdef _DEBUG
+		if(PROXY >= nodes().size() || nodes()[PROXY].height != 0)
+			throw dpl::GeneralException(this, __LINE__, "Invalid proxy: " + std::to_string(PROXY));
+#endif // _DEBUG
+
+		remove_leaf(PROXY);
+		free_node(PROXY);
+		--(*numProxies);
+	}
+
+	bool			AABBTree::move(						const uint32_t		PROXY,
+														const AABB&			BOUNDS,
+														const Vec3&			DISPLACEMENT)
+	{
+#ifdef _DEBUG
+		if(PROXY >= nodes().size() || nodes()[PROXY].height != 0)
+			throw dpl::GeneralException(this, __LINE__, "Invalid proxy: " + std::to_string(PROXY));
+#endif // _DEBUG
+
+		const Vec3	MIN			= BOUNDS.min();
+		const Vec3	MAX			= BOUNDS.max();
+		const Vec3	SHIFT		= DISPLACEMENT * DISPLACEMENT_FACTOR;
+		const Vec3	FAT_MIN		= MIN - Vec3(margin()) + glm::min(SHIFT, Vec3(0.f));
+		const Vec3	FAT_MAX		= MAX + Vec3(margin()) + glm::max(SHIFT, Vec3(0.f));
+
+		Node& leaf = (*nodes)[PROXY];
+		if(contains(leaf.min, leaf.max, MIN, MAX))
+		{
+			const Vec3 MAX_MARGIN = Vec3(margin() * MAX_MARGIN_FACTOR);
+			if(contains(FAT_MIN - MAX_MARGIN, FAT_MAX + MAX_MARGIN, leaf.min, leaf.max))
+				return false;
+		}
+
+		remove_leaf(PROXY);
+		leaf.min = FAT_MIN;
+		leaf.max = FAT_MAX;
+		insert_leaf(PROXY);
+		return true;
+	}
+
+	void			AABBTree::rebuild(					dpl::ThreadPool*	pool)
+	{
+		if(empty()) return;
+
+		BuildData data;
+		data.leaves.reserve(numProxies());
+		data.centroids.resize(nodes().size());
+		for(uint32_t nodeID = 0; nodeID < nodes().size(); ++nodeID)
+		{
+			const Node& NODE = nodes()[nodeID];
+			if(NODE.height == 0)
+			{
+				data.leaves.push_back(nodeID);
+				data.centroids[nodeID] = (NODE.min + NODE.max) * 0.5f;
+			}
+			else if(NODE.height != INVALID_INDEX)
+			{
+				free_node(nodeID);
+			}
+		}
+
+		data.internals.resize(data.leaves.size() - 1);
+		for(uint32_t& internal : data.internals)
+		{
+			internal = allocate_node();
+		}
+
+		const uint32_t NUM_LEAVES = static_cast<uint32_t>(data.leaves.size());
+		root = (NUM_LEAVES > 1)? data.internals[0] : data.leaves[0];
+		build_node(data, 0, NUM_LEAVES, 0, INVALID_INDEX, pool);
+		if(pool) pool->wait();
+	}
+
+	void			AABBTree::clear()
+	{
+		nodes->clear();
+		m_freeNodes.clear();
+		root		= INVALID_INDEX;
+		numProxies	= 0;
+	}
+
+	float			AABBTree::calculate_area_ratio() const
+	{
+		if(empty()) return 0.f;
+
+		const Node&	ROOT		= nodes()[root()];
+		const float	ROOT_AREA	= half_area(ROOT.min, ROOT.max);
+		if(ROOT_AREA <= 0.f) return 0.f;
+
+		float totalArea = 0.f;
+		for(const Node& NODE : nodes())
+		{
+			if(NODE.height != 0 && NODE.height != INVALID_INDEX)
+				totalArea += half_area(NODE.min, NODE.max);
+		}
+		return totalArea / ROOT_AREA;
+	}
+
+//=====> AABBTree private: // functions
+	uint32_t		AABBTree::allocate_node()
+	{
+		if(m_freeNodes.empty())
+		{
+			nodes->emplace_back();
+			return static_cast<uint32_t>(nodes().size() - 1);
+		}
+
+		const uint32_t NODE_INDEX = m_freeNodes.back();
+		m_freeNodes.pop_back();
+		return NODE_INDEX;
+	}
+
+	void			AABBTree::free_node(				const uint32_t		NODE_INDEX)
+	{
+		Node& node		= (*nodes)[NODE_INDEX];
+		node.parent		= INVALID_INDEX;
+		node.height		= INVALID_INDEX;
+		m_freeNodes.push_back(NODE_INDEX);
+	}
+
+	void			AABBTree::insert_leaf(				const uint32_t		LEAF)
+	{
+		if(empty())
+		{
+			root = LEAF;
+			(*nodes)[LEAF].parent = INVALID_INDEX;
+			return;
+		}
+
+		const Vec3 LEAF_MIN = nodes()[LEAF].min;
+		const Vec3 LEAF_MAX = nodes()[LEAF].max;
+
+		// Find the best sibling: new parent costs the area of the union, ancestors grow by the union too.
+		uint32_t sibling = root();
+		while(nodes()[sibling].height > 0)
+		{
+			const Node&	NODE			= nodes()[sibling];
+			const float	AREA			= half_area(NODE.min, NODE.max);
+			const float	COMBINED_AREA	= half_area(glm::min(NODE.min, LEAF_MIN), glm::max(NODE.max, LEAF_MAX));
+			const float	COST			= 2.f * COMBINED_AREA;
+			const float	INHERITED_COST	= 2.f * (COMBINED_AREA - AREA);
+
+			float childCosts[2];
+			for(uint32_t childID = 0; childID < 2; ++childID)
+			{
+				const Node& CHILD		= nodes()[NODE.children[childID]];
+				const float UNION_AREA	= half_area(glm::min(CHILD.min, LEAF_MIN), glm::max(CHILD.max, LEAF_MAX));
+				childCosts[childID]		= INHERITED_COST + ((CHILD.height == 0)? UNION_AREA : UNION_AREA - half_area(CHILD.min, CHILD.max));
+			}
+
+			if(COST < childCosts[0] && COST < childCosts[1])
+				break;
+
+			sibling = NODE.children[(childCosts[1] < childCosts[0])? 1 : 0];
+		}
+
+		const uint32_t OLD_PARENT = nodes()[sibling].parent;
+		const uint32_t NEW_PARENT = allocate_node();
+		Node& parent		= (*nodes)[NEW_PARENT];
+		parent.parent		= OLD_PARENT;
+		parent.children[0]	= sibling;
+		parent.children[1]	= LEAF;
+		parent.userData		= INVALID_INDEX;
+		fit_children(*nodes, NEW_PARENT);
+
+		if(OLD_PARENT != INVALID_INDEX)
+		{
+			Node& oldParent = (*nodes)[OLD_PARENT];
+			oldParent.children[(oldParent.children[0] == sibling)? 0 : 1] = NEW_PARENT;
+		}
+		else
+		{
+			root = NEW_PARENT;
+		}
+
+		(*nodes)[sibling].parent	= NEW_PARENT;
+		(*nodes)[LEAF].parent		= NEW_PARENT;
+		refit_upwards(NEW_PARENT);
+	}
+
+	void			AABBTree::remove_leaf(				const uint32_t		LEAF)
+	{
+		if(LEAF == root())
+		{
+			root = INVALID_INDEX;
+			return;
+		}
+
+		const uint32_t	PARENT		= nodes()[LEAF].parent;
+		const Node&		PARENT_NODE	= nodes()[PARENT];
+		const uint32_t	GRANDPARENT	= PARENT_NODE.parent;
+		const uint32_t	SIBLING		= PARENT_NODE.children[(PARENT_NODE.children[0] == LEAF)? 1 : 0];
+
+		if(GRANDPARENT != INVALID_INDEX)
+		{
+			Node& grandparent = (*nodes)[GRANDPARENT];
+			grandparent.children[(grandparent.children[0] == PARENT)? 0 : 1] = SIBLING;
+		}
+		else
+		{
+			root = SIBLING;
+		}
+
+		(*nodes)[SIBLING].parent = GRANDPARENT;
+		free_node(PARENT);
+		refit_upwards(GRANDPARENT);
+	}
+
+	void			AABBTree::refit_upwards(			uint32_t			nodeIndex)
+	{
+		while(nodeIndex != INVALID_INDEX)
+		{
+			nodeIndex = balance(nodeIndex);
+			fit_children(*nodes, nodeIndex);
+			nodeIndex = nodes()[nodeIndex].parent;
+		}
+	}
+
+	uint32_t		AABBTree::balance(					const uint32_t		NODE_INDEX)
+	{
+		std::vector<Node>& tree = *nodes;
+		Node& node = tree[NODE_INDEX];
+		if(node.height < 2)
+			return NODE_INDEX;
+
+		const int32_t DIFFERENCE = static_cast<int32_t>(tree[node.children[1]].height) - static_cast<int32_t>(tree[node.children[0]].height);
+		if(DIFFERENCE >= -1 && DIFFERENCE <= 1)
+			return NODE_INDEX;
+
+		// Higher child takes place of the node, node takes place of the lower grandchild.
+		const uint32_t	HIGH_SIDE	= (DIFFERENCE > 1)? 1 : 0;
+		const uint32_t	HIGH		= node.children[HIGH_SIDE];
+		Node&			high		= tree[HIGH];
+		const uint32_t	TALL_SIDE	= (tree[high.children[0]].height > tree[high.children[1]].height)? 0 : 1;
+		const uint32_t	TALL		= high.children[TALL_SIDE];
+		const uint32_t	SHORT		= high.children[1 - TALL_SIDE];
+
+		high.parent = node.parent;
+		if(high.parent != INVALID_INDEX)
+		{
+			Node& parent = tree[high.parent];
+			parent.children[(parent.children[0] == NODE_INDEX)? 0 : 1] = HIGH;
+		}
+		else
+		{
+			root = HIGH;
+		}
+
+		high.children[0]			= NODE_INDEX;
+		high.children[1]			= TALL;
+		node.parent					= HIGH;
+		node.children[HIGH_SIDE]	= SHORT;
+		tree[SHORT].parent			= NODE_INDEX;
+
+		fit_children(tree, NODE_INDEX);
+		fit_children(tree, HIGH);
+		return HIGH;
+	}
+
+	void			AABBTree::build_node(				BuildData&			data,
+														const uint32_t		BEGIN,
+														const uint32_t		END,
+														const uint32_t		FIRST_INTERNAL,
+														const uint32_t		PARENT,
+														dpl::ThreadPool*	pool)
+	{
+		std::vector<Node>& tree = *nodes;
+		const uint32_t COUNT = END - BEGIN;
+		if(COUNT == 1)
+		{
+			tree[data.leaves[BEGIN]].parent = PARENT;
+			return;
+		}
+
+		Vec3 min			= tree[data.leaves[BEGIN]].min;
+		Vec3 max			= tree[data.leaves[BEGIN]].max;
+		Vec3 centroidMin	= data.centroids[data.leaves[BEGIN]];
+		Vec3 centroidMax	= centroidMin;
+		for(uint32_t leafID = BEGIN + 1; leafID < END; ++leafID)
+		{
+			const uint32_t LEAF = data.leaves[leafID];
+			min			= glm::min(min, tree[LEAF].min);
+			max			= glm::max(max, tree[LEAF].max);
+			centroidMin	= glm::min(centroidMin, data.centroids[LEAF]);
+			centroidMax	= glm::max(centroidMax, data.centroids[LEAF]);
+		}
+
+		const Vec3		EXTENT	= centroidMax - centroidMin;
+		const uint32_t	AXIS	= (EXTENT.x >= EXTENT.y && EXTENT.x >= EXTENT.z)? 0 : (EXTENT.y >= EXTENT.z)? 1 : 2;
+		const uint32_t	MIDDLE	= BEGIN + COUNT / 2;
+		std::nth_element(data.leaves.begin() + BEGIN, data.leaves.begin() + MIDDLE, data.leaves.begin() + END, [&](const uint32_t A, const uint32_t B)
+		{
+			return data.centroids[A][AXIS] < data.centroids[B][AXIS];
+		});
+
+		// Halves differ by at most one leaf, so the height of the subtree is known before its children are built.
+		const uint32_t	NODE_INDEX		= data.internals[FIRST_INTERNAL];
+		const uint32_t	LEFT_INTERNAL	= FIRST_INTERNAL + 1;
+		const uint32_t	RIGHT_INTERNAL	= FIRST_INTERNAL + (MIDDLE - BEGIN);
+		Node& node		= tree[NODE_INDEX];
+		node.min		= min;
+		node.max		= max;
+		node.parent		= PARENT;
+		node.height		= static_cast<uint32_t>(std::bit_width(COUNT - 1));
+		node.userData	= INVALID_INDEX;
+		node.children[0]= (MIDDLE - BEGIN > 1)? data.internals[LEFT_INTERNAL] : data.leaves[BEGIN];
+		node.children[1]= (END - MIDDLE > 1)? data.internals[RIGHT_INTERNAL] : data.leaves[MIDDLE];
+
+		if(pool && (END - MIDDLE) >= PARALLEL_BUILD_THRESHOLD)
+		{
+			pool->add_task([this, &data, MIDDLE, END, RIGHT_INTERNAL, NODE_INDEX, pool]()
+			{
+				build_node(data, MIDDLE, END, RIGHT_INTERNAL, NODE_INDEX, pool);
+			});
+		}
+		else
+		{
+			build_node(data, MIDDLE, END, RIGHT_INTERNAL, NODE_INDEX, pool);
+		}
+
+		build_node(data, BEGIN, MIDDLE, LEFT_INTERNAL, NODE_INDEX, pool);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,858 @@
+#include "../include/cml_Ray.h"
+#include "../include/cml_AABB.h"
+#include "../include/cml_OBB.h"
+#include "../include/cml_Sphere.h"
+#include "../include/cml_Plane.h"
+#include "../include/cml_ConvexHull.h"
+#include "../include/cml_EulerAngles.h"
+#include "../include/cml_Batch.h"
+#include "../include/cml_Lanes.h"
+#include <dpl_ThreadPool.h>
+
+
+namespace cml
+{
+	namespace
+	{
+		using	Reg		= Lanes::Reg;
+		using	Mask	= Lanes::Mask;
+
+		static_assert(AABBPacket::BATCH_WIDTH % Lanes::WIDTH == 0, "Packet padding must be a multiple of the register width.");
+		static_assert(64 % Lanes::WIDTH == 0, "Lanes must not cross the mask words.");
+
+		/*
+			Plane broadcast into registers.
+		*/
+		struct	PlaneLanes
+		{
+			Reg nx, ny, nz;		// normal
+			Reg ax, ay, az;		// absolute normal
+			Reg distance;
+
+			CLASS_CTOR	PlaneLanes(	const Plane&	PLANE)
+				: nx(Lanes::set(PLANE.normal().x))
+				, ny(Lanes::set(PLANE.normal().y))
+				, nz(Lanes::set(PLANE.normal().z))
+				, ax(Lanes::abs(nx))
+				, ay(Lanes::abs(ny))
+				, az(Lanes::abs(nz))
+				, distance(Lanes::set(PLANE.distance()))
+			{
+
+			}
+
+			/*
+				Same order of operations as calculate_dot(normal, point).
+			*/
+			inline Reg	dot(		const Reg		X,
+									const Reg		Y,
+									const Reg		Z) const
+			{
+				return Lanes::add(Lanes::add(Lanes::mul(nx, X), Lanes::mul(ny, Y)), Lanes::mul(nz, Z));
+			}
+		};
+
+		inline std::vector<PlaneLanes>	broadcast_faces(const ConvexHull&	HULL)
+		{
+			std::vector<PlaneLanes> faces;
+			faces.reserve(HULL.faces().size());
+			for(const Plane& FACE : HULL.faces())
+			{
+				faces.emplace_back(FACE);
+			}
+			return faces;
+		}
+
+		/*
+			Calls KERNEL(INDEX) for each group of lanes and stores returned masks in the result.
+		*/
+		template<typename KernelT>
+		inline void			run_kernel(		const uint32_t		SIZE,
+											BatchMask&			result,
+											KernelT&&			kernel)
+		{
+			for(uint32_t index = 0; index < SIZE; index += Lanes::WIDTH)
+			{
+				result.set_lanes(index, Lanes::bits(kernel(index)));
+			}
+		}
+
+		inline uint32_t		padded_size(	const uint32_t		SIZE)
+		{
+			return (SIZE + AABBPacket::BATCH_WIDTH - 1) / AABBPacket::BATCH_WIDTH * AABBPacket::BATCH_WIDTH;
+		}
+
+		/*
+			Same order of operations as EulerAngles::to_quat.
+		*/
+		inline void			angles_to_quat(	const float*		YAW,
+											const float*		PITCH,
+											const float*		ROLL,
+											Reg&				w,
+											Reg&				x,
+											Reg&				y,
+											Reg&				z)
+		{
+			const Reg HALF = Lanes::set(0.5f);
+			Reg cy, sy, cp, sp, cr, sr;
+			LaneMath::sin_cos(Lanes::mul(Lanes::load(YAW),		HALF), sy, cy);
+			LaneMath::sin_cos(Lanes::mul(Lanes::load(PITCH),	HALF), sp, cp);
+			LaneMath::sin_cos(Lanes::mul(Lanes::load(ROLL),		HALF), sr, cr);
+
+			w = Lanes::sub(Lanes::mul(Lanes::mul(cy, cr), cp), Lanes::mul(Lanes::mul(sy, sr), sp));
+			x = Lanes::add(Lanes::mul(Lanes::mul(cy, sr), cp), Lanes::mul(Lanes::mul(sy, cr), sp));
+			y = Lanes::add(Lanes::mul(Lanes::mul(sy, cr), cp), Lanes::mul(Lanes::mul(cy, sr), sp));
+			z = Lanes::sub(Lanes::mul(Lanes::mul(cy, cr), sp), Lanes::mul(Lanes::mul(sy, sr), cp));
+		}
+
+		const uint32_t TRANSFORM_CHUNK_SIZE = 16384; // Minimal number of instances processed by a separate task.
+
+		/*
+			Calls FUNCTION(BEGIN, END) for consecutive chunks of instances, in parallel if pool is given.
+		*/
+		template<typename FunctionT>
+		inline void			run_chunks(		const uint32_t		NUM_INSTANCES,
+											dpl::ThreadPool*	pool,
+											FunctionT&&			function)
+		{
+			if(!pool || NUM_INSTANCES <= TRANSFORM_CHUNK_SIZE)
+				return function(0, NUM_INSTANCES);
+
+			for(uint32_t begin = 0; begin < NUM_INSTANCES; begin += TRANSFORM_CHUNK_SIZE)
+			{
+				const uint32_t END = std::min(begin + TRANSFORM_CHUNK_SIZE, NUM_INSTANCES);
+				pool->add_task([=, &function](){ function(begin, END); });
+			}
+			pool->wait();
+		}
+
+		/*
+			Columns of the matrix are processed as 4 lane registers(xyzw), one instance at a time,
+			since matrices are stored as arrays of structures.
+		*/
+#if defined(__AVX__) || defined(CML_LANES_SSE)
+		inline __m128		abs4(			const __m128		A)
+		{
+			return _mm_andnot_ps(_mm_set1_ps(-0.f), A);
+		}
+
+		inline Vec3			to_vec3(		const __m128		A)
+		{
+			alignas(16) float values[4];
+			_mm_store_ps(values, A);
+			return Vec3(values[0], values[1], values[2]);
+		}
+
+		/*
+			Center and extents of the box enclosing LOCAL_BOX transformed by M(Arvo):
+			center = M * localCenter, extents = |M| * localExtents.
+		*/
+		inline void			transform_box(	const AABB&			LOCAL_BOX,
+											const Mat4&			M,
+											Vec3&				center,
+											Vec3&				extents)
+		{
+			const __m128 C0 = _mm_loadu_ps(&M[0][0]);
+			const __m128 C1 = _mm_loadu_ps(&M[1][0]);
+			const __m128 C2 = _mm_loadu_ps(&M[2][0]);
+			const __m128 C3 = _mm_loadu_ps(&M[3][0]);
+			const Vec3&	 LC = LOCAL_BOX.center();
+			const Vec3&	 LE = LOCAL_BOX.extents();
+
+			center	= to_vec3(_mm_add_ps(_mm_add_ps(_mm_mul_ps(C0, _mm_set1_ps(LC.x)), _mm_mul_ps(C1, _mm_set1_ps(LC.y))), 
+										 _mm_add_ps(_mm_mul_ps(C2, _mm_set1_ps(LC.z)), C3)));
+			extents	= to_vec3(_mm_add_ps(_mm_add_ps(_mm_mul_ps(abs4(C0), _mm_set1_ps(LE.x)), _mm_mul_ps(abs4(C1), _mm_set1_ps(LE.y))), 
+										 _mm_mul_ps(abs4(C2), _mm_set1_ps(LE.z))));
+		}
+
+		/*
+			Same result as OBB(LOCAL_BOX, M): axes are normalized columns, column lengths scale the extents.
+		*/
+		inline void			transform_box(	const AABB&			LOCAL_BOX,
+											const Mat4&			M,
+											OBB&				output)
+		{
+			const __m128 C0 = _mm_loadu_ps(&M[0][0]);
+			const __m128 C1 = _mm_loadu_ps(&M[1][0]);
+			const __m128 C2 = _mm_loadu_ps(&M[2][0]);
+			const __m128 C3 = _mm_loadu_ps(&M[3][0]);
+			const Vec3&	 LC = LOCAL_BOX.center();
+			const Vec3&	 LE = LOCAL_BOX.extents();
+
+			__m128 rowX = C0, rowY = C1, rowZ = C2, rowW = C3;
+			_MM_TRANSPOSE4_PS(rowX, rowY, rowZ, rowW);
+			const __m128 SCALE	= _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rowX, rowX), _mm_mul_ps(rowY, rowY)), _mm_mul_ps(rowZ, rowZ)));
+
+			output.reset_axes(	to_vec3(_mm_div_ps(C0, _mm_shuffle_ps(SCALE, SCALE, _MM_SHUFFLE(0, 0, 0, 0)))),
+								to_vec3(_mm_div_ps(C1, _mm_shuffle_ps(SCALE, SCALE, _MM_SHUFFLE(1, 1, 1, 1)))),
+								to_vec3(_mm_div_ps(C2, _mm_shuffle_ps(SCALE, SCALE, _MM_SHUFFLE(2, 2, 2, 2)))));
+			output.set_origin(	to_vec3(_mm_add_ps(_mm_add_ps(_mm_mul_ps(C0, _mm_set1_ps(LC.x)), _mm_mul_ps(C1, _mm_set1_ps(LC.y))), 
+												   _mm_add_ps(_mm_mul_ps(C2, _mm_set1_ps(LC.z)), C3))));
+			output.set_extents(	to_vec3(_mm_mul_ps(_mm_setr_ps(LE.x, LE.y, LE.z, 0.f), SCALE)));
+		}
+#else
+		inline void			transform_box(	const AABB&			LOCAL_BOX,
+											const Mat4&			M,
+											Vec3&				center,
+											Vec3&				extents)
+		{
+			const Vec3& LE = LOCAL_BOX.extents();
+			center	= Vec3(M * Vec4(LOCAL_BOX.center(), 1.f));
+			extents	= glm::abs(Vec3(M[0])) * LE.x + glm::abs(Vec3(M[1])) * LE.y + glm::abs(Vec3(M[2])) * LE.z;
+		}
+
+		inline void			transform_box(	const AABB&			LOCAL_BOX,
+											const Mat4&			M,
+											OBB&				output)
+		{
+			output.reset(LOCAL_BOX, M);
+		}
+#endif
+	}
+
+
+
+//=====> BatchMask public: // functions
+	uint32_t		BatchMask::count() const
+	{
+		uint32_t numSet = 0;
+		for(const uint64_t WORD : words())
+		{
+			numSet += static_cast<uint32_t>(std::popcount(WORD));
+		}
+		return numSet;
+	}
+
+//=====> BatchMask public: // kernel output
+	void			BatchMask::reset(				const uint32_t		NEW_SIZE)
+	{
+		words->assign((NEW_SIZE + 63) / 64, 0);
+		size = NEW_SIZE;
+	}
+
+	void			BatchMask::clear_tail()
+	{
+		const uint32_t NUM_TAIL_BITS = size() & 63;
+		if(NUM_TAIL_BITS > 0) words->back() &= (uint64_t(1) << NUM_TAIL_BITS) - 1;
+	}
+
+
+
+//=====> AABBPacket public: // lifecycle
+	CLASS_CTOR		AABBPacket::AABBPacket(			const AABB*			BOXES,
+													const uint32_t		NUM_BOXES)
+		: size(0)
+	{
+		resize_padded(NUM_BOXES);
+		for(uint32_t index = 0; index < NUM_BOXES; ++index)
+		{
+			set(index, BOXES[index]);
+		}
+	}
+
+	CLASS_CTOR		AABBPacket::AABBPacket(			const AABB*			LOCAL_BOXES,
+													const Mat4*			TRANSFORMATIONS,
+													const uint32_t		NUM_BOXES,
+													dpl::ThreadPool*	pool)
+		: size(0)
+	{
+		reset(LOCAL_BOXES, TRANSFORMATIONS, NUM_BOXES, pool);
+	}
+
+//=====> AABBPacket public: // functions
+	void			AABBPacket::reserve(			const uint32_t		NUM_BOXES)
+	{
+		const uint32_t CAPACITY = padded_size(NUM_BOXES);
+		m_centerX.reserve(CAPACITY);
+		m_centerY.reserve(CAPACITY);
+		m_centerZ.reserve(CAPACITY);
+		m_halfWidth.reserve(CAPACITY);
+		m_halfHeight.reserve(CAPACITY);
+		m_halfDepth.reserve(CAPACITY);
+	}
+
+	void			AABBPacket::clear()
+	{
+		resize_padded(0);
+	}
+
+	void			AABBPacket::add(				const AABB&			BOX)
+	{
+		resize_padded(size() + 1);
+		set(size() - 1, BOX);
+	}
+
+	void			AABBPacket::set(				const uint32_t		INDEX,
+													const AABB&			BOX)
+	{
+#ifdef _DEBUG
+		if(INDEX >= size())
+			throw dpl::GeneralException(this, __LINE__, "Invalid box index: " + std::to_string(INDEX));
+#endif // _DEBUG
+
+		m_centerX[INDEX]	= BOX.center().x;
+		m_centerY[INDEX]	= BOX.center().y;
+		m_centerZ[INDEX]	= BOX.center().z;
+		m_halfWidth[INDEX]	= BOX.halfWidth();
+		m_halfHeight[INDEX]	= BOX.halfHeight();
+		m_halfDepth[INDEX]	= BOX.halfDepth();
+	}
+
+	AABB			AABBPacket::get(				const uint32_t		INDEX) const
+	{
+		AABB box(Vec3(m_centerX[INDEX], m_centerY[INDEX], m_centerZ[INDEX]));
+		box.set_extents(m_halfWidth[INDEX], m_halfHeight[INDEX], m_halfDepth[INDEX]);
+		return box;
+	}
+
+	void			AABBPacket::reset(				const AABB*			LOCAL_BOXES,
+													const Mat4*			TRANSFORMATIONS,
+													const uint32_t		NUM_BOXES,
+													dpl::ThreadPool*	pool)
+	{
+		resize_padded(NUM_BOXES);
+		run_chunks(NUM_BOXES, pool, [&](const uint32_t BEGIN, const uint32_t END)
+		{
+			Vec3 center, extents;
+			for(uint32_t index = BEGIN; index < END; ++index)
+			{
+				transform_box(LOCAL_BOXES[index], TRANSFORMATIONS[index], center, extents);
+				m_centerX[index]	= center.x;
+				m_centerY[index]	= center.y;
+				m_centerZ[index]	= center.z;
+				m_halfWidth[index]	= extents.x;
+				m_halfHeight[index]	= extents.y;
+				m_halfDepth[index]	= extents.z;
+			}
+		});
+	}
+
+//=====> AABBPacket public: // batch tests
+	void			AABBPacket::above(				const Plane&		PLANE,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const PlaneLanes	P		= PLANE;
+		const Reg			ZERO	= Lanes::set(0.f);
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg SIGNED_DISTANCE	= Lanes::sub(P.dot(Lanes::load(&m_centerX[INDEX]), Lanes::load(&m_centerY[INDEX]), Lanes::load(&m_centerZ[INDEX])), P.distance);
+			const Reg PROJECTED_SIZE	= Lanes::add(Lanes::add(Lanes::abs(Lanes::mul(P.nx, Lanes::load(&m_halfWidth[INDEX]))),
+																Lanes::abs(Lanes::mul(P.ny, Lanes::load(&m_halfHeight[INDEX])))),
+																Lanes::abs(Lanes::mul(P.nz, Lanes::load(&m_halfDepth[INDEX]))));
+			return Lanes::both(Lanes::greater(SIGNED_DISTANCE, ZERO), Lanes::greater(SIGNED_DISTANCE, PROJECTED_SIZE));
+		});
+		result.clear_tail();
+	}
+
+	void			AABBPacket::intersects(			const Plane&		PLANE,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const PlaneLanes P = PLANE;
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg DISTANCE	= Lanes::abs(Lanes::sub(P.dot(Lanes::load(&m_centerX[INDEX]), Lanes::load(&m_centerY[INDEX]), Lanes::load(&m_centerZ[INDEX])), P.distance));
+			const Reg RADIUS	= Lanes::add(Lanes::add(Lanes::mul(Lanes::load(&m_halfWidth[INDEX]),	P.ax),
+														Lanes::mul(Lanes::load(&m_halfHeight[INDEX]),	P.ay)),
+														Lanes::mul(Lanes::load(&m_halfDepth[INDEX]),	P.az));
+			return Lanes::less_equal(DISTANCE, RADIUS);
+		});
+		result.clear_tail();
+	}
+
+	void			AABBPacket::intersects(			const ConvexHull&	HULL,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const std::vector<PlaneLanes>	FACES	= broadcast_faces(HULL);
+		const Reg						ZERO	= Lanes::set(0.f);
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg CX = Lanes::load(&m_centerX[INDEX]);
+			const Reg CY = Lanes::load(&m_centerY[INDEX]);
+			const Reg CZ = Lanes::load(&m_centerZ[INDEX]);
+			const Reg HW = Lanes::load(&m_halfWidth[INDEX]);
+			const Reg HH = Lanes::load(&m_halfHeight[INDEX]);
+			const Reg HD = Lanes::load(&m_halfDepth[INDEX]);
+
+			Mask outside = Lanes::none();
+			for(const PlaneLanes& FACE : FACES)
+			{
+				const Reg SIGNED_DISTANCE	= Lanes::sub(FACE.dot(CX, CY, CZ), FACE.distance);
+				const Reg PROJECTED_SIZE	= Lanes::add(Lanes::add(Lanes::abs(Lanes::mul(FACE.nx, HW)), Lanes::abs(Lanes::mul(FACE.ny, HH))), Lanes::abs(Lanes::mul(FACE.nz, HD)));
+				outside = Lanes::either(outside, Lanes::both(Lanes::greater(SIGNED_DISTANCE, ZERO), Lanes::greater(SIGNED_DISTANCE, PROJECTED_SIZE)));
+			}
+
+			return Lanes::only_first(Lanes::all(), outside);
+		});
+		result.clear_tail();
+	}
+
+	/*
+		Slab test from AABB::intersects(Ray).
+		Direction is shared by all boxes, so axes parallel to the ray are resolved once per batch.
+		Entry/exit distances only grow/shrink, so a single comparison at the end replaces the early returns.
+	*/
+	void			AABBPacket::intersects(			const Ray&			RAY,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const Vec3&			ORIGIN		= RAY.origin();
+		const Vec3&			DIRECTION	= RAY.direction();
+		const float*const	CENTERS[3]	= {m_centerX.data(),	m_centerY.data(),		m_centerZ.data()};
+		const float*const	HALVES[3]	= {m_halfWidth.data(),	m_halfHeight.data(),	m_halfDepth.data()};
+
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			Reg		entry	= Lanes::set(0.f);
+			Reg		exit	= Lanes::set(std::numeric_limits<float>::max());
+			Mask	missed	= Lanes::none();
+
+			for(uint32_t axis = 0; axis < 3; ++axis)
+			{
+				const Reg SIGNED_DISTANCE	= Lanes::sub(Lanes::load(CENTERS[axis] + INDEX), Lanes::set(ORIGIN[axis]));
+				const Reg HALF_SIZE			= Lanes::load(HALVES[axis] + INDEX);
+
+				if(DIRECTION[axis] != 0.f)
+				{
+					const Reg D		= Lanes::set(DIRECTION[axis]);
+					const Reg T1	= Lanes::div(Lanes::sub(SIGNED_DISTANCE, HALF_SIZE), D);
+					const Reg T2	= Lanes::div(Lanes::add(SIGNED_DISTANCE, HALF_SIZE), D);
+					entry	= Lanes::max(Lanes::min(T1, T2), entry);
+					exit	= Lanes::min(Lanes::max(T1, T2), exit);
+				}
+				else
+				{
+					missed = Lanes::either(missed, Lanes::greater(Lanes::abs(SIGNED_DISTANCE), HALF_SIZE));
+				}
+			}
+
+			return Lanes::only_first(Lanes::less_equal(entry, exit), missed);
+		});
+		result.clear_tail();
+	}
+
+//=====> AABBPacket private: // functions
+	void			AABBPacket::resize_padded(		const uint32_t		NEW_SIZE)
+	{
+		const uint32_t PADDED_SIZE = padded_size(NEW_SIZE);
+		m_centerX.resize(PADDED_SIZE, 0.f);
+		m_centerY.resize(PADDED_SIZE, 0.f);
+		m_centerZ.resize(PADDED_SIZE, 0.f);
+		m_halfWidth.resize(PADDED_SIZE, 0.f);
+		m_halfHeight.resize(PADDED_SIZE, 0.f);
+		m_halfDepth.resize(PADDED_SIZE, 0.f);
+		size = NEW_SIZE;
+	}
+
+
+
+//=====> SpherePacket public: // lifecycle
+	CLASS_CTOR		SpherePacket::SpherePacket(		const Sphere*		SPHERES,
+													const uint32_t		NUM_SPHERES)
+		: size(0)
+	{
+		resize_padded(NUM_SPHERES);
+		for(uint32_t index = 0; index < NUM_SPHERES; ++index)
+		{
+			set(index, SPHERES[index]);
+		}
+	}
+
+//=====> SpherePacket public: // functions
+	void			SpherePacket::reserve(			const uint32_t		NUM_SPHERES)
+	{
+		const uint32_t CAPACITY = padded_size(NUM_SPHERES);
+		m_centerX.reserve(CAPACITY);
+		m_centerY.reserve(CAPACITY);
+		m_centerZ.reserve(CAPACITY);
+		m_radius.reserve(CAPACITY);
+	}
+
+	void			SpherePacket::clear()
+	{
+		resize_padded(0);
+	}
+
+	void			SpherePacket::add(				const Sphere&		SPHERE)
+	{
+		resize_padded(size() + 1);
+		set(size() - 1, SPHERE);
+	}
+
+	void			SpherePacket::set(				const uint32_t		INDEX,
+													const Sphere&		SPHERE)
+	{
+#ifdef _DEBUG
+		if(INDEX >= size())
+			throw dpl::GeneralException(this, __LINE__, "Invalid sphere index: " + std::to_string(INDEX));
+#endif // _DEBUG
+
+		m_centerX[INDEX]	= SPHERE.center().x;
+		m_centerY[INDEX]	= SPHERE.center().y;
+		m_centerZ[INDEX]	= SPHERE.center().z;
+		m_radius[INDEX]		= SPHERE.radius();
+	}
+
+	Sphere			SpherePacket::get(				const uint32_t		INDEX) const
+	{
+		return Sphere(Vec3(m_centerX[INDEX], m_centerY[INDEX], m_centerZ[INDEX]), m_radius[INDEX]);
+	}
+
+//=====> SpherePacket public: // batch tests
+	void			SpherePacket::above(			const Plane&		PLANE,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const PlaneLanes P = PLANE;
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg DOT = P.dot(Lanes::load(&m_centerX[INDEX]), Lanes::load(&m_centerY[INDEX]), Lanes::load(&m_centerZ[INDEX]));
+			return Lanes::greater(Lanes::sub(DOT, Lanes::load(&m_radius[INDEX])), P.distance);
+		});
+		result.clear_tail();
+	}
+
+	void			SpherePacket::below(			const Plane&		PLANE,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const PlaneLanes P = PLANE;
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg DOT = P.dot(Lanes::load(&m_centerX[INDEX]), Lanes::load(&m_centerY[INDEX]), Lanes::load(&m_centerZ[INDEX]));
+			return Lanes::less(Lanes::add(DOT, Lanes::load(&m_radius[INDEX])), P.distance);
+		});
+		result.clear_tail();
+	}
+
+	void			SpherePacket::intersects(		const Plane&		PLANE,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const PlaneLanes P = PLANE;
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg DOT = P.dot(Lanes::load(&m_centerX[INDEX]), Lanes::load(&m_centerY[INDEX]), Lanes::load(&m_centerZ[INDEX]));
+			return Lanes::less(Lanes::abs(Lanes::sub(DOT, P.distance)), Lanes::load(&m_radius[INDEX]));
+		});
+		result.clear_tail();
+	}
+
+	void			SpherePacket::intersects(		const ConvexHull&	HULL,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const std::vector<PlaneLanes> FACES = broadcast_faces(HULL);
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg CX		= Lanes::load(&m_centerX[INDEX]);
+			const Reg CY		= Lanes::load(&m_centerY[INDEX]);
+			const Reg CZ		= Lanes::load(&m_centerZ[INDEX]);
+			const Reg RADIUS	= Lanes::load(&m_radius[INDEX]);
+
+			Mask outside = Lanes::none();
+			for(const PlaneLanes& FACE : FACES)
+			{
+				outside = Lanes::either(outside, Lanes::greater(Lanes::sub(FACE.dot(CX, CY, CZ), RADIUS), FACE.distance));
+			}
+
+			return Lanes::only_first(Lanes::all(), outside);
+		});
+		result.clear_tail();
+	}
+
+	/*
+		Same test as Sphere::intersects(Ray): ray must start outside the sphere.
+	*/
+	void			SpherePacket::intersects(		const Ray&			RAY,
+													BatchMask&			result) const
+	{
+		result.reset(size());
+		const Reg OX = Lanes::set(RAY.origin().x);
+		const Reg OY = Lanes::set(RAY.origin().y);
+		const Reg OZ = Lanes::set(RAY.origin().z);
+		const Reg DX = Lanes::set(RAY.direction().x);
+		const Reg DY = Lanes::set(RAY.direction().y);
+
+		run_kernel(size(), result, [&](const uint32_t INDEX)
+		{
+			const Reg TX		= Lanes::sub(Lanes::load(&m_centerX[INDEX]), OX);
+			const Reg TY		= Lanes::sub(Lanes::load(&m_centerY[INDEX]), OY);
+			const Reg TZ		= Lanes::sub(Lanes::load(&m_centerZ[INDEX]), OZ);
+			const Reg RADIUS	= Lanes::load(&m_radius[INDEX]);
+			const Reg LENGTH	= Lanes::sqrt(Lanes::add(Lanes::add(Lanes::mul(TX, TX), Lanes::mul(TY, TY)), Lanes::mul(TZ, TZ)));
+			const Reg DET		= Lanes::sub(Lanes::mul(DX, TY), Lanes::mul(TX, DY));
+			return Lanes::only_first(Lanes::less(Lanes::abs(DET), RADIUS), Lanes::less(LENGTH, RADIUS));
+		});
+		result.clear_tail();
+	}
+
+//=====> SpherePacket private: // functions
+	void			SpherePacket::resize_padded(	const uint32_t		NEW_SIZE)
+	{
+		const uint32_t PADDED_SIZE = padded_size(NEW_SIZE);
+		m_centerX.resize(PADDED_SIZE, 0.f);
+		m_centerY.resize(PADDED_SIZE, 0.f);
+		m_centerZ.resize(PADDED_SIZE, 0.f);
+		m_radius.resize(PADDED_SIZE, 0.f);
+		size = NEW_SIZE;
+	}
+
+
+
+
+//=====> EulerAnglesPacket public: // lifecycle
+	CLASS_CTOR		EulerAnglesPacket::EulerAnglesPacket(	const EulerAngles*	ANGLES,
+															const uint32_t		NUM_ANGLES)
+		: size(0)
+	{
+		resize_padded(NUM_ANGLES);
+		for(uint32_t index = 0; index < NUM_ANGLES; ++index)
+		{
+			set(index, ANGLES[index]);
+		}
+	}
+
+	CLASS_CTOR		EulerAnglesPacket::EulerAnglesPacket(	const Quat*			ROTATIONS,
+															const uint32_t		NUM_ROTATIONS,
+															const Precision		PRECISION)
+		: size(0)
+	{
+		reset(ROTATIONS, NUM_ROTATIONS, PRECISION);
+	}
+
+//=====> EulerAnglesPacket public: // functions
+	void			EulerAnglesPacket::reserve(				const uint32_t		NUM_ANGLES)
+	{
+		const uint32_t CAPACITY = padded_size(NUM_ANGLES);
+		m_yaw.reserve(CAPACITY);
+		m_pitch.reserve(CAPACITY);
+		m_roll.reserve(CAPACITY);
+	}
+
+	void			EulerAnglesPacket::clear()
+	{
+		resize_padded(0);
+	}
+
+	void			EulerAnglesPacket::add(					const EulerAngles&	ANGLES)
+	{
+		resize_padded(size() + 1);
+		set(size() - 1, ANGLES);
+	}
+
+	void			EulerAnglesPacket::set(					const uint32_t		INDEX,
+															const EulerAngles&	ANGLES)
+	{
+#ifdef _DEBUG
+		if(INDEX >= size())
+			throw dpl::GeneralException(this, __LINE__, "Invalid angles index: " + std::to_string(INDEX));
+#endif // _DEBUG
+
+		m_yaw[INDEX]	= ANGLES.yaw();
+		m_pitch[INDEX]	= ANGLES.pitch();
+		m_roll[INDEX]	= ANGLES.roll();
+	}
+
+	EulerAngles		EulerAnglesPacket::get(					const uint32_t		INDEX) const
+	{
+		return EulerAngles(m_yaw[INDEX], m_pitch[INDEX], m_roll[INDEX]);
+	}
+
+//=====> EulerAnglesPacket public: // conversions
+	void			EulerAnglesPacket::reset(				const Quat*			ROTATIONS,
+															const uint32_t		NUM_ROTATIONS,
+															const Precision		PRECISION)
+	{
+		resize_padded(NUM_ROTATIONS);
+		if(PRECISION == Precision::PRECISE)
+		{
+			for(uint32_t index = 0; index < NUM_ROTATIONS; ++index)
+			{
+				const Vec3 ANGLES = EulerAngles::calculate_angles(ROTATIONS[index]);
+				m_yaw[index]	= ANGLES.x;
+				m_pitch[index]	= ANGLES.y;
+				m_roll[index]	= ANGLES.z;
+			}
+			return;
+		}
+
+		const uint32_t	W		= Lanes::WIDTH;
+		const Reg		ZERO	= Lanes::set(0.f);
+		const Reg		TWO		= Lanes::set(2.f);
+		const Reg		LIMIT	= Lanes::set(EulerAngles::MAX_HALF_SIN_PITCH);
+		const Reg		HALF_PI	= Lanes::set(EulerAngles::HALF_PI);
+
+		float qw[W], qx[W], qy[W], qz[W];
+		for(uint32_t first = 0; first < NUM_ROTATIONS; first += W)
+		{
+			const uint32_t NUM_LANES = std::min(W, NUM_ROTATIONS - first);
+			for(uint32_t lane = 0; lane < W; ++lane)
+			{
+				const Quat& ROTATION = (lane < NUM_LANES)? ROTATIONS[first + lane] : Quat(1.f, 0.f, 0.f, 0.f);
+				qw[lane] = ROTATION.w;
+				qx[lane] = ROTATION.x;
+				qy[lane] = ROTATION.y;
+				qz[lane] = ROTATION.z;
+			}
+
+			const Reg QW = Lanes::load(qw);
+			const Reg QX = Lanes::load(qx);
+			const Reg QY = Lanes::load(qy);
+			const Reg QZ = Lanes::load(qz);
+
+			const Reg SQ_W = Lanes::mul(QW, QW);
+			const Reg SQ_X = Lanes::mul(QX, QX);
+			const Reg SQ_Y = Lanes::mul(QY, QY);
+			const Reg SQ_Z = Lanes::mul(QZ, QZ);
+
+			const Reg CORRECTION_FACTOR	= Lanes::add(Lanes::add(Lanes::add(SQ_X, SQ_Y), SQ_Z), SQ_W);
+			const Reg HALF_SIN_PITCH	= Lanes::add(Lanes::mul(QX, QY), Lanes::mul(QZ, QW));
+			const Reg POLE_LIMIT		= Lanes::mul(LIMIT, CORRECTION_FACTOR);
+			const Mask NORTH			= Lanes::greater(HALF_SIN_PITCH, POLE_LIMIT);
+			const Mask SOUTH			= Lanes::less(HALF_SIN_PITCH, Lanes::sub(ZERO, POLE_LIMIT));
+
+			const Reg YAW_TOP			= Lanes::mul(TWO, Lanes::sub(Lanes::mul(QY, QW), Lanes::mul(QX, QZ)));
+			const Reg YAW_BOTTOM		= Lanes::sub(Lanes::sub(Lanes::add(SQ_W, SQ_X), SQ_Y), SQ_Z);
+			const Reg ROLL_TOP			= Lanes::mul(TWO, Lanes::sub(Lanes::mul(QX, QW), Lanes::mul(QY, QZ)));
+			const Reg ROLL_BOTTOM		= Lanes::sub(Lanes::add(Lanes::sub(SQ_W, SQ_X), SQ_Y), SQ_Z);
+
+			// Pitch is asin(SIN_PITCH), evaluated as atan2(SIN_PITCH, COS_PITCH).
+			const Reg SIN_PITCH			= Lanes::div(Lanes::mul(TWO, HALF_SIN_PITCH), CORRECTION_FACTOR);
+			const Reg COS_PITCH			= Lanes::sqrt(Lanes::max(Lanes::sub(Lanes::set(1.f), Lanes::mul(SIN_PITCH, SIN_PITCH)), ZERO));
+			const Reg POLE_YAW			= Lanes::mul(TWO, LaneMath::atan2(QX, QW));
+			const Mask POLE				= Lanes::either(NORTH, SOUTH);
+
+			Lanes::store(&m_yaw[first],		Lanes::select(NORTH, POLE_YAW, 
+											Lanes::select(SOUTH, Lanes::sub(ZERO, POLE_YAW), LaneMath::atan2(YAW_TOP, YAW_BOTTOM))));
+			Lanes::store(&m_pitch[first],	Lanes::select(NORTH, HALF_PI, 
+											Lanes::select(SOUTH, Lanes::sub(ZERO, HALF_PI), LaneMath::atan2(SIN_PITCH, COS_PITCH))));
+			Lanes::store(&m_roll[first],	Lanes::select(POLE, ZERO, LaneMath::atan2(ROLL_TOP, ROLL_BOTTOM)));
+		}
+	}
+
+	void			EulerAnglesPacket::to_quats(			Quat*				output,
+															const Precision		PRECISION) const
+	{
+		if(PRECISION == Precision::PRECISE)
+		{
+			for(uint32_t index = 0; index < size(); ++index)
+			{
+				output[index] = EulerAngles::to_quat(m_yaw[index], m_pitch[index], m_roll[index]);
+			}
+			return;
+		}
+
+		const uint32_t W = Lanes::WIDTH;
+		float qw[W], qx[W], qy[W], qz[W];
+		for(uint32_t first = 0; first < size(); first += W)
+		{
+			Reg w, x, y, z;
+			angles_to_quat(&m_yaw[first], &m_pitch[first], &m_roll[first], w, x, y, z);
+			Lanes::store(qw, w);
+			Lanes::store(qx, x);
+			Lanes::store(qy, y);
+			Lanes::store(qz, z);
+
+			const uint32_t NUM_LANES = std::min(W, size() - first);
+			for(uint32_t lane = 0; lane < NUM_LANES; ++lane)
+			{
+				output[first + lane] = Quat(qw[lane], qx[lane], qy[lane], qz[lane]);
+			}
+		}
+	}
+
+	void			EulerAnglesPacket::to_matrices(			Mat3*				output,
+															const Precision		PRECISION) const
+	{
+		if(PRECISION == Precision::PRECISE)
+		{
+			for(uint32_t index = 0; index < size(); ++index)
+			{
+				output[index] = glm::mat3_cast(EulerAngles::to_quat(m_yaw[index], m_pitch[index], m_roll[index]));
+			}
+			return;
+		}
+
+		const uint32_t	W	= Lanes::WIDTH;
+		const Reg		ONE	= Lanes::set(1.f);
+		const Reg		TWO	= Lanes::set(2.f);
+
+		float m[9][W];
+		for(uint32_t first = 0; first < size(); first += W)
+		{
+			Reg w, x, y, z;
+			angles_to_quat(&m_yaw[first], &m_pitch[first], &m_roll[first], w, x, y, z);
+
+			const Reg XX = Lanes::mul(x, x);	const Reg YY = Lanes::mul(y, y);	const Reg ZZ = Lanes::mul(z, z);
+			const Reg XZ = Lanes::mul(x, z);	const Reg XY = Lanes::mul(x, y);	const Reg YZ = Lanes::mul(y, z);
+			const Reg WX = Lanes::mul(w, x);	const Reg WY = Lanes::mul(w, y);	const Reg WZ = Lanes::mul(w, z);
+
+			Lanes::store(m[0], Lanes::sub(ONE, Lanes::mul(TWO, Lanes::add(YY, ZZ))));
+			Lanes::store(m[1], Lanes::mul(TWO, Lanes::add(XY, WZ)));
+			Lanes::store(m[2], Lanes::mul(TWO, Lanes::sub(XZ, WY)));
+			Lanes::store(m[3], Lanes::mul(TWO, Lanes::sub(XY, WZ)));
+			Lanes::store(m[4], Lanes::sub(ONE, Lanes::mul(TWO, Lanes::add(XX, ZZ))));
+			Lanes::store(m[5], Lanes::mul(TWO, Lanes::add(YZ, WX)));
+			Lanes::store(m[6], Lanes::mul(TWO, Lanes::add(XZ, WY)));
+			Lanes::store(m[7], Lanes::mul(TWO, Lanes::sub(YZ, WX)));
+			Lanes::store(m[8], Lanes::sub(ONE, Lanes::mul(TWO, Lanes::add(XX, YY))));
+
+			const uint32_t NUM_LANES = std::min(W, size() - first);
+			for(uint32_t lane = 0; lane < NUM_LANES; ++lane)
+			{
+				Mat3& matrix = output[first + lane];
+				for(uint32_t element = 0; element < 9; ++element)
+				{
+					matrix[element / 3][element % 3] = m[element][lane];
+				}
+			}
+		}
+	}
+
+//=====> EulerAnglesPacket private: // functions
+	void			EulerAnglesPacket::resize_padded(		const uint32_t		NEW_SIZE)
+	{
+		const uint32_t PADDED_SIZE = padded_size(NEW_SIZE);
+		m_yaw.resize(PADDED_SIZE, 0.f);
+		m_pitch.resize(PADDED_SIZE, 0.f);
+		m_roll.resize(PADDED_SIZE, 0.f);
+		size = NEW_SIZE;
+	}
+
+//=====> batch transforms
+	void	transform_bounds(	const AABB*			LOCAL_BOXES,
+								const Mat4*			TRANSFORMATIONS,
+								const uint32_t		NUM_INSTANCES,
+								AABB*				output,
+								dpl::ThreadPool*	pool)
+	{
+		run_chunks(NUM_INSTANCES, pool, [&](const uint32_t BEGIN, const uint32_t END)
+		{
+			Vec3 center, extents;
+			for(uint32_t index = BEGIN; index < END; ++index)
+			{
+				transform_box(LOCAL_BOXES[index], TRANSFORMATIONS[index], center, extents);
+				output[index].set_center(center);
+				output[index].set_extents(extents);
+			}
+		});
+	}
+
+	void	transform_bounds(	const AABB*			LOCAL_BOXES,
+								const Mat4*			TRANSFORMATIONS,
+								const uint32_t		NUM_INSTANCES,
+								OBB*				output,
+								dpl::ThreadPool*	pool)
+	{
+		run_chunks(NUM_INSTANCES, pool, [&](const uint32_t BEGIN, const uint32_t END)
+		{
+			for(uint32_t index = BEGIN; index < END; ++index)
+			{
+				transform_box(LOCAL_BOXES[index], TRANSFORMATIONS[index], output[index]);
+			}
+		});
+	}
+}
\ No newline at end of file
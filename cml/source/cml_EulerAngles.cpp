@@ -575,40 +575,10 @@ namespace cml
 
 	void		EulerAngles::set_from_quat(			const Quat&		ROTATION)
 	{
-		const float SQ_W = ROTATION.w * ROTATION.w;
-		const float SQ_X = ROTATION.x * ROTATION.x;
-		const float SQ_Y = ROTATION.y * ROTATION.y;
-		const float SQ_Z = ROTATION.z * ROTATION.z;
-
-		const float CORRECTION_FACTOR	= SQ_X + SQ_Y + SQ_Z + SQ_W; // if normalised is one, otherwise is correction factor
-		const float HALF_SIN_PITCH		= ROTATION.x * ROTATION.y + ROTATION.z * ROTATION.w;
-		static const float MAX_HALF_SIN_PITCH = 0.499f;
-
-		if (HALF_SIN_PITCH > MAX_HALF_SIN_PITCH * CORRECTION_FACTOR) 
-		{ // singularity at north pole
-			yaw		= 2.f * atan2(ROTATION.x, ROTATION.w);
-			pitch	= glm::pi<float>() / 2.f;
-			roll	= 0.f;
-			return;
-		}
-		if (HALF_SIN_PITCH < -MAX_HALF_SIN_PITCH * CORRECTION_FACTOR) 
-		{ // singularity at south pole
-			yaw		= -2.f * atan2(ROTATION.x, ROTATION.w);
-			pitch	= -glm::pi<float>() / 2.f;
-			roll	= 0.f;
-		}
-		else
-		{
-			const float YAW_TOP		= 2.f * (ROTATION.y * ROTATION.w - ROTATION.x * ROTATION.z);
-			const float YAW_BOTTOM	= SQ_W + SQ_X - SQ_Y - SQ_Z;
-
-			const float ROLL_TOP	= 2.f * (ROTATION.x * ROTATION.w - ROTATION.y * ROTATION.z);
-			const float ROLL_BOTTOM = SQ_W - SQ_X + SQ_Y - SQ_Z;
-
-			yaw		= (YAW_TOP == 0.f && YAW_BOTTOM == 0.f) ? 0.f : atan2(YAW_TOP, YAW_BOTTOM);
-			pitch	= asin(2.f * HALF_SIN_PITCH / CORRECTION_FACTOR);
-			roll	= (ROLL_TOP == 0.f && ROLL_BOTTOM == 0.f) ? 0.f : atan2(ROLL_TOP, ROLL_BOTTOM);
-		}
+		const Vec3 ANGLES = calculate_angles(ROTATION);
+		yaw		= ANGLES.x;
+		pitch	= ANGLES.y;
+		roll	= ANGLES.z;
 	}
 
 	void		EulerAngles::set_only_yaw(			const Quat&		ROTATION)
@@ -671,15 +641,17 @@ namespace cml
 		}
 	}
 
-	Quat		EulerAngles::to_quat() const
+	Quat		EulerAngles::to_quat(				const float		YAW_RADIANS,
+													const float		PITCH_RADIANS,
+													const float		ROLL_RADIANS)
 	{
 		// This formula was found with YPR_to_Quat process.
-		const float cy = glm::cos(yaw() * 0.5f);
-		const float sy = glm::sin(yaw() * 0.5f);
-		const float cp = glm::cos(pitch() * 0.5f);
-		const float sp = glm::sin(pitch() * 0.5f);
-		const float cr = glm::cos(roll() * 0.5f);
-		const float sr = glm::sin(roll() * 0.5f);
+		const float cy = glm::cos(YAW_RADIANS * 0.5f);
+		const float sy = glm::sin(YAW_RADIANS * 0.5f);
+		const float cp = glm::cos(PITCH_RADIANS * 0.5f);
+		const float sp = glm::sin(PITCH_RADIANS * 0.5f);
+		const float cr = glm::cos(ROLL_RADIANS * 0.5f);
+		const float sr = glm::sin(ROLL_RADIANS * 0.5f);
 
 		Quat	quat;
 				quat.w = cy * cr * cp - sy * sr * sp;
@@ -690,6 +662,36 @@ namespace cml
 		return quat;
 	}
 
+	Vec3		EulerAngles::calculate_angles(		const Quat&		ROTATION)
+	{
+		const float SQ_W = ROTATION.w * ROTATION.w;
+		const float SQ_X = ROTATION.x * ROTATION.x;
+		const float SQ_Y = ROTATION.y * ROTATION.y;
+		const float SQ_Z = ROTATION.z * ROTATION.z;
+
+		const float CORRECTION_FACTOR	= SQ_X + SQ_Y + SQ_Z + SQ_W; // if normalised is one, otherwise is correction factor
+		const float HALF_SIN_PITCH		= ROTATION.x * ROTATION.y + ROTATION.z * ROTATION.w;
+
+		if (HALF_SIN_PITCH > MAX_HALF_SIN_PITCH * CORRECTION_FACTOR) 
+		{ // singularity at north pole
+			return Vec3(2.f * atan2(ROTATION.x, ROTATION.w), glm::pi<float>() / 2.f, 0.f);
+		}
+		if (HALF_SIN_PITCH < -MAX_HALF_SIN_PITCH * CORRECTION_FACTOR) 
+		{ // singularity at south pole
+			return Vec3(-2.f * atan2(ROTATION.x, ROTATION.w), -glm::pi<float>() / 2.f, 0.f);
+		}
+
+		const float YAW_TOP		= 2.f * (ROTATION.y * ROTATION.w - ROTATION.x * ROTATION.z);
+		const float YAW_BOTTOM	= SQ_W + SQ_X - SQ_Y - SQ_Z;
+
+		const float ROLL_TOP	= 2.f * (ROTATION.x * ROTATION.w - ROTATION.y * ROTATION.z);
+		const float ROLL_BOTTOM = SQ_W - SQ_X + SQ_Y - SQ_Z;
+
+		return Vec3((YAW_TOP == 0.f && YAW_BOTTOM == 0.f) ? 0.f : atan2(YAW_TOP, YAW_BOTTOM),
+					asin(2.f * HALF_SIN_PITCH / CORRECTION_FACTOR),
+					(ROLL_TOP == 0.f && ROLL_BOTTOM == 0.f) ? 0.f : atan2(ROLL_TOP, ROLL_BOTTOM));
+	}
+
 //=====> EulerAngles -> private functions
 	void		EulerAngles::test_YPR_quat_conversions()
 	{
@@ -0,0 +1,230 @@
+#include "../include/cml_FrustumCuller.h"
+#include "../include/cml_ConvexHull.h"
+#include <dpl_ThreadPool.h>
+#include <dpl_GeneralException.h>
+#include <bit>
+#include <string>
+
+
+namespace cml
+{
+	namespace
+	{
+		inline uint32_t	full_mask(				const uint32_t		NUM_PLANES)
+		{
+			return (NUM_PLANES >= 32)? std::numeric_limits<uint32_t>::max() : (1u << NUM_PLANES) - 1u;
+		}
+
+		/*
+			Plane with normal pointing outwards from the row combination of the matrix(inside when dot(ROW, Vec4(point, 1)) >= 0).
+		*/
+		inline Plane	clip_plane(				const Vec4&			ROW)
+		{
+			const Vec3	NORMAL	= Vec3(ROW);
+			const float	LENGTH	= calculate_length(NORMAL);
+			return (LENGTH > 0.f)? Plane(-NORMAL / LENGTH, ROW.w / LENGTH) : Plane(-NORMAL, ROW.w);
+		}
+	}
+
+
+
+//=====> FrustumCuller public: // functions
+	ConvexHull		FrustumCuller::extract_frustum(		const Mat4&			VIEW_PROJECTION)
+	{
+		const Mat4 ROWS = glm::transpose(VIEW_PROJECTION);
+		const Plane PLANES[6] =
+		{
+			clip_plane(ROWS[3] + ROWS[0]),
+			clip_plane(ROWS[3] - ROWS[0]),
+			clip_plane(ROWS[3] + ROWS[1]),
+			clip_plane(ROWS[3] - ROWS[1]),
+			clip_plane(ROWS[3] + ROWS[2]),
+			clip_plane(ROWS[3] - ROWS[2])
+		};
+		return ConvexHull(PLANES, 6);
+	}
+
+	void			FrustumCuller::cull(				const AABBTree&		TREE,
+														const ConvexHull*	FRUSTUMS,
+														const uint32_t		NUM_VIEWS,
+														dpl::ThreadPool*	pool)
+	{
+		visible->resize(NUM_VIEWS);
+		m_views.resize(NUM_VIEWS);
+		m_numTasks = 0;
+		for(uint32_t viewID = 0; viewID < NUM_VIEWS; ++viewID)
+		{
+			(*visible)[viewID].clear();
+			prepare_view(TREE, FRUSTUMS[viewID], m_views[viewID]);
+		}
+
+		if(TREE.empty()) return;
+
+		if(!pool)
+		{
+			for(uint32_t viewID = 0; viewID < NUM_VIEWS; ++viewID)
+			{
+				View&		view	= m_views[viewID];
+				uint32_t	mask	= full_mask(static_cast<uint32_t>(view.planes.size()));
+				if(classify(TREE.nodes()[TREE.root()], view.planes.data(), static_cast<uint32_t>(view.planes.size()), view.lastPlanes[TREE.root()], mask))
+					cull_subtree(TREE, view, TREE.root(), mask, (*visible)[viewID]);
+			}
+			return;
+		}
+
+		for(uint32_t viewID = 0; viewID < NUM_VIEWS; ++viewID)
+		{
+			split(TREE, viewID, TREE.root(), full_mask(static_cast<uint32_t>(m_views[viewID].planes.size())));
+		}
+
+		for(uint32_t taskID = 0; taskID < m_numTasks; ++taskID)
+		{
+			pool->add_task([this, &TREE, taskID]()
+			{
+				Task& task = m_tasks[taskID];
+				cull_subtree(TREE, m_views[task.view], task.node, task.mask, task.visible);
+			});
+		}
+		pool->wait();
+
+		for(uint32_t taskID = 0; taskID < m_numTasks; ++taskID)
+		{
+			const Task& TASK = m_tasks[taskID];
+			std::vector<uint32_t>& output = (*visible)[TASK.view];
+			output.insert(output.end(), TASK.visible.begin(), TASK.visible.end());
+		}
+	}
+
+	void			FrustumCuller::clear()
+	{
+		visible->clear();
+		m_views.clear();
+		m_tasks.clear();
+		m_numTasks = 0;
+	}
+
+//=====> FrustumCuller private: // functions
+	void			FrustumCuller::prepare_view(		const AABBTree&		TREE,
+														const ConvexHull&	FRUSTUM,
+														View&				view)
+	{
+		if(FRUSTUM.faces().size() > MAX_PLANES)
+			throw dpl::GeneralException(this, __LINE__, "Too many planes: " + std::to_string(FRUSTUM.faces().size()));
+
+		view.planes.clear();
+		for(const Plane& FACE : FRUSTUM.faces())
+		{
+			view.planes.push_back({FACE.normal(), glm::abs(FACE.normal()), FACE.distance()});
+		}
+
+		// Node indices are reused by the tree, so remembered planes are only a hint.
+		view.lastPlanes.resize(TREE.nodes().size(), 0);
+	}
+
+	bool			FrustumCuller::classify(			const AABBTree::Node& NODE,
+														const FrustumPlane*	PLANES,
+														const uint32_t		NUM_PLANES,
+														uint8_t&			lastPlane,
+														uint32_t&			mask)
+	{
+		const Vec3 CENTER		= (NODE.min + NODE.max) * 0.5f;
+		const Vec3 HALF_SIZE	= (NODE.max - NODE.min) * 0.5f;
+
+		// Returns 1 if node is entirely above the plane, -1 if entirely below and 0 if it intersects the plane.
+		const auto SIDE = [&](const uint32_t PLANE_ID)
+		{
+			const FrustumPlane& PLANE			= PLANES[PLANE_ID];
+			const float			SIGNED_DISTANCE	= calculate_dot(PLANE.normal, CENTER) - PLANE.distance;
+			const float			PROJECTED_SIZE	= calculate_dot(PLANE.absNormal, HALF_SIZE);
+			return (SIGNED_DISTANCE > PROJECTED_SIZE)? 1 : (SIGNED_DISTANCE < -PROJECTED_SIZE)? -1 : 0;
+		};
+
+		const uint32_t FIRST = lastPlane;
+		if(FIRST < NUM_PLANES && (mask & (1u << FIRST)))
+		{
+			const int FIRST_SIDE = SIDE(FIRST);
+			if(FIRST_SIDE > 0)	return false;
+			if(FIRST_SIDE < 0)	mask &= ~(1u << FIRST);
+		}
+
+		for(uint32_t bits = mask; bits != 0; bits &= bits - 1)
+		{
+			const uint32_t PLANE_ID = static_cast<uint32_t>(std::countr_zero(bits));
+			if(PLANE_ID == FIRST) continue;
+
+			const int PLANE_SIDE = SIDE(PLANE_ID);
+			if(PLANE_SIDE > 0)
+			{
+				lastPlane = static_cast<uint8_t>(PLANE_ID);
+				return false;
+			}
+
+			if(PLANE_SIDE < 0) mask &= ~(1u << PLANE_ID);
+		}
+
+		return true;
+	}
+
+	void			FrustumCuller::split(				const AABBTree&		TREE,
+														const uint32_t		VIEW,
+														const uint32_t		NODE_INDEX,
+														uint32_t			mask)
+	{
+		View&					view	= m_views[VIEW];
+		const AABBTree::Node&	NODE	= TREE.nodes()[NODE_INDEX];
+		if(mask != 0 && !classify(NODE, view.planes.data(), static_cast<uint32_t>(view.planes.size()), view.lastPlanes[NODE_INDEX], mask))
+			return;
+
+		if(NODE.height > TASK_HEIGHT && mask != 0)
+		{
+			split(TREE, VIEW, NODE.children[0], mask);
+			split(TREE, VIEW, NODE.children[1], mask);
+			return;
+		}
+
+		if(m_numTasks == m_tasks.size()) m_tasks.emplace_back();
+		Task& task	= m_tasks[m_numTasks++];
+		task.view	= VIEW;
+		task.node	= NODE_INDEX;
+		task.mask	= mask;
+		task.visible.clear();
+	}
+
+	void			FrustumCuller::cull_subtree(		const AABBTree&		TREE,
+														View&				view,
+														const uint32_t		NODE_INDEX,
+														const uint32_t		MASK,
+														std::vector<uint32_t>& output)
+	{
+		const uint32_t NUM_PLANES = static_cast<uint32_t>(view.planes.size());
+
+		// Nodes on the stack already passed the test with their masks.
+		struct	Entry
+		{
+			uint32_t node;
+			uint32_t mask;
+		};
+
+		AABBTree::TraversalStack<Entry> stack(TREE.nodes()[NODE_INDEX].height);
+		stack.push({NODE_INDEX, MASK});
+
+		while(!stack.empty())
+		{
+			const Entry				ENTRY	= stack.pop();
+			const AABBTree::Node&	NODE	= TREE.nodes()[ENTRY.node];
+			if(NODE.height == 0)
+			{
+				output.push_back(NODE.userData);
+				continue;
+			}
+
+			for(uint32_t childID = 0; childID < 2; ++childID)
+			{
+				const uint32_t	CHILD	= NODE.children[1 - childID]; // Left child is popped first.
+				uint32_t		mask	= ENTRY.mask;
+				if(mask == 0 || classify(TREE.nodes()[CHILD], view.planes.data(), NUM_PLANES, view.lastPlanes[CHILD], mask))
+					stack.push({CHILD, mask});
+			}
+		}
+	}
+}
\ No newline at end of file
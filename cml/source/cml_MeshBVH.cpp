@@ -0,0 +1,808 @@
+#include "../include/cml_Ray.h"
+#include "../include/cml_AABB.h"
+#include "../include/cml_OBB.h"
+#include "../include/cml_Sphere.h"
+#include "../include/cml_MeshBVH.h"
+#include <dpl_GeneralException.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+
+namespace cml
+{
+	namespace
+	{
+		const float		MISS			= std::numeric_limits<float>::infinity();
+		const uint32_t	MAX_BINS		= 64;
+		const uint32_t	SAH_DEPTH		= MeshBVH::MAX_DEPTH / 2;	// Deeper nodes are split at the median, so depth never exceeds MAX_DEPTH.
+		const uint32_t	RAY_CHUNK_SIZE	= 256;
+		const uint32_t	GRID_SIZE		= 0xFFFF;
+
+		inline float	half_area(				const Vec3&			MIN,
+												const Vec3&			MAX)
+		{
+			const Vec3 SIZE = MAX - MIN;
+			return SIZE.x * SIZE.y + SIZE.y * SIZE.z + SIZE.z * SIZE.x;
+		}
+
+		/*
+			Returns 1/direction, zero components are replaced with a huge value(no NaNs in the slab test).
+		*/
+		inline Vec3		safe_inverse(			const Vec3&			DIRECTION)
+		{
+			Vec3 inverse;
+			for(uint32_t axis = 0; axis < 3; ++axis)
+			{
+				inverse[axis] = (DIRECTION[axis] != 0.f)? 1.f / DIRECTION[axis] : std::copysign(1e30f, DIRECTION[axis]);
+			}
+			return inverse;
+		}
+
+		/*
+			Returns entry distance of the ray into the box or MISS.
+		*/
+		inline float	ray_box_entry(			const Vec3&			ORIGIN,
+												const Vec3&			INVERSE_DIRECTION,
+												const Vec3&			MIN,
+												const Vec3&			MAX,
+												const float			MAX_DISTANCE)
+		{
+			const Vec3 T1		= (MIN - ORIGIN) * INVERSE_DIRECTION;
+			const Vec3 T2		= (MAX - ORIGIN) * INVERSE_DIRECTION;
+			const Vec3 NEAR		= glm::min(T1, T2);
+			const Vec3 FAR		= glm::max(T1, T2);
+			const float ENTRY	= std::max(std::max(NEAR.x, NEAR.y), std::max(NEAR.z, 0.f));
+			const float EXIT	= std::min(std::min(FAR.x, FAR.y), std::min(FAR.z, MAX_DISTANCE));
+			return (ENTRY <= EXIT)? ENTRY : MISS;
+		}
+
+		/*
+			Moller-Trumbore, both sides of the triangle are hit.
+		*/
+		inline bool		ray_triangle(			const Vec3&			ORIGIN,
+												const Vec3&			DIRECTION,
+												const Vec3&			A,
+												const Vec3&			B,
+												const Vec3&			C,
+												float&				distance,
+												Vec2&				barycentric)
+		{
+			const Vec3	AB		= B - A;
+			const Vec3	AC		= C - A;
+			const Vec3	P		= glm::cross(DIRECTION, AC);
+			const float	DET		= glm::dot(AB, P);
+			if(std::abs(DET) < std::numeric_limits<float>::min()) return false;
+
+			const float	INV_DET	= 1.f / DET;
+			const Vec3	TO_ORIGIN = ORIGIN - A;
+			const float	U		= glm::dot(TO_ORIGIN, P) * INV_DET;
+			if(U < 0.f || U > 1.f) return false;
+
+			const Vec3	Q		= glm::cross(TO_ORIGIN, AB);
+			const float	V		= glm::dot(DIRECTION, Q) * INV_DET;
+			if(V < 0.f || U + V > 1.f) return false;
+
+			distance	= glm::dot(AC, Q) * INV_DET;
+			barycentric	= Vec2(U, V);
+			return distance >= 0.f;
+		}
+
+		inline float	point_box_distance2(	const Vec3&			POINT,
+												const Vec3&			MIN,
+												const Vec3&			MAX)
+		{
+			const Vec3 OUTSIDE = glm::max(MIN - POINT, glm::max(POINT - MAX, Vec3(0.f)));
+			return glm::dot(OUTSIDE, OUTSIDE);
+		}
+
+		/*
+			Real-Time Collision Detection(Ericson), 5.1.5.
+		*/
+		Vec3			closest_on_triangle(	const Vec3&			P,
+												const Vec3&			A,
+												const Vec3&			B,
+												const Vec3&			C)
+		{
+			const Vec3	AB = B - A;
+			const Vec3	AC = C - A;
+			const Vec3	AP = P - A;
+			const float	D1 = glm::dot(AB, AP);
+			const float	D2 = glm::dot(AC, AP);
+			if(D1 <= 0.f && D2 <= 0.f) return A;
+
+			const Vec3	BP = P - B;
+			const float	D3 = glm::dot(AB, BP);
+			const float	D4 = glm::dot(AC, BP);
+			if(D3 >= 0.f && D4 <= D3) return B;
+
+			const float	VC = D1 * D4 - D3 * D2;
+			if(VC <= 0.f && D1 >= 0.f && D3 <= 0.f) return A + AB * (D1 / (D1 - D3));
+
+			const Vec3	CP = P - C;
+			const float	D5 = glm::dot(AB, CP);
+			const float	D6 = glm::dot(AC, CP);
+			if(D6 >= 0.f && D5 <= D6) return C;
+
+			const float	VB = D5 * D2 - D1 * D6;
+			if(VB <= 0.f && D2 >= 0.f && D6 <= 0.f) return A + AC * (D2 / (D2 - D6));
+
+			const float	VA = D3 * D6 - D5 * D4;
+			if(VA <= 0.f && (D4 - D3) >= 0.f && (D5 - D6) >= 0.f) return B + (C - B) * ((D4 - D3) / ((D4 - D3) + (D5 - D6)));
+
+			const float	DENOM = 1.f / (VA + VB + VC);
+			return A + AB * (VB * DENOM) + AC * (VC * DENOM);
+		}
+
+		/*
+			Separating axis test of the triangle(relative to the box center) and the box(Akenine-Moller).
+		*/
+		bool			triangle_overlaps_box(	const Vec3&			A,
+												const Vec3&			B,
+												const Vec3&			C,
+												const Vec3&			HALF_SIZE)
+		{
+			// Box face normals.
+			if(glm::any(glm::greaterThan(glm::min(A, glm::min(B, C)), HALF_SIZE)))	return false;
+			if(glm::any(glm::lessThan(glm::max(A, glm::max(B, C)), -HALF_SIZE)))	return false;
+
+			// Triangle normal.
+			const Vec3	EDGES[3]	= {B - A, C - B, A - C};
+			const Vec3	NORMAL		= glm::cross(EDGES[0], EDGES[1]);
+			const float	RADIUS		= glm::dot(glm::abs(NORMAL), HALF_SIZE);
+			if(std::abs(glm::dot(NORMAL, A)) > RADIUS) return false;
+
+			// Cross products of the edges and box axes.
+			for(const Vec3& EDGE : EDGES)
+			{
+				for(uint32_t axis = 0; axis < 3; ++axis)
+				{
+					Vec3 L(0.f);
+					L[(axis + 1) % 3] = -EDGE[(axis + 2) % 3];
+					L[(axis + 2) % 3] =  EDGE[(axis + 1) % 3];
+
+					const float PA = glm::dot(L, A);
+					const float PB = glm::dot(L, B);
+					const float PC = glm::dot(L, C);
+					const float R  = glm::dot(glm::abs(L), HALF_SIZE);
+					if(std::min(PA, std::min(PB, PC)) > R || std::max(PA, std::max(PB, PC)) < -R) return false;
+				}
+			}
+
+			return true;
+		}
+	}
+
+
+
+	struct	MeshBVH::BuildData
+	{
+		std::vector<Vec3> centroids;
+		std::vector<Vec3> minima;
+		std::vector<Vec3> maxima;
+	};
+
+
+
+//=====> MeshBVH public: // lifecycle
+	CLASS_CTOR		MeshBVH::MeshBVH()
+		: m_mesh(nullptr)
+		, m_numNodes(0)
+		, m_gridOrigin(0.f)
+		, m_gridScale(1.f)
+	{
+
+	}
+
+//=====> MeshBVH public: // functions
+	void			MeshBVH::build(						const TriangleMesh&	MESH,
+														const Settings&		SETTINGS,
+														dpl::ThreadPool*	pool)
+	{
+		if(SETTINGS.maxLeafSize < 1 || SETTINGS.maxLeafSize > 16)
+			throw dpl::GeneralException(this, __LINE__, "Invalid leaf size: " + std::to_string(SETTINGS.maxLeafSize));
+
+		if(SETTINGS.numBins < 2 || SETTINGS.numBins > MAX_BINS)
+			throw dpl::GeneralException(this, __LINE__, "Invalid number of bins: " + std::to_string(SETTINGS.numBins));
+
+		MESH.validate_index_count();
+		clear();
+		m_mesh		= &MESH;
+		settings	= SETTINGS;
+
+		const uint32_t NUM_TRIANGLES = MESH.get_numIndices() / 3;
+		if(NUM_TRIANGLES == 0) return;
+
+		BuildData data;
+		data.centroids.resize(NUM_TRIANGLES);
+		data.minima.resize(NUM_TRIANGLES);
+		data.maxima.resize(NUM_TRIANGLES);
+		for(uint32_t triangleID = 0; triangleID < NUM_TRIANGLES; ++triangleID)
+		{
+			const auto TRIANGLE = get_triangle(triangleID);
+			data.minima[triangleID]		= glm::min(TRIANGLE[0], glm::min(TRIANGLE[1], TRIANGLE[2]));
+			data.maxima[triangleID]		= glm::max(TRIANGLE[0], glm::max(TRIANGLE[1], TRIANGLE[2]));
+			data.centroids[triangleID]	= (data.minima[triangleID] + data.maxima[triangleID]) * 0.5f;
+		}
+
+		m_triangles.resize(NUM_TRIANGLES);
+		std::iota(m_triangles.begin(), m_triangles.end(), 0);
+		m_nodes.resize(2 * NUM_TRIANGLES - 1);
+		m_numNodes = 1;
+
+		build_node(data, 0, 0, NUM_TRIANGLES, 0, pool);
+		if(pool) pool->wait();
+
+		m_nodes.resize(m_numNodes);
+		m_nodes.shrink_to_fit();
+		if(settings().bQuantized) quantize();
+	}
+
+	void			MeshBVH::refit()
+	{
+		if(empty()) return;
+
+		if(settings().bQuantized) // Restore topology of the nodes.
+		{
+			m_nodes.resize(m_quantizedNodes.size());
+			for(uint32_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+			{
+				is_leaf(nodeIndex, m_nodes[nodeIndex].index, m_nodes[nodeIndex].count);
+			}
+		}
+
+		// Children are always stored after their parents.
+		for(uint32_t nodeIndex = static_cast<uint32_t>(m_nodes.size()); nodeIndex-- > 0;)
+		{
+			Node& node = m_nodes[nodeIndex];
+			if(node.count > 0)
+			{
+				node.min = Vec3(std::numeric_limits<float>::max());
+				node.max = Vec3(std::numeric_limits<float>::lowest());
+				for(uint32_t offset = 0; offset < node.count; ++offset)
+				{
+					for(const Vec3& VERTEX : get_triangle(m_triangles[node.index + offset]))
+					{
+						node.min = glm::min(node.min, VERTEX);
+						node.max = glm::max(node.max, VERTEX);
+					}
+				}
+			}
+			else
+			{
+				const Node& LEFT	= m_nodes[node.index];
+				const Node& RIGHT	= m_nodes[node.index + 1];
+				node.min = glm::min(LEFT.min, RIGHT.min);
+				node.max = glm::max(LEFT.max, RIGHT.max);
+			}
+		}
+
+		if(settings().bQuantized) quantize();
+	}
+
+	void			MeshBVH::clear()
+	{
+		m_mesh = nullptr;
+		m_nodes.clear();
+		m_quantizedNodes.clear();
+		m_triangles.clear();
+		m_numNodes = 0;
+	}
+
+//=====> MeshBVH public: // queries
+	std::optional<MeshBVH::RayHit>		MeshBVH::raycast(	const Ray&			RAY,
+															const float			MAX_DISTANCE) const
+	{
+		if(empty()) return std::nullopt;
+
+		const Vec3&	ORIGIN		= RAY.origin();
+		const Vec3&	DIRECTION	= RAY.direction();
+		const Vec3	INVERSE		= safe_inverse(DIRECTION);
+
+		struct	Entry
+		{
+			uint32_t	node;
+			float		distance;
+		};
+
+		RayHit	hit		= {MAX_DISTANCE, 0, Vec2(0.f)};
+		bool	bHit	= false;
+		Entry	stack[2 * MAX_DEPTH];
+		uint32_t stackSize = 0;
+
+		Vec3 min, max;
+		get_bounds(0, min, max);
+		const float ROOT_ENTRY = ray_box_entry(ORIGIN, INVERSE, min, max, hit.distance);
+		if(ROOT_ENTRY == MISS) return std::nullopt;
+		stack[stackSize++] = {0, ROOT_ENTRY};
+
+		while(stackSize > 0)
+		{
+			const Entry ENTRY = stack[--stackSize];
+			if(ENTRY.distance > hit.distance) continue;
+
+			uint32_t first, count;
+			if(is_leaf(ENTRY.node, first, count))
+			{
+				for(uint32_t offset = 0; offset < count; ++offset)
+				{
+					const uint32_t	TRIANGLE_ID	= m_triangles[first + offset];
+					const auto		TRIANGLE	= get_triangle(TRIANGLE_ID);
+					float			distance;
+					Vec2			barycentric;
+					if(ray_triangle(ORIGIN, DIRECTION, TRIANGLE[0], TRIANGLE[1], TRIANGLE[2], distance, barycentric) && distance <= hit.distance)
+					{
+						hit		= {distance, TRIANGLE_ID, barycentric};
+						bHit	= true;
+					}
+				}
+			}
+			else // Nearer child is visited first.
+			{
+				get_bounds(first, min, max);
+				const float LEFT = ray_box_entry(ORIGIN, INVERSE, min, max, hit.distance);
+				get_bounds(first + 1, min, max);
+				const float RIGHT = ray_box_entry(ORIGIN, INVERSE, min, max, hit.distance);
+
+				const bool bLEFT_FIRST = LEFT <= RIGHT;
+				const Entry NEAR	= bLEFT_FIRST? Entry{first, LEFT} : Entry{first + 1, RIGHT};
+				const Entry FAR		= bLEFT_FIRST? Entry{first + 1, RIGHT} : Entry{first, LEFT};
+				if(FAR.distance != MISS)	stack[stackSize++] = FAR;
+				if(NEAR.distance != MISS)	stack[stackSize++] = NEAR;
+			}
+		}
+
+		if(!bHit) return std::nullopt;
+		return hit;
+	}
+
+	void			MeshBVH::raycast(					const Ray*			RAYS,
+														const uint32_t		NUM_RAYS,
+														std::optional<RayHit>* hits,
+														dpl::ThreadPool*	pool,
+														const float			MAX_DISTANCE) const
+	{
+		const auto CAST_CHUNK = [this, RAYS, hits, MAX_DISTANCE](const uint32_t BEGIN, const uint32_t END)
+		{
+			for(uint32_t rayID = BEGIN; rayID < END; ++rayID)
+			{
+				hits[rayID] = raycast(RAYS[rayID], MAX_DISTANCE);
+			}
+		};
+
+		if(!pool || NUM_RAYS <= RAY_CHUNK_SIZE)
+			return CAST_CHUNK(0, NUM_RAYS);
+
+		for(uint32_t begin = 0; begin < NUM_RAYS; begin += RAY_CHUNK_SIZE)
+		{
+			const uint32_t END = std::min(begin + RAY_CHUNK_SIZE, NUM_RAYS);
+			pool->add_task([CAST_CHUNK, begin, END](){ CAST_CHUNK(begin, END); });
+		}
+		pool->wait();
+	}
+
+	std::optional<MeshBVH::ClosestPoint>	MeshBVH::closest_point(	const Vec3&			POINT,
+																	const float			MAX_DISTANCE) const
+	{
+		if(empty()) return std::nullopt;
+
+		struct	Entry
+		{
+			uint32_t	node;
+			float		distance2;
+		};
+
+		ClosestPoint	closest		= {POINT, MAX_DISTANCE * MAX_DISTANCE, 0};
+		bool			bFound		= false;
+		Entry			stack[2 * MAX_DEPTH];
+		uint32_t		stackSize	= 0;
+
+		Vec3 min, max;
+		get_bounds(0, min, max);
+		stack[stackSize++] = {0, point_box_distance2(POINT, min, max)};
+
+		while(stackSize > 0)
+		{
+			const Entry ENTRY = stack[--stackSize];
+			if(ENTRY.distance2 > closest.distance) continue;
+
+			uint32_t first, count;
+			if(is_leaf(ENTRY.node, first, count))
+			{
+				for(uint32_t offset = 0; offset < count; ++offset)
+				{
+					const uint32_t	TRIANGLE_ID	= m_triangles[first + offset];
+					const auto		TRIANGLE	= get_triangle(TRIANGLE_ID);
+					const Vec3		CANDIDATE	= closest_on_triangle(POINT, TRIANGLE[0], TRIANGLE[1], TRIANGLE[2]);
+					const Vec3		OFFSET		= CANDIDATE - POINT;
+					const float		DISTANCE2	= glm::dot(OFFSET, OFFSET);
+					if(DISTANCE2 <= closest.distance)
+					{
+						closest	= {CANDIDATE, DISTANCE2, TRIANGLE_ID};
+						bFound	= true;
+					}
+				}
+			}
+			else
+			{
+				get_bounds(first, min, max);
+				const float LEFT = point_box_distance2(POINT, min, max);
+				get_bounds(first + 1, min, max);
+				const float RIGHT = point_box_distance2(POINT, min, max);
+
+				const bool bLEFT_FIRST = LEFT <= RIGHT;
+				if(std::max(LEFT, RIGHT) <= closest.distance)	stack[stackSize++] = bLEFT_FIRST? Entry{first + 1, RIGHT} : Entry{first, LEFT};
+				if(std::min(LEFT, RIGHT) <= closest.distance)	stack[stackSize++] = bLEFT_FIRST? Entry{first, LEFT} : Entry{first + 1, RIGHT};
+			}
+		}
+
+		if(!bFound) return std::nullopt;
+		closest.distance = std::sqrt(closest.distance);
+		return closest;
+	}
+
+	bool			MeshBVH::overlaps(					const AABB&			BOX,
+														std::vector<uint32_t>* output) const
+	{
+		const Vec3	BOX_MIN		= BOX.min();
+		const Vec3	BOX_MAX		= BOX.max();
+		const Vec3	HALF_SIZE	= BOX.extents();
+		bool		bOverlaps	= false;
+
+		traverse([&](const Vec3& MIN, const Vec3& MAX)
+		{
+			return !glm::any(glm::greaterThan(MIN, BOX_MAX)) && !glm::any(glm::lessThan(MAX, BOX_MIN));
+		},
+		[&](const uint32_t FIRST, const uint32_t COUNT)
+		{
+			for(uint32_t offset = 0; offset < COUNT; ++offset)
+			{
+				const uint32_t	TRIANGLE_ID	= m_triangles[FIRST + offset];
+				const auto		TRIANGLE	= get_triangle(TRIANGLE_ID);
+				if(triangle_overlaps_box(TRIANGLE[0] - BOX.center(), TRIANGLE[1] - BOX.center(), TRIANGLE[2] - BOX.center(), HALF_SIZE))
+				{
+					bOverlaps = true;
+					if(!output) return false;
+					output->push_back(TRIANGLE_ID);
+				}
+			}
+			return true;
+		});
+
+		return bOverlaps;
+	}
+
+	bool			MeshBVH::overlaps(					const Sphere&		SPHERE,
+														std::vector<uint32_t>* output) const
+	{
+		const Vec3&	CENTER		= SPHERE.center();
+		const float	RADIUS2		= SPHERE.radius() * SPHERE.radius();
+		bool		bOverlaps	= false;
+
+		traverse([&](const Vec3& MIN, const Vec3& MAX)
+		{
+			return point_box_distance2(CENTER, MIN, MAX) <= RADIUS2;
+		},
+		[&](const uint32_t FIRST, const uint32_t COUNT)
+		{
+			for(uint32_t offset = 0; offset < COUNT; ++offset)
+			{
+				const uint32_t	TRIANGLE_ID	= m_triangles[FIRST + offset];
+				const auto		TRIANGLE	= get_triangle(TRIANGLE_ID);
+				const Vec3		OFFSET		= closest_on_triangle(CENTER, TRIANGLE[0], TRIANGLE[1], TRIANGLE[2]) - CENTER;
+				if(glm::dot(OFFSET, OFFSET) < RADIUS2)
+				{
+					bOverlaps = true;
+					if(!output) return false;
+					output->push_back(TRIANGLE_ID);
+				}
+			}
+			return true;
+		});
+
+		return bOverlaps;
+	}
+
+	/*
+		Nodes are culled with the face axes of both boxes(conservative), triangles are tested in the local space of the OBB.
+	*/
+	bool			MeshBVH::overlaps(					const OBB&			BOX,
+														std::vector<uint32_t>* output) const
+	{
+		const Vec3	AXES[3]		= {BOX.front(), BOX.up(), BOX.right()};
+		const Vec3&	CENTER		= BOX.origin();
+		const Vec3	HALF_SIZE	= BOX.extents();
+		const Vec3	WORLD_HALF	= glm::abs(AXES[0]) * HALF_SIZE.x + glm::abs(AXES[1]) * HALF_SIZE.y + glm::abs(AXES[2]) * HALF_SIZE.z;
+		bool		bOverlaps	= false;
+
+		const auto TO_LOCAL = [&](const Vec3& POINT)
+		{
+			const Vec3 OFFSET = POINT - CENTER;
+			return Vec3(glm::dot(AXES[0], OFFSET), glm::dot(AXES[1], OFFSET), glm::dot(AXES[2], OFFSET));
+		};
+
+		traverse([&](const Vec3& MIN, const Vec3& MAX)
+		{
+			const Vec3 NODE_CENTER	= (MIN + MAX) * 0.5f;
+			const Vec3 NODE_HALF	= (MAX - MIN) * 0.5f;
+			const Vec3 OFFSET		= NODE_CENTER - CENTER;
+			if(glm::any(glm::greaterThan(glm::abs(OFFSET), WORLD_HALF + NODE_HALF))) return false;
+
+			for(uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if(std::abs(glm::dot(AXES[axis], OFFSET)) > HALF_SIZE[axis] + glm::dot(glm::abs(AXES[axis]), NODE_HALF)) return false;
+			}
+			return true;
+		},
+		[&](const uint32_t FIRST, const uint32_t COUNT)
+		{
+			for(uint32_t offset = 0; offset < COUNT; ++offset)
+			{
+				const uint32_t	TRIANGLE_ID	= m_triangles[FIRST + offset];
+				const auto		TRIANGLE	= get_triangle(TRIANGLE_ID);
+				if(triangle_overlaps_box(TO_LOCAL(TRIANGLE[0]), TO_LOCAL(TRIANGLE[1]), TO_LOCAL(TRIANGLE[2]), HALF_SIZE))
+				{
+					bOverlaps = true;
+					if(!output) return false;
+					output->push_back(TRIANGLE_ID);
+				}
+			}
+			return true;
+		});
+
+		return bOverlaps;
+	}
+
+//=====> MeshBVH private: // build
+	void			MeshBVH::build_node(				BuildData&			data,
+														const uint32_t		NODE_INDEX,
+														const uint32_t		BEGIN,
+														const uint32_t		END,
+														const uint32_t		DEPTH,
+														dpl::ThreadPool*	pool)
+	{
+		uint32_t nodeIndex	= NODE_INDEX;
+		uint32_t begin		= BEGIN;
+		uint32_t end		= END;
+		uint32_t depth		= DEPTH;
+
+		while(true) // Left child is built in the same call.
+		{
+			Node&	node		= m_nodes[nodeIndex];
+			Vec3	centroidMin	= Vec3(std::numeric_limits<float>::max());
+			Vec3	centroidMax	= Vec3(std::numeric_limits<float>::lowest());
+			node.min = centroidMin;
+			node.max = centroidMax;
+			for(uint32_t index = begin; index < end; ++index)
+			{
+				const uint32_t TRIANGLE_ID = m_triangles[index];
+				node.min	= glm::min(node.min, data.minima[TRIANGLE_ID]);
+				node.max	= glm::max(node.max, data.maxima[TRIANGLE_ID]);
+				centroidMin	= glm::min(centroidMin, data.centroids[TRIANGLE_ID]);
+				centroidMax	= glm::max(centroidMax, data.centroids[TRIANGLE_ID]);
+			}
+
+			const uint32_t COUNT = end - begin;
+			if(COUNT <= settings().maxLeafSize)
+			{
+				node.index = begin;
+				node.count = COUNT;
+				return;
+			}
+
+			// Find the best split plane among the bins of all axes.
+			const Vec3	EXTENT		= centroidMax - centroidMin;
+			const uint32_t NUM_BINS	= settings().numBins;
+			uint32_t	bestAxis	= 3;
+			uint32_t	bestSplit	= 0;
+			float		bestCost	= std::numeric_limits<float>::max();
+
+			for(uint32_t axis = 0; axis < 3 && depth < SAH_DEPTH; ++axis)
+			{
+				if(EXTENT[axis] <= 0.f) continue;
+
+				uint32_t	binCounts[MAX_BINS]	= {};
+				Vec3		binMin[MAX_BINS];
+				Vec3		binMax[MAX_BINS];
+				std::fill_n(binMin, NUM_BINS, Vec3(std::numeric_limits<float>::max()));
+				std::fill_n(binMax, NUM_BINS, Vec3(std::numeric_limits<float>::lowest()));
+
+				const float SCALE = NUM_BINS / EXTENT[axis];
+				for(uint32_t index = begin; index < end; ++index)
+				{
+					const uint32_t TRIANGLE_ID	= m_triangles[index];
+					const uint32_t BIN			= std::min(NUM_BINS - 1, static_cast<uint32_t>((data.centroids[TRIANGLE_ID][axis] - centroidMin[axis]) * SCALE));
+					++binCounts[BIN];
+					binMin[BIN] = glm::min(binMin[BIN], data.minima[TRIANGLE_ID]);
+					binMax[BIN] = glm::max(binMax[BIN], data.maxima[TRIANGLE_ID]);
+				}
+
+				// Sweep from the right to get the cost of the right sides.
+				float		rightCosts[MAX_BINS];
+				Vec3		sweepMin	= Vec3(std::numeric_limits<float>::max());
+				Vec3		sweepMax	= Vec3(std::numeric_limits<float>::lowest());
+				uint32_t	sweepCount	= 0;
+				for(uint32_t bin = NUM_BINS - 1; bin > 0; --bin)
+				{
+					sweepMin	= glm::min(sweepMin, binMin[bin]);
+					sweepMax	= glm::max(sweepMax, binMax[bin]);
+					sweepCount	+= binCounts[bin];
+					rightCosts[bin] = sweepCount? sweepCount * half_area(sweepMin, sweepMax) : 0.f;
+				}
+
+				sweepMin	= Vec3(std::numeric_limits<float>::max());
+				sweepMax	= Vec3(std::numeric_limits<float>::lowest());
+				sweepCount	= 0;
+				for(uint32_t split = 1; split < NUM_BINS; ++split)
+				{
+					sweepMin	= glm::min(sweepMin, binMin[split - 1]);
+					sweepMax	= glm::max(sweepMax, binMax[split - 1]);
+					sweepCount	+= binCounts[split - 1];
+					if(sweepCount == 0 || sweepCount == COUNT) continue;
+
+					const float COST = sweepCount * half_area(sweepMin, sweepMax) + rightCosts[split];
+					if(COST < bestCost)
+					{
+						bestCost	= COST;
+						bestAxis	= axis;
+						bestSplit	= split;
+					}
+				}
+			}
+
+			uint32_t middle;
+			if(bestAxis < 3)
+			{
+				const float SCALE = NUM_BINS / EXTENT[bestAxis];
+				middle = static_cast<uint32_t>(std::partition(m_triangles.begin() + begin, m_triangles.begin() + end, [&](const uint32_t TRIANGLE_ID)
+				{
+					return std::min(NUM_BINS - 1, static_cast<uint32_t>((data.centroids[TRIANGLE_ID][bestAxis] - centroidMin[bestAxis]) * SCALE)) < bestSplit;
+				}) - m_triangles.begin());
+			}
+			else // Too deep or all centroids overlap: split at the median of the longest axis.
+			{
+				const uint32_t AXIS = (EXTENT.x >= EXTENT.y && EXTENT.x >= EXTENT.z)? 0 : (EXTENT.y >= EXTENT.z)? 1 : 2;
+				middle = begin + COUNT / 2;
+				std::nth_element(m_triangles.begin() + begin, m_triangles.begin() + middle, m_triangles.begin() + end, [&](const uint32_t A, const uint32_t B)
+				{
+					return data.centroids[A][AXIS] < data.centroids[B][AXIS];
+				});
+			}
+
+			const uint32_t LEFT = m_numNodes.fetch_add(2);
+			node.index = LEFT;
+			node.count = 0;
+
+			const uint32_t RIGHT_BEGIN = middle;
+			const uint32_t RIGHT_END = end;
+			if(pool && (RIGHT_END - RIGHT_BEGIN) >= PARALLEL_BUILD_THRESHOLD)
+			{
+				pool->add_task([this, &data, LEFT, RIGHT_BEGIN, RIGHT_END, depth, pool]()
+				{
+					build_node(data, LEFT + 1, RIGHT_BEGIN, RIGHT_END, depth + 1, pool);
+				});
+			}
+			else
+			{
+				build_node(data, LEFT + 1, RIGHT_BEGIN, RIGHT_END, depth + 1, nullptr);
+			}
+
+			nodeIndex	= LEFT;
+			end			= middle;
+			++depth;
+		}
+	}
+
+	void			MeshBVH::quantize()
+	{
+		const Node&	ROOT	= m_nodes[0];
+		m_gridOrigin		= ROOT.min;
+		m_gridScale			= (ROOT.max - ROOT.min) / float(GRID_SIZE - 1); // One step of slack for the rounding.
+		for(uint32_t axis = 0; axis < 3; ++axis)
+		{
+			if(m_gridScale[axis] <= 0.f) m_gridScale[axis] = 1.f;
+		}
+
+		m_quantizedNodes.resize(m_nodes.size());
+		for(uint32_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex)
+		{
+			const Node&		NODE		= m_nodes[nodeIndex];
+			QuantizedNode&	quantized	= m_quantizedNodes[nodeIndex];
+
+			if(NODE.index >= (1u << 27))
+				throw dpl::GeneralException(this, __LINE__, "Mesh is too large for quantized nodes.");
+
+			quantized.data = (NODE.count > 0)? (1u << 31) | (NODE.index << 4) | (NODE.count - 1) : (NODE.index << 4);
+
+			for(uint32_t axis = 0; axis < 3; ++axis)
+			{
+				const float ORIGIN	= m_gridOrigin[axis];
+				const float SCALE	= m_gridScale[axis];
+				int64_t		low		= static_cast<int64_t>(std::floor((NODE.min[axis] - ORIGIN) / SCALE));
+				int64_t		high	= static_cast<int64_t>(std::ceil((NODE.max[axis] - ORIGIN) / SCALE));
+				low		= std::clamp<int64_t>(low, 0, GRID_SIZE);
+				high	= std::clamp<int64_t>(high, 0, GRID_SIZE);
+				while(low > 0			&& ORIGIN + low * SCALE > NODE.min[axis])	--low;
+				while(high < GRID_SIZE	&& ORIGIN + high * SCALE < NODE.max[axis])	++high;
+				quantized.min[axis] = static_cast<uint16_t>(low);
+				quantized.max[axis] = static_cast<uint16_t>(high);
+			}
+		}
+
+		std::vector<Node>().swap(m_nodes);
+	}
+
+//=====> MeshBVH private: // traversal
+	inline bool		MeshBVH::is_leaf(					const uint32_t		NODE_INDEX,
+														uint32_t&			first,
+														uint32_t&			count) const
+	{
+		if(settings().bQuantized)
+		{
+			const uint32_t DATA = m_quantizedNodes[NODE_INDEX].data;
+			first = (DATA >> 4) & ((1u << 27) - 1);
+			count = (DATA >> 31)? (DATA & 15) + 1 : 0;
+		}
+		else
+		{
+			first = m_nodes[NODE_INDEX].index;
+			count = m_nodes[NODE_INDEX].count;
+		}
+		return count > 0;
+	}
+
+	inline void		MeshBVH::get_bounds(				const uint32_t		NODE_INDEX,
+														Vec3&				min,
+														Vec3&				max) const
+	{
+		if(settings().bQuantized)
+		{
+			const QuantizedNode& NODE = m_quantizedNodes[NODE_INDEX];
+			min = m_gridOrigin + Vec3(NODE.min[0], NODE.min[1], NODE.min[2]) * m_gridScale;
+			max = m_gridOrigin + Vec3(NODE.max[0], NODE.max[1], NODE.max[2]) * m_gridScale;
+		}
+		else
+		{
+			min = m_nodes[NODE_INDEX].min;
+			max = m_nodes[NODE_INDEX].max;
+		}
+	}
+
+	template<typename VisitT, typename LeafT>
+	void			MeshBVH::traverse(					VisitT&&			visit,
+														LeafT&&				leaf) const
+	{
+		if(empty()) return;
+
+		uint32_t stack[2 * MAX_DEPTH];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		Vec3 min, max;
+		while(stackSize > 0)
+		{
+			const uint32_t NODE_INDEX = stack[--stackSize];
+			get_bounds(NODE_INDEX, min, max);
+			if(!visit(min, max)) continue;
+
+			uint32_t first, count;
+			if(is_leaf(NODE_INDEX, first, count))
+			{
+				if(!leaf(first, count)) return;
+			}
+			else
+			{
+				stack[stackSize++] = first + 1;
+				stack[stackSize++] = first;
+			}
+		}
+	}
+
+	std::array<Vec3, 3>	MeshBVH::get_triangle(			const uint32_t		TRIANGLE_ID) const
+	{
+		const auto& VERTICES	= m_mesh->vertices();
+		const auto& INDICES		= m_mesh->indices();
+		const uint32_t OFFSET	= TRIANGLE_ID * 3;
+		return {VERTICES[INDICES[OFFSET]], VERTICES[INDICES[OFFSET + 1]], VERTICES[INDICES[OFFSET + 2]]};
+	}
+}
\ No newline at end of file
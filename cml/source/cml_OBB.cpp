@@ -38,7 +38,7 @@ namespace cml
 	{
 		Vec3 scale;
 		CoordinateSystem::reset(TRANSFORMATION, scale);
-		CoordinateSystem::move_origin(aabb.center());
+		CoordinateSystem::set_origin(Vec3(TRANSFORMATION * Vec4(aabb.center(), 1.f)));
 		Cuboid::scale(scale);
 	}
 
@@ -54,7 +54,7 @@ namespace cml
 	{
 		Vec3 scale;
 		CoordinateSystem::reset(TRANSFORMATION, scale);
-		CoordinateSystem::move_origin(aabb.center());
+		CoordinateSystem::set_origin(Vec3(TRANSFORMATION * Vec4(aabb.center(), 1.f)));
 		Cuboid::set_extents(aabb.halfWidth() * scale.x,
 							aabb.halfHeight() * scale.y,
 							aabb.halfDepth() * scale.z);
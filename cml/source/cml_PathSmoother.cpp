@@ -0,0 +1,296 @@
+#include "../include/cml_PathSmoother.h"
+#include <dpl_ThreadPool.h>
+#include <dpl_GeneralException.h>
+
+
+namespace cml
+{
+	namespace
+	{
+		const float MAX_TANGENT_SINUS = 0.99f; // Portal narrower than the agent would give circles overlapping the apex.
+
+		/*
+			Positive tilt rotates funnel side to the left.
+			Agent passes left vertices on its right side and right vertices on its left side,
+			so the tilt between two circles is vertex_tilt(APEX) - vertex_tilt(VERTEX)
+			(outer tangent between two left or two right vertices is parallel to the line connecting them).
+		*/
+		inline float				vertex_tilt(		const Side			SIDE,
+														const float			RADIUS)
+		{
+			switch(SIDE)
+			{
+			case Side::eLEFT:	return RADIUS;
+			case Side::eRIGHT:	return -RADIUS;
+			default:			return 0.f;
+			}
+		}
+
+		/*
+			Direction of the line tangent to the circle around the apex and the circle around the vertex.
+		*/
+		inline Vec2					tangent_vector(		const Vec2&			TO_VERTEX,
+														const float			TILT)
+		{
+			const float DISTANCE = calculate_length(TO_VERTEX);
+			if(TILT == 0.f || DISTANCE == 0.f)
+				return TO_VERTEX;
+
+			const float RADIUS = glm::min(glm::abs(TILT), DISTANCE * MAX_TANGENT_SINUS);
+			return calculate_tangent(TO_VERTEX / DISTANCE, DISTANCE, RADIUS, (TILT > 0.f)? Side::eLEFT : Side::eRIGHT);
+		}
+
+		/*
+			Same as Funnel::check_vector, but sides that were not set yet do not limit the funnel.
+		*/
+		inline Funnel::Operation	check_vector(		const Funnel&		FUNNEL,
+														const bool			bLEFT,
+														const bool			bRIGHT,
+														const Vec2&			VECTOR,
+														const Side			SIDE)
+		{
+			if(bLEFT && bRIGHT)
+				return FUNNEL.check_vector(VECTOR, SIDE);
+
+			if(SIDE == Side::eRIGHT)
+			{
+				if(bRIGHT)	return left_side(FUNNEL.toRight(), VECTOR)? Funnel::Operation::TIGHTEN : Funnel::Operation::WIDTHEN;
+				if(bLEFT)	return right_side(FUNNEL.toLeft(), VECTOR)? Funnel::Operation::TIGHTEN : Funnel::Operation::TWISTED;
+			}
+			else
+			{
+				if(bLEFT)	return right_side(FUNNEL.toLeft(), VECTOR)? Funnel::Operation::TIGHTEN : Funnel::Operation::WIDTHEN;
+				if(bRIGHT)	return left_side(FUNNEL.toRight(), VECTOR)? Funnel::Operation::TIGHTEN : Funnel::Operation::TWISTED;
+			}
+
+			return Funnel::Operation::TIGHTEN;
+		}
+
+		inline Vec2					get_vertex(			const PathSmoother::Query&	QUERY,
+														const PathSmoother::Corner&	CORNER)
+		{
+			switch(CORNER.side)
+			{
+			case Side::eLEFT:	return QUERY.portals[CORNER.portal].left;
+			case Side::eRIGHT:	return QUERY.portals[CORNER.portal].right;
+			default:			return CORNER.point;
+			}
+		}
+
+		/*
+			Moves vertex by the radius away from the wall, along the bisector of the incoming and outgoing direction.
+		*/
+		inline Vec2					offset_vertex(		const Vec2&			PREVIOUS,
+														const Vec2&			VERTEX,
+														const Vec2&			NEXT,
+														const Side			SIDE,
+														const float			RADIUS)
+		{
+			const Vec2	IN			= VERTEX - PREVIOUS;
+			const Vec2	OUT			= NEXT - VERTEX;
+			const float IN_LENGTH	= calculate_length(IN);
+			const float OUT_LENGTH	= calculate_length(OUT);
+
+			Vec2 normal(0.f, 0.f);
+			if(IN_LENGTH > 0.f)		normal += calculate_side_vector(inverse(SIDE), IN / IN_LENGTH);
+			if(OUT_LENGTH > 0.f)	normal += calculate_side_vector(inverse(SIDE), OUT / OUT_LENGTH);
+
+			const float NORMAL_LENGTH = calculate_length(normal);
+			return (NORMAL_LENGTH > 0.f)? VERTEX + normal * (RADIUS / NORMAL_LENGTH) : VERTEX;
+		}
+	}
+
+
+
+//=====> PathSmoother public: // functions
+	void						PathSmoother::smooth(			const Query*		QUERIES,
+																const uint32_t		NUM_QUERIES,
+																dpl::ThreadPool*	pool)
+	{
+		m_previousPaths.swap(*paths);
+		m_previousCorners.swap(*corners);
+
+		uint32_t numCorners = 0;
+		paths->resize(NUM_QUERIES);
+		for(uint32_t queryID = 0; queryID < NUM_QUERIES; ++queryID)
+		{
+			(*paths)[queryID].firstCorner = numCorners;
+			numCorners += QUERIES[queryID].numPortals + 2;
+		}
+		corners->resize(numCorners);
+
+		const auto SMOOTH_CHUNK = [&](const uint32_t BEGIN, const uint32_t END)
+		{
+			for(uint32_t queryID = BEGIN; queryID < END; ++queryID)
+			{
+				Path& path = (*paths)[queryID];
+				const uint32_t FIRST_CORNER = path.firstCorner;
+				path				= smooth_path(QUERIES[queryID], corners->data() + FIRST_CORNER);
+				path.firstCorner	= FIRST_CORNER;
+			}
+		};
+
+		if(!pool || NUM_QUERIES <= QUERY_CHUNK_SIZE)
+			return SMOOTH_CHUNK(0, NUM_QUERIES);
+
+		for(uint32_t begin = 0; begin < NUM_QUERIES; begin += QUERY_CHUNK_SIZE)
+		{
+			const uint32_t END = std::min(begin + QUERY_CHUNK_SIZE, NUM_QUERIES);
+			pool->add_task([=](){ SMOOTH_CHUNK(begin, END); });
+		}
+		pool->wait();
+	}
+
+	void						PathSmoother::clear()
+	{
+		paths->clear();
+		corners->clear();
+		m_previousPaths.clear();
+		m_previousCorners.clear();
+	}
+
+//=====> PathSmoother private: // functions
+	PathSmoother::Path			PathSmoother::smooth_path(		const Query&		QUERY,
+																Corner*				output) const
+	{
+		const Path*		PREVIOUS	= find_previous(QUERY);
+		const float		RADIUS		= QUERY.radius;
+		Path			path		= {0, 0, QUERY.numPortals, 0};
+
+		output[path.numCorners++] = {QUERY.start, INVALID_INDEX, Side::eNONE};
+
+		Vec2		apex		= QUERY.start;
+		Side		apexSide	= Side::eNONE;
+		uint32_t	begin		= 0;
+		uint32_t	numSmoothed	= 0; // Corners that need the radius offset.
+		for(;;)
+		{
+			Funnel		funnel;
+			bool		bLeft		= false;
+			bool		bRight		= false;
+			uint32_t	leftPortal	= 0;
+			uint32_t	rightPortal	= 0;
+			Corner		corner		= {QUERY.goal, INVALID_INDEX, Side::eNONE};
+
+			for(uint32_t portalID = begin; portalID < QUERY.numPortals; ++portalID)
+			{
+				const Portal& PORTAL = QUERY.portals[portalID];
+				if(PORTAL.right != apex)
+				{
+					const Vec2 TO_RIGHT = tangent_vector(PORTAL.right - apex, vertex_tilt(apexSide, RADIUS) - vertex_tilt(Side::eRIGHT, RADIUS));
+					const auto OPERATION = check_vector(funnel, bLeft, bRight, TO_RIGHT, Side::eRIGHT);
+					if(OPERATION == Funnel::Operation::TWISTED)
+					{
+						corner = {QUERY.portals[leftPortal].left, leftPortal, Side::eLEFT};
+						break;
+					}
+					else if(OPERATION == Funnel::Operation::TIGHTEN)
+					{
+						funnel.set_right_vector(TO_RIGHT);
+						bRight		= true;
+						rightPortal	= portalID;
+					}
+				}
+
+				if(PORTAL.left != apex)
+				{
+					const Vec2 TO_LEFT = tangent_vector(PORTAL.left - apex, vertex_tilt(apexSide, RADIUS) - vertex_tilt(Side::eLEFT, RADIUS));
+					const auto OPERATION = check_vector(funnel, bLeft, bRight, TO_LEFT, Side::eLEFT);
+					if(OPERATION == Funnel::Operation::TWISTED)
+					{
+						corner = {QUERY.portals[rightPortal].right, rightPortal, Side::eRIGHT};
+						break;
+					}
+					else if(OPERATION == Funnel::Operation::TIGHTEN)
+					{
+						funnel.set_left_vector(TO_LEFT);
+						bLeft		= true;
+						leftPortal	= portalID;
+					}
+				}
+			}
+
+			if(corner.side == Side::eNONE)
+			{
+				const Vec2 TO_GOAL = tangent_vector(QUERY.goal - apex, vertex_tilt(apexSide, RADIUS));
+				if(bRight && right_side(funnel.toRight(), TO_GOAL))
+				{
+					corner = {QUERY.portals[rightPortal].right, rightPortal, Side::eRIGHT};
+				}
+				else if(bLeft && left_side(funnel.toLeft(), TO_GOAL))
+				{
+					corner = {QUERY.portals[leftPortal].left, leftPortal, Side::eLEFT};
+				}
+				else
+				{
+					output[path.numCorners++] = corner;
+					numSmoothed = path.numCorners;
+					break;
+				}
+			}
+
+			output[path.numCorners++] = corner;
+			apex		= corner.point;
+			apexSide	= corner.side;
+			begin		= corner.portal + 1;
+
+			// Funnel restarted at the vertex of the unchanged portal gives the same corners as before.
+			if(PREVIOUS && corner.portal >= QUERY.numChangedPortals)
+			{
+				const uint32_t	OLD_PORTAL	= corner.portal + PREVIOUS->numPortals - QUERY.numPortals;
+				const Corner*	OLD_CORNERS	= m_previousCorners.data() + PREVIOUS->firstCorner;
+				uint32_t		oldID		= 1;
+
+				while(oldID + 1 < PREVIOUS->numCorners && OLD_CORNERS[oldID].portal < OLD_PORTAL) ++oldID;
+				if(oldID + 1 < PREVIOUS->numCorners && OLD_CORNERS[oldID].portal == OLD_PORTAL && OLD_CORNERS[oldID].side == corner.side)
+				{
+					numSmoothed = path.numCorners;
+					for(++oldID; oldID < PREVIOUS->numCorners; ++oldID, ++path.numReused)
+					{
+						Corner reused = OLD_CORNERS[oldID];
+						if(reused.side != Side::eNONE) reused.portal = reused.portal + QUERY.numPortals - PREVIOUS->numPortals;
+						output[path.numCorners++] = reused;
+					}
+					break;
+				}
+			}
+		}
+
+		if(RADIUS > 0.f)
+		{
+			for(uint32_t cornerID = 1; cornerID < numSmoothed; ++cornerID)
+			{
+				Corner& corner = output[cornerID];
+				if(corner.side == Side::eNONE) continue;
+
+				corner.point = offset_vertex(	get_vertex(QUERY, output[cornerID - 1]),
+												get_vertex(QUERY, corner),
+												get_vertex(QUERY, output[cornerID + 1]),
+												corner.side,
+												RADIUS);
+			}
+		}
+
+		return path;
+	}
+
+	const PathSmoother::Path*	PathSmoother::find_previous(	const Query&		QUERY) const
+	{
+		if(QUERY.previousPath == INVALID_INDEX)
+			return nullptr;
+
+#ifdef _DEBUG
+		if(QUERY.previousPath >= m_previousPaths.size())
+			throw dpl::GeneralException(this, __LINE__, "Invalid previous path: " + std::to_string(QUERY.previousPath));
+
+		if(QUERY.numChangedPortals > QUERY.numPortals)
+			throw dpl::GeneralException(this, __LINE__, "Number of changed portals exceeds number of portals.");
+#endif // _DEBUG
+
+		const Path& PREVIOUS = m_previousPaths[QUERY.previousPath];
+		if(PREVIOUS.numPortals < QUERY.numPortals - QUERY.numChangedPortals)
+			return nullptr;
+
+		return &PREVIOUS;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "..//include/cml_Tests.h"
+#include "..//include/cml_TriangleMesh.h"
+#include "..//include/cml_Batch.h"
+#include "..//include/cml_AABB.h"
+#include "..//include/cml_OBB.h"
+#include "..//include/cml_Sphere.h"
+#include "..//include/cml_Plane.h"
+#include "..//include/cml_Ray.h"
+#include "..//include/cml_ConvexHull.h"
+#include <dpl_ThreadPool.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+
+
+namespace cml
+{
+	namespace
+	{
+		TriangleMesh	create_terrain(			const uint32_t							GRID_SIZE,
+												std::mt19937&							rng)
+		{
+			std::uniform_real_distribution<float> height(-0.5f, 0.5f);
+
+			TriangleMesh mesh;
+			mesh.reserve_vertices(GRID_SIZE * GRID_SIZE);
+			mesh.reserve_indices((GRID_SIZE - 1) * (GRID_SIZE - 1) * 6);
+
+			for(uint32_t y = 0; y < GRID_SIZE; ++y)
+			{
+				for(uint32_t x = 0; x < GRID_SIZE; ++x)
+				{
+					mesh.add_vertex(Vec3(static_cast<float>(x), height(rng), static_cast<float>(y)));
+				}
+			}
+
+			for(uint32_t y = 0; y + 1 < GRID_SIZE; ++y)
+			{
+				for(uint32_t x = 0; x + 1 < GRID_SIZE; ++x)
+				{
+					const uint32_t A = y * GRID_SIZE + x;
+					const uint32_t B = A + 1;
+					const uint32_t C = A + GRID_SIZE;
+					const uint32_t D = C + 1;
+					mesh.add_index(A); mesh.add_index(C); mesh.add_index(B);
+					mesh.add_index(B); mesh.add_index(C); mesh.add_index(D);
+				}
+			}
+
+			return mesh;
+		}
+
+		/*
+			Same surface with shuffled triangles and vertices(like meshes merged from many sources).
+		*/
+		TriangleMesh	shuffle_mesh(			const TriangleMesh&						MESH,
+												std::mt19937&							rng)
+		{
+			std::vector<uint32_t> vertexOrder(MESH.get_numVertices());
+			std::iota(vertexOrder.begin(), vertexOrder.end(), 0);
+			std::shuffle(vertexOrder.begin(), vertexOrder.end(), rng);
+
+			std::vector<uint32_t> newIndex(vertexOrder.size());
+			for(uint32_t index = 0; index < vertexOrder.size(); ++index)
+			{
+				newIndex[vertexOrder[index]] = index;
+			}
+
+			std::vector<uint32_t> triangleOrder(MESH.get_numIndices() / 3);
+			std::iota(triangleOrder.begin(), triangleOrder.end(), 0);
+			std::shuffle(triangleOrder.begin(), triangleOrder.end(), rng);
+
+			TriangleMesh result;
+			for(const uint32_t OLD_INDEX : vertexOrder)
+			{
+				result.add_vertex(MESH.vertices()[OLD_INDEX]);
+			}
+
+			for(const uint32_t TRIANGLE_ID : triangleOrder)
+			{
+				for(uint32_t corner = 0; corner < 3; ++corner)
+				{
+					result.add_index(newIndex[MESH.indices()[TRIANGLE_ID * 3 + corner]]);
+				}
+			}
+
+			return result;
+		}
+
+		double			measure_normals(		const TriangleMesh&						MESH,
+												const TriangleMesh::NormalWeighting		WEIGHTING,
+												dpl::ThreadPool*						pool,
+												const uint64_t							NUM_TESTS,
+												TriangleMesh::Normals&					normals)
+		{
+			normals.resize(MESH.get_numVertices());
+			double timeTotal = 0.0;
+			for(uint64_t testID = 0; testID < NUM_TESTS; ++testID)
+			{
+				auto start	= std::chrono::steady_clock::now();
+				MESH.generate_normals(normals.data(), WEIGHTING, pool);
+				auto end	= std::chrono::steady_clock::now();
+				timeTotal	+= std::chrono::duration<double, std::milli>(end - start).count();
+			}
+			return timeTotal / NUM_TESTS;
+		}
+
+		float			max_difference(			const TriangleMesh::Normals&			FIRST,
+												const TriangleMesh::Normals&			SECOND)
+		{
+			float result = 0.f;
+			for(size_t index = 0; index < FIRST.size(); ++index)
+			{
+				result = std::max(result, glm::length(FIRST[index] - SECOND[index]));
+			}
+			return result;
+		}
+
+		/*
+			Returns number of objects for which the bit of the mask differs from the scalar test.
+		*/
+		template<typename ObjectT, typename TestT>
+		uint64_t		count_mismatches(		const std::vector<ObjectT>&				OBJECTS,
+												const BatchMask&						MASK,
+												TestT&&									scalarTest)
+		{
+			uint64_t numMismatches = 0;
+			for(uint32_t index = 0; index < OBJECTS.size(); ++index)
+			{
+				if(MASK.at(index) != scalarTest(OBJECTS[index])) ++numMismatches;
+			}
+			return numMismatches;
+		}
+
+		Vec3			random_direction(		std::mt19937&							rng)
+		{
+			std::uniform_real_distribution<float> coordinate(-1.f, 1.f);
+			return glm::normalize(Vec3(coordinate(rng), coordinate(rng), coordinate(rng)) + Vec3(1e-3f));
+		}
+	}
+
+	void test_normals_scaling(	const uint32_t		GRID_SIZE,
+								const uint64_t		NUM_TESTS)
+	{
+		std::mt19937		rng(7);
+		const TriangleMesh	TERRAIN		= create_terrain(GRID_SIZE, rng);
+		const TriangleMesh	SHUFFLED	= shuffle_mesh(TERRAIN, rng);
+		const uint32_t		MAX_WORKERS	= std::max(1u, std::thread::hardware_concurrency());
+
+		const std::pair<const char*, TriangleMesh::NormalWeighting> WEIGHTINGS[] =
+		{
+			{"uniform",	TriangleMesh::NormalWeighting::UNIFORM},
+			{"area",	TriangleMesh::NormalWeighting::AREA},
+			{"angle",	TriangleMesh::NormalWeighting::ANGLE}
+		};
+
+		const std::pair<const char*, const TriangleMesh*> MESHES[] =
+		{
+			{"coherent",	&TERRAIN},
+			{"incoherent",	&SHUFFLED}
+		};
+
+		std::cout << "triangles: " << TERRAIN.get_numIndices() / 3 << std::endl;
+
+		for(const auto& MESH : MESHES)
+		{
+			for(const auto& WEIGHTING : WEIGHTINGS)
+			{
+				TriangleMesh::Normals serial;
+				TriangleMesh::Normals parallel;
+
+				const double SERIAL_TIME = measure_normals(*MESH.second, WEIGHTING.second, nullptr, NUM_TESTS, serial);
+				std::cout << MESH.first << " " << WEIGHTING.first << std::endl;
+				std::cout << "serial:       " << SERIAL_TIME << "ms" << std::endl;
+
+				for(uint32_t numWorkers = 2; numWorkers <= MAX_WORKERS; numWorkers *= 2)
+				{
+					dpl::ThreadPool		threadPool(numWorkers);
+					const double		TIME = measure_normals(*MESH.second, WEIGHTING.second, &threadPool, NUM_TESTS, parallel);
+					std::cout << "workers[" << numWorkers << "]:   " << TIME << "ms (x" << SERIAL_TIME / TIME << "), max diff: " << max_difference(serial, parallel) << std::endl;
+				}
+			}
+		}
+	}
+
+	uint64_t test_batch_equivalence(	const uint32_t		NUM_OBJECTS,
+										const uint32_t		NUM_TESTS)
+	{
+		std::mt19937							rng(7);
+		std::uniform_real_distribution<float>	position(-10.f, 10.f);
+		std::uniform_real_distribution<float>	size(0.f, 3.f);
+
+		std::vector<AABB>	boxes;
+		std::vector<Sphere>	spheres;
+		for(uint32_t objectID = 0; objectID < NUM_OBJECTS; ++objectID)
+		{
+			AABB box(Vec3(position(rng), position(rng), position(rng)));
+			if(objectID % 97 != 0) box.set_extents(size(rng), size(rng), size(rng)); //<-- Some boxes are points.
+			boxes.push_back(box);
+			spheres.emplace_back(Vec3(position(rng), position(rng), position(rng)), size(rng));
+		}
+
+		const AABBPacket	BOX_PACKET(boxes.data(), NUM_OBJECTS);
+		const SpherePacket	SPHERE_PACKET(spheres.data(), NUM_OBJECTS);
+		BatchMask			mask;
+
+		enum Kernel
+		{
+			AABB_ABOVE, AABB_PLANE, AABB_HULL, AABB_RAY,
+			SPHERE_ABOVE, SPHERE_BELOW, SPHERE_PLANE, SPHERE_HULL, SPHERE_RAY,
+			MASK_BITS, NUM_KERNELS
+		};
+
+		const char* KERNEL_NAMES[NUM_KERNELS] =
+		{
+			"AABB above plane", "AABB plane", "AABB hull", "AABB ray",
+			"sphere above plane", "sphere below plane", "sphere plane", "sphere hull", "sphere ray",
+			"mask bits"
+		};
+
+		uint64_t numMismatches[NUM_KERNELS] = {};
+
+		for(uint32_t testID = 0; testID < NUM_TESTS; ++testID)
+		{
+			const Vec3	NORMAL = (testID % 10 == 0)? Vec3(0.f, 1.f, 0.f) : random_direction(rng);
+			const Plane	PLANE(NORMAL, position(rng));
+
+			BOX_PACKET.above(PLANE, mask);
+			numMismatches[AABB_ABOVE]	+= count_mismatches(boxes, mask, [&](const AABB& BOX){ return BOX.above(PLANE); });
+			BOX_PACKET.intersects(PLANE, mask);
+			numMismatches[AABB_PLANE]	+= count_mismatches(boxes, mask, [&](const AABB& BOX){ return BOX.intersects(PLANE); });
+			SPHERE_PACKET.above(PLANE, mask);
+			numMismatches[SPHERE_ABOVE]	+= count_mismatches(spheres, mask, [&](const Sphere& SPHERE){ return SPHERE.above(PLANE); });
+			SPHERE_PACKET.below(PLANE, mask);
+			numMismatches[SPHERE_BELOW]	+= count_mismatches(spheres, mask, [&](const Sphere& SPHERE){ return SPHERE.below(PLANE); });
+			SPHERE_PACKET.intersects(PLANE, mask);
+			numMismatches[SPHERE_PLANE]	+= count_mismatches(spheres, mask, [&](const Sphere& SPHERE){ return SPHERE.intersects(PLANE); });
+
+			std::vector<Plane> faces;
+			for(uint32_t faceID = 0; faceID < 6; ++faceID)
+			{
+				faces.emplace_back(random_direction(rng), size(rng) * 3.f);
+			}
+
+			const ConvexHull HULL(faces);
+			BOX_PACKET.intersects(HULL, mask);
+			numMismatches[AABB_HULL]	+= count_mismatches(boxes, mask, [&](const AABB& BOX){ return BOX.intersects(HULL); });
+			SPHERE_PACKET.intersects(HULL, mask);
+			numMismatches[SPHERE_HULL]	+= count_mismatches(spheres, mask, [&](const Sphere& SPHERE){ return SPHERE.intersects(HULL); });
+
+			Vec3 direction = random_direction(rng);
+			if(testID % 7 == 0)		direction = glm::normalize(Vec3(0.f, direction.y, direction.z)); //<-- Ray parallel to the slab.
+			if(testID % 11 == 0)	direction = Vec3(0.f, 0.f, 1.f);
+
+			const Ray RAY(Vec3(position(rng), position(rng), position(rng)), direction);
+			BOX_PACKET.intersects(RAY, mask);
+			numMismatches[AABB_RAY]		+= count_mismatches(boxes, mask, [&](const AABB& BOX){ return BOX.intersects(RAY); });
+			SPHERE_PACKET.intersects(RAY, mask);
+			numMismatches[SPHERE_RAY]	+= count_mismatches(spheres, mask, [&](const Sphere& SPHERE){ return SPHERE.intersects(RAY); });
+
+			uint32_t numSet = 0;
+			mask.for_each_set([&](const uint32_t INDEX)
+			{
+				if(!mask.at(INDEX) || INDEX >= NUM_OBJECTS) ++numMismatches[MASK_BITS];
+				++numSet;
+			});
+			if(numSet != mask.count()) ++numMismatches[MASK_BITS];
+		}
+
+		// Signed distance of the center must not subtract the plane distance from each coordinate.
+		AABB box(Vec3(3.f, 0.f, 0.f));
+		box.set_extents(0.1f, 0.1f, 0.1f);
+		const Plane DIAGONAL(glm::normalize(Vec3(1.f, 1.f, 0.f)), 1.8f);
+		const Plane FLIPPED(-DIAGONAL.normal(), 1.8f);
+		const uint64_t NUM_SIGN_ERRORS = (box.above(DIAGONAL)? 0 : 1) + (box.below(FLIPPED)? 0 : 1);
+
+		uint64_t numTotal = NUM_SIGN_ERRORS;
+		for(uint32_t kernelID = 0; kernelID < NUM_KERNELS; ++kernelID)
+		{
+			std::cout << KERNEL_NAMES[kernelID] << ": " << numMismatches[kernelID] << " mismatches" << std::endl;
+			numTotal += numMismatches[kernelID];
+		}
+		std::cout << "AABB above/below sign: " << NUM_SIGN_ERRORS << " errors" << std::endl;
+
+		// Transformed bounds use a different order of operations, so only the largest difference is reported.
+		std::vector<Mat4> transformations;
+		for(uint32_t objectID = 0; objectID < NUM_OBJECTS; ++objectID)
+		{
+			Mat4 transformation = glm::translate(Mat4(1.f), Vec3(position(rng), position(rng), position(rng)));
+			transformation = glm::rotate(transformation, position(rng), random_direction(rng));
+			transformations.push_back(glm::scale(transformation, Vec3(0.1f) + Vec3(size(rng), size(rng), size(rng))));
+		}
+
+		std::vector<AABB>	worldBoxes(NUM_OBJECTS);
+		std::vector<OBB>	worldOBBs(NUM_OBJECTS);
+		transform_bounds(boxes.data(), transformations.data(), NUM_OBJECTS, worldBoxes.data());
+		transform_bounds(boxes.data(), transformations.data(), NUM_OBJECTS, worldOBBs.data());
+		const AABBPacket WORLD_PACKET(boxes.data(), transformations.data(), NUM_OBJECTS);
+
+		float maxBoxDifference = 0.f;
+		float maxOBBDifference = 0.f;
+		for(uint32_t objectID = 0; objectID < NUM_OBJECTS; ++objectID)
+		{
+			const OBB	SCALAR_OBB	= boxes[objectID] * transformations[objectID];
+			const AABB	SCALAR_BOX	= AABB(SCALAR_OBB);
+			const AABB	PACKED_BOX	= WORLD_PACKET.get(objectID);
+			const OBB&	BATCH_OBB	= worldOBBs[objectID];
+
+			maxBoxDifference = std::max(maxBoxDifference, glm::length(worldBoxes[objectID].center() - SCALAR_BOX.center()) + glm::length(worldBoxes[objectID].extents() - SCALAR_BOX.extents()));
+			maxBoxDifference = std::max(maxBoxDifference, glm::length(PACKED_BOX.center() - SCALAR_BOX.center()) + glm::length(PACKED_BOX.extents() - SCALAR_BOX.extents()));
+			maxOBBDifference = std::max(maxOBBDifference, glm::length(BATCH_OBB.origin() - SCALAR_OBB.origin()) + glm::length(BATCH_OBB.extents() - SCALAR_OBB.extents())
+															+ glm::length(BATCH_OBB.front() - SCALAR_OBB.front()) + glm::length(BATCH_OBB.up() - SCALAR_OBB.up()) + glm::length(BATCH_OBB.right() - SCALAR_OBB.right()));
+		}
+
+		std::cout << "transform_bounds max diff(AABB): " << maxBoxDifference << std::endl;
+		std::cout << "transform_bounds max diff(OBB): " << maxOBBDifference << std::endl;
+		return numTotal;
+	}
+}
\ No newline at end of file
@@ -1,1054 +1,1305 @@
 #include "..//include/cml_TriangleMesh.h"
-#include <set>
-#include <map>
-#include <unordered_map>
 #include <array>
-#include <memory>
+#include <bit>
+#include <limits>
+#include <algorithm>
 #include <dpl_GeneralException.h>
+#include <dpl_ThreadPool.h>
 #include <poly2tri/poly2tri.h>
+#include "../include/cml_Lanes.h"
 
 #pragma warning (disable: 26451)
 
 namespace cml
 {
-	using	Contour			= std::vector<uint32_t>;
-	using	ContourArray	= std::vector<Contour>;
-
-	uint32_t			estimate_numTriangles(	const Contour&						BORDER,
-												const ContourArray&					HOLES)
+	namespace Triangulation
 	{
-		/*
-			NUM_TRIANGLES = N-2 + M*2 - T
-			N - ilos wierzchokw w poligonie
-			M - ilo wierzchokw w dziurach
-			T - ilo trjktw w dziurach
-		*/
-			
-		const uint32_t NUM_BASE_VERTICES	= static_cast<uint32_t>(BORDER.size());
-		const uint32_t NUM_BASE_TRIANGLES	= NUM_BASE_VERTICES - 2;
-
-		uint32_t numVertices		= NUM_BASE_VERTICES;
-		uint32_t numHoleTriangles	= 0;
+		using	Triangle = std::array<uint32_t, 3>;
 
-		for(auto& iHole : HOLES)
+		enum	VertexType : uint8_t
 		{
-			const uint32_t NUM_HOLE_VERTICES = static_cast<uint32_t>(iHole.size());
-			if(NUM_HOLE_VERTICES < 3)
-				continue;
+			eSTART,
+			eSPLIT,
+			eEND,
+			eMERGE,
+			eREGULAR_LEFT,	// Interior of the polygon is on the right side of the vertex.
+			eREGULAR_RIGHT	// Interior of the polygon is on the left side of the vertex.
+		};
 
-			numVertices			+= NUM_HOLE_VERTICES;
-			numHoleTriangles	+= NUM_HOLE_VERTICES - 2;
+		/*
+			Order of the sweep: from top to bottom, then from left to right.
+		*/
+		inline bool				is_above(	const Vec2&		A,
+											const Vec2&		B)
+		{
+			return A.y > B.y || (A.y == B.y && A.x < B.x);
 		}
 
-		return NUM_BASE_TRIANGLES + numVertices - numHoleTriangles;
-	}
-
-	Contour				to_contour(				const TriangleMesh::Vertices2D&		VERTICES,
-												const uint64_t						BEGIN,
-												const uint64_t						END)
+		/*
+			Positive if O -> A -> B turns left(in the XY axes).
+		*/
+		inline double			calculate_turn(	const Vec2&		O,
+												const Vec2&		A,
+												const Vec2&		B)
 		{
-			Contour contour;
-					contour.reserve(END-BEGIN);
-
-			for(uint64_t index = BEGIN; index < END; ++index)
-			{
-				contour.push_back(static_cast<uint32_t>(index));
-			}
-
-			return contour;
+			return (double(A.x) - O.x) * (double(B.y) - O.y) - (double(A.y) - O.y) * (double(B.x) - O.x);
 		}
 
-	inline void			validate_contour(		const Contour&						CONTOUR)
-	{
-		if(CONTOUR.size() < 3)
-			throw dpl::GeneralException(__FILE__, __LINE__, "Contour must have at least 3 vertices.");
-	}
-
 
-	namespace Triangulation
-	{
-		class	OrientedEdge
+		/*
+			Polygon with holes stored as links between vertices, so that the interior is always on the left side of the edge
+			from the vertex to the next one(border goes counter-clockwise and holes clockwise in the XY axes).
+			Edges are identified by their first vertex.
+
+			Triangulation is done in 3 steps:
+				1. Sweep over the sorted array of vertices adds diagonals that remove split and merge vertices.
+				2. Diagonals split the polygon into monotone pieces(stored in a single array).
+				3. Each piece is triangulated independently(in parallel if pool is given).
+		*/
+		class	MonotoneTriangulator
 		{
-		public: // data
-			dpl::ReadOnly<uint32_t,		OrientedEdge> beginID;
-			dpl::ReadOnly<uint32_t,		OrientedEdge> endID;
-			dpl::ReadOnly<Orientation,	OrientedEdge> orientation;
+		private: // subtypes
+			using	Diagonal = std::array<uint32_t, 2>;
+
+		public: // constants
+			static const uint32_t MIN_TRIANGLES_PER_TASK = 4096;
+
+		private: // data
+			const Vec2*				m_points;
+			uint32_t				m_numPoints;
+			std::vector<uint32_t>	m_next;
+			std::vector<uint32_t>	m_prev;
+			std::vector<VertexType>	m_types;
+			std::vector<uint32_t>	m_helpers;		// Last vertex visible from the left edge(indexed by edge).
+			std::vector<uint32_t>	m_status;		// Edges crossed by the sweep line with the interior on the right, from left to right.
+			std::vector<Diagonal>	m_diagonals;
+			std::vector<uint32_t>	m_pieces;		// Vertices of all monotone pieces(counter-clockwise).
+			std::vector<uint32_t>	m_pieceOffsets;	// Each piece has [m_pieceOffsets[N], m_pieceOffsets[N+1]) vertices.
 
 		public: // lifecycle
-			CLASS_CTOR			OrientedEdge(	const uint32_t		BEGIN_ID, 
-												const uint32_t		END_ID, 
-												const Orientation 	ORIENTATION)
-				: beginID(BEGIN_ID)
-				, endID(END_ID)
-				, orientation(ORIENTATION)
+			CLASS_CTOR				MonotoneTriangulator(	const Vec2*				POINTS,
+															const uint32_t			NUM_POINTS)
+				: m_points(POINTS)
+				, m_numPoints(NUM_POINTS)
+				, m_next(NUM_POINTS)
+				, m_prev(NUM_POINTS)
 			{
 
 			}
 
 		public: // functions
-			inline bool			operator==(		const OrientedEdge&	OTHER) const
+			/*
+				Links POINTS[FIRST, FIRST + SIZE) into the closed contour with the interior on the left side.
+			*/
+			void					add_contour(			const uint32_t			FIRST,
+															const uint32_t			SIZE,
+															const bool				bHOLE)
 			{
-				return OTHER.beginID == beginID && OTHER.endID == endID;
-			}
+				if(SIZE < 3)
+					throw dpl::GeneralException(__FILE__, __LINE__, "Contour must have at least 3 vertices.");
 
-			inline bool			operator!=(		const OrientedEdge&	OTHER) const
-			{
-				return OTHER.beginID != beginID || OTHER.endID != endID;
-			}
+				const Orientation	ORIENTATION		= calculate_polygon_orientation(&m_points[FIRST], SIZE);
+				const Orientation	REQUIRED		= bHOLE ? Orientation::CCW : Orientation::CW; // XY counter-clockwise is CW for calculate_polygon_orientation.
+				const bool			bREVERSED		= ORIENTATION != REQUIRED;
 
-			inline const Vec2&	begin(			const Vec2*			VERTEX_BUFFER) const
-			{
-				return VERTEX_BUFFER[beginID];
+				for(uint32_t index = 0; index < SIZE; ++index)
+				{
+					const uint32_t NEXT = FIRST + (bREVERSED ? (index + SIZE - 1) % SIZE : (index + 1) % SIZE);
+					m_next[FIRST + index]	= NEXT;
+					m_prev[NEXT]			= FIRST + index;
+				}
 			}
 
-			inline const Vec2&	end(			const Vec2*			VERTEX_BUFFER) const
+			/*
+				Returns number of triangles.
+			*/
+			uint32_t				split_into_monotones()
 			{
-				return VERTEX_BUFFER[endID];
+				sweep();
+				extract_pieces();
+
+				const uint32_t NUM_PIECES = static_cast<uint32_t>(m_pieceOffsets.size()) - 1;
+				return m_pieceOffsets.back() - 2 * NUM_PIECES;
 			}
 
-			/*
-			inline void			flip()
+			void					triangulate_monotones(	const Orientation		TARGET_ORIENTATION,
+															dpl::ThreadPool*		pool,
+															uint32_t*				output) const
 			{
-				std::swap(*beginID, *endID);
-				orientation = (orientation == Orientation::CW) ? Orientation::CCW : Orientation::CW;
-			}
-			*/
-		};
+				const uint32_t NUM_PIECES = static_cast<uint32_t>(m_pieceOffsets.size()) - 1;
 
-		/*
-			This class contains information about edges connected to the vertex.
-
-			There are 3 types of nodes
-
-			Node with both vectors starting on node's position.
-				A
-			   /
-			  T
-			   \
-			    B
-			--------------------------------> +X
-			Node with two vectors ending on node's position. 
-			 A
-			  \
-			   T
-			  /
-			 B
-			--------------------------------> +X
-			Node with one vector starting and second ending on node's position.
-			    A
-			   /
-		      T	
-			 /
-			B
-			--------------------------------> +X
-			where A and B are edges connected to adjacent KNodes
-
-
-			- nodes can be sorted with < operator using pointer to vertex
-			- nodes can generate edges
-		*/
-		class	TNode
-		{
-		public: // data
-			dpl::ReadOnly<Orientation,	TNode>	orientation;
-			dpl::ReadOnly<uint32_t,		TNode>	vertexID;
-			dpl::ReadOnly<uint32_t,		TNode>	prevID;
-			dpl::ReadOnly<uint32_t,		TNode>	nextID;		
-			dpl::ReadOnly<const Vec2*,	TNode>	vertices;
+				auto triangulate_range = [&](const uint32_t BEGIN, const uint32_t END)
+				{
+					std::vector<uint32_t>	sorted;
+					std::vector<uint8_t>	chains;
+					std::vector<uint32_t>	stack;
 
-		public: // lifecycle
-			CLASS_CTOR				TNode(			const Orientation	ORIENTATION,
-													const uint32_t		VERTEX_ID,
-													const uint32_t		PREV_ID,
-													const uint32_t		NEXT_ID,
-													const Vec2*			VERTEX_BUFFER)
-				: orientation(ORIENTATION)
-				, vertexID(VERTEX_ID)
-				, prevID(PREV_ID)
-				, nextID(NEXT_ID)
-				, vertices(VERTEX_BUFFER)
-			{
+					for(uint32_t pieceID = BEGIN; pieceID < END; ++pieceID)
+					{
+						const uint32_t FIRST_TRIANGLE = m_pieceOffsets[pieceID] - 2 * pieceID;
+						triangulate_monotone(pieceID, TARGET_ORIENTATION, sorted, chains, stack, output + FIRST_TRIANGLE * 3);
+					}
+				};
 
-			}
+				if(!pool)
+					return triangulate_range(0, NUM_PIECES);
 
-		public: // functions
-			inline const Vec2&		vertex() const
-			{
-				return vertices()[vertexID];
-			}
+				// Pieces are grouped into tasks with similar number of triangles.
+				for(uint32_t begin = 0; begin < NUM_PIECES;)
+				{
+					uint32_t end = begin + 1;
+					while(end < NUM_PIECES && (m_pieceOffsets[end] - m_pieceOffsets[begin]) - 2 * (end - begin) < MIN_TRIANGLES_PER_TASK)
+					{
+						++end;
+					}
 
-			inline const Vec2&		previous() const
-			{
-				return vertices()[prevID];
+					pool->add_task([&triangulate_range, begin, end](){ triangulate_range(begin, end); });
+					begin = end;
+				}
+
+				pool->wait();
 			}
 
-			inline const Vec2&		next() const
+		private: // sweep
+			VertexType				classify(				const uint32_t			VERTEX_ID) const
 			{
-				return vertices()[nextID];
+				const Vec2& PREV	= m_points[m_prev[VERTEX_ID]];
+				const Vec2& VERTEX	= m_points[VERTEX_ID];
+				const Vec2& NEXT	= m_points[m_next[VERTEX_ID]];
+
+				const bool bPREV_ABOVE	= is_above(PREV, VERTEX);
+				const bool bNEXT_ABOVE	= is_above(NEXT, VERTEX);
+				const bool bCONVEX		= calculate_turn(PREV, VERTEX, NEXT) > 0.0;
+
+				if(!bPREV_ABOVE && !bNEXT_ABOVE)	return bCONVEX ? eSTART : eSPLIT;
+				if(bPREV_ABOVE && bNEXT_ABOVE)		return bCONVEX ? eEND : eMERGE;
+				return bPREV_ABOVE ? eREGULAR_LEFT : eREGULAR_RIGHT;
 			}
 
-			inline bool				operator<(		const TNode&		OTHER) const
+			/*
+				Returns position of the first edge in the status that has the vertex on its left side.
+			*/
+			inline uint32_t			find_status_position(	const Vec2&				VERTEX) const
 			{
-				return less(this->vertex(), OTHER.vertex());
+				const auto IT = std::partition_point(m_status.begin(), m_status.end(), [&](const uint32_t EDGE_ID)
+				{
+					// Edges in the status go down, so the vertex is on the left if it is on the left side of the reversed edge.
+					return calculate_turn(m_points[m_next[EDGE_ID]], m_points[EDGE_ID], VERTEX) <= 0.0;
+				});
+
+				return static_cast<uint32_t>(IT - m_status.begin());
 			}
 
-			inline bool				is_IN_end() const
+			inline uint32_t			find_left_edge(			const uint32_t			VERTEX_ID) const
 			{
-				return less(previous(), vertex());
+				const uint32_t POSITION = find_status_position(m_points[VERTEX_ID]);
+				if(POSITION == 0)
+					throw dpl::GeneralException(__FILE__, __LINE__, "Invalid polygon: border and holes must not intersect.");
+
+				return m_status[POSITION - 1];
 			}
 
-			inline bool				is_OUT_end() const
+			inline void				insert_edge(			const uint32_t			EDGE_ID)
 			{
-				return less(next(), vertex());
+				const uint32_t POSITION = find_status_position(m_points[EDGE_ID]);
+				m_status.insert(m_status.begin() + POSITION, EDGE_ID);
+				m_helpers[EDGE_ID] = EDGE_ID;
 			}
 
-			inline OrientedEdge		calculate_IN() const
+			/*
+				Removes edge that ends at the current vertex.
+			*/
+			inline void				remove_edge(			const uint32_t			EDGE_ID)
 			{
-				return OrientedEdge(prevID, vertexID, orientation);
+				const uint32_t POSITION = find_status_position(m_points[m_next[EDGE_ID]]);
+				for(uint32_t index = POSITION; index > 0; --index)
+				{
+					if(m_status[index - 1] == EDGE_ID)
+					{
+						m_status.erase(m_status.begin() + (index - 1));
+						return;
+					}
+				}
+
+				m_status.erase(std::find(m_status.begin(), m_status.end(), EDGE_ID)); // Collinear edges(degenerated input).
 			}
 
-			inline OrientedEdge		calculate_OUT() const
+			/*
+				Adds diagonal to the helper of the edge if it is a merge vertex.
+			*/
+			inline void				connect_merge_helper(	const uint32_t			VERTEX_ID,
+															const uint32_t			EDGE_ID)
 			{
-				return OrientedEdge(vertexID, nextID, orientation);
+				if(m_types[m_helpers[EDGE_ID]] == eMERGE)
+					m_diagonals.push_back({VERTEX_ID, m_helpers[EDGE_ID]});
 			}
 
-		private: // functions
-			inline bool less(const Vec2& LHS, const Vec2& RHS) const
+			void					sweep()
 			{
-				if(LHS.x > RHS.x)	return false;
-				if(LHS.x < RHS.x)	return true;
-				return LHS.y < RHS.y;
-			}
-		};
+				std::vector<uint32_t> events(m_numPoints);
+				for(uint32_t vertexID = 0; vertexID < m_numPoints; ++vertexID)
+				{
+					events[vertexID] = vertexID;
+				}
 
-		class	KNode : public Vec2
-		{
-		public: // inherited
-			using Vec2::Vec2;
+				std::sort(events.begin(), events.end(), [&](const uint32_t A, const uint32_t B)
+				{
+					return is_above(m_points[A], m_points[B]);
+				});
 
-		public: // functions
-			inline bool		operator<(		const KNode&		OTHER) const
-			{
-				if(this->x > OTHER.x)	return false;
-				if(this->x < OTHER.x)	return true;
-				return this->y < OTHER.y;
-			}
-		};
+				m_types.resize(m_numPoints);
+				for(uint32_t vertexID = 0; vertexID < m_numPoints; ++vertexID)
+				{
+					m_types[vertexID] = classify(vertexID);
+				}
 
-		
-		using	ContourList		= std::list<Contour>;
-		using	Triangle		= std::array<uint32_t, 3>;
-		using	Triangles		= std::vector<Triangle>;
-		using	SortedNodes		= std::set<TNode>;
+				m_helpers.assign(m_numPoints, 0);
+				m_status.clear();
+				m_diagonals.clear();
 
-		struct	Result
-		{
-			SortedNodes		nodes;
-			ContourArray	monotones;
-			Triangles		triangles;
-		};
-	}
+				for(const uint32_t VERTEX_ID : events)
+				{
+					const uint32_t PREV_EDGE = m_prev[VERTEX_ID];
+					switch(m_types[VERTEX_ID])
+					{
+					case eSTART:
+						insert_edge(VERTEX_ID);
+						break;
 
-	namespace Triangulation2
-	{
-		using	Contour			= std::vector<uint32_t>;
-		using	ContourArray	= std::vector<Contour>;
+					case eEND:
+						connect_merge_helper(VERTEX_ID, PREV_EDGE);
+						remove_edge(PREV_EDGE);
+						break;
 
-		/*
-			This class contains information about edges connected to the vertex.
-
-			There are 3 types of nodes
-
-			Node with both vectors starting on node's position.
-				A
-			   /
-			  T
-			   \
-			    B
-			--------------------------------> +X
-			Node with two vectors ending on node's position. 
-			 A
-			  \
-			   T
-			  /
-			 B
-			--------------------------------> +X
-			Node with one vector starting and second ending on node's position.
-			    A
-			   /
-		      T	
-			 /
-			B
-			--------------------------------> +X
-			where A and B are edges connected to adjacent KNodes
-
-
-			- nodes can be sorted with < operator using pointer to vertex
-			- nodes can generate edges
-		*/
+					case eSPLIT:
+					{
+						const uint32_t LEFT_EDGE = find_left_edge(VERTEX_ID);
+						m_diagonals.push_back({VERTEX_ID, m_helpers[LEFT_EDGE]});
+						m_helpers[LEFT_EDGE] = VERTEX_ID;
+						insert_edge(VERTEX_ID);
+						break;
+					}
 
-		class	OrientedEdge
-		{
-		public: // data
-			dpl::ReadOnly<uint32_t,		OrientedEdge>	beginID;
-			dpl::ReadOnly<uint32_t,		OrientedEdge>	endID;
-			dpl::ReadOnly<Orientation,	OrientedEdge>	orientation;
-			dpl::ReadOnly<const Vec2*,	OrientedEdge>	vertices;
+					case eMERGE:
+					{
+						connect_merge_helper(VERTEX_ID, PREV_EDGE);
+						remove_edge(PREV_EDGE);
+						const uint32_t LEFT_EDGE = find_left_edge(VERTEX_ID);
+						connect_merge_helper(VERTEX_ID, LEFT_EDGE);
+						m_helpers[LEFT_EDGE] = VERTEX_ID;
+						break;
+					}
 
-		public: // lifecycle
-			CLASS_CTOR			OrientedEdge(	const uint32_t		BEGIN_ID, 
-												const uint32_t		END_ID, 
-												const Orientation 	ORIENTATION,
-												const Vec2*			VERTEX_BUFFER)
-				: beginID(BEGIN_ID)
-				, endID(END_ID)
-				, orientation(ORIENTATION)
-				, vertices(VERTEX_BUFFER)
-			{
+					case eREGULAR_LEFT:
+						connect_merge_helper(VERTEX_ID, PREV_EDGE);
+						remove_edge(PREV_EDGE);
+						insert_edge(VERTEX_ID);
+						break;
 
+					case eREGULAR_RIGHT:
+					{
+						const uint32_t LEFT_EDGE = find_left_edge(VERTEX_ID);
+						connect_merge_helper(VERTEX_ID, LEFT_EDGE);
+						m_helpers[LEFT_EDGE] = VERTEX_ID;
+						break;
+					}
+					}
+				}
 			}
 
-		public: // functions
-			inline bool			operator==(		const OrientedEdge&	OTHER) const
+		private: // pieces
+			/*
+				Walks faces of the polygon split by the diagonals.
+				Half edges: [0, m_numPoints) are the edges of the polygon, then each diagonal adds 2 half edges(one per direction).
+			*/
+			void					extract_pieces()
 			{
-				return OTHER.beginID == beginID && OTHER.endID == endID;
-			}
+				const uint32_t NUM_DIAGONALS	= static_cast<uint32_t>(m_diagonals.size());
+				const uint32_t NUM_HALF_EDGES	= m_numPoints + 2 * NUM_DIAGONALS;
 
-			inline bool			operator!=(		const OrientedEdge&	OTHER) const
-			{
-				return OTHER.beginID != beginID || OTHER.endID != endID;
-			}
+				auto get_origin = [&](const uint32_t HALF_EDGE)
+				{
+					return (HALF_EDGE < m_numPoints) ? HALF_EDGE : m_diagonals[(HALF_EDGE - m_numPoints) / 2][(HALF_EDGE - m_numPoints) % 2];
+				};
 
-			inline bool			operator<(		const OrientedEdge&	OTHER) const
-			{
-				return less(this->begin(), OTHER.begin());
-			}
+				auto get_destination = [&](const uint32_t HALF_EDGE)
+				{
+					return (HALF_EDGE < m_numPoints) ? m_next[HALF_EDGE] : m_diagonals[(HALF_EDGE - m_numPoints) / 2][1 - (HALF_EDGE - m_numPoints) % 2];
+				};
 
-			inline const Vec2&	begin() const
-			{
-				return vertices()[beginID];
-			}
+				// Outgoing half edges of each vertex(only vertices with diagonals have more than one).
+				std::vector<uint32_t> outgoingOffsets(m_numPoints + 1, 0);
+				for(uint32_t halfEdge = 0; halfEdge < NUM_HALF_EDGES; ++halfEdge)
+				{
+					++outgoingOffsets[get_origin(halfEdge) + 1];
+				}
 
-			inline const Vec2&	end() const
-			{
-				return vertices()[endID];
-			}
+				for(uint32_t vertexID = 0; vertexID < m_numPoints; ++vertexID)
+				{
+					outgoingOffsets[vertexID + 1] += outgoingOffsets[vertexID];
+				}
 
-			inline uint32_t		get_monotone_beginID() const
-			{
-				return less(begin(), end()) ? beginID() : endID();
-			}
+				std::vector<uint32_t> outgoing(NUM_HALF_EDGES);
+				{
+					std::vector<uint32_t> cursors(outgoingOffsets.begin(), outgoingOffsets.end() - 1);
+					for(uint32_t halfEdge = 0; halfEdge < NUM_HALF_EDGES; ++halfEdge)
+					{
+						outgoing[cursors[get_origin(halfEdge)]++] = halfEdge;
+					}
+				}
 
-			inline uint32_t		get_monotone_endID() const
-			{
-				return less(begin(), end()) ? endID() : beginID();
+				// Next half edge of the face is the first one clockwise from the reversed incoming half edge.
+				auto get_next = [&](const uint32_t HALF_EDGE)
+				{
+					const uint32_t VERTEX_ID	= get_destination(HALF_EDGE);
+					const uint32_t BEGIN		= outgoingOffsets[VERTEX_ID];
+					const uint32_t END			= outgoingOffsets[VERTEX_ID + 1];
+					if(END - BEGIN == 1)
+						return outgoing[BEGIN];
+
+					const Vec2&		VERTEX		= m_points[VERTEX_ID];
+					const Vec2		REFERENCE	= m_points[get_origin(HALF_EDGE)] - VERTEX;
+					uint32_t		next		= outgoing[BEGIN];
+					double			minAngle	= 4.0 * glm::pi<double>();
+
+					for(uint32_t index = BEGIN; index < END; ++index)
+					{
+						const Vec2		DIRECTION	= m_points[get_destination(outgoing[index])] - VERTEX;
+						const double	CROSS		= double(DIRECTION.x) * REFERENCE.y - double(DIRECTION.y) * REFERENCE.x;
+						const double	DOT			= double(DIRECTION.x) * REFERENCE.x + double(DIRECTION.y) * REFERENCE.y;
+						double			angle		= std::atan2(CROSS, DOT);
+						if(angle <= 0.0) angle += 2.0 * glm::pi<double>();
+
+						if(angle < minAngle)
+						{
+							minAngle	= angle;
+							next		= outgoing[index];
+						}
+					}
+
+					return next;
+				};
+
+				m_pieces.clear();
+				m_pieces.reserve(NUM_HALF_EDGES);
+				m_pieceOffsets.assign(1, 0);
+
+				std::vector<bool> visited(NUM_HALF_EDGES, false);
+				for(uint32_t first = 0; first < NUM_HALF_EDGES; ++first)
+				{
+					if(visited[first]) continue;
+
+					uint32_t halfEdge = first;
+					do
+					{
+						visited[halfEdge] = true;
+						m_pieces.push_back(get_origin(halfEdge));
+						halfEdge = get_next(halfEdge);
+					}
+					while(!visited[halfEdge]);
+
+					m_pieceOffsets.push_back(static_cast<uint32_t>(m_pieces.size()));
+					if(m_pieceOffsets.back() - m_pieceOffsets[m_pieceOffsets.size() - 2] < 3)
+						throw dpl::GeneralException(__FILE__, __LINE__, "Invalid polygon: border and holes must not intersect.");
+				}
 			}
 
-			bool				point_between(	const Vec2&			POINT) const
+			/*
+				Writes PIECE_SIZE - 2 triangles of the monotone piece to the output.
+			*/
+			void					triangulate_monotone(	const uint32_t			PIECE_ID,
+															const Orientation		TARGET_ORIENTATION,
+															std::vector<uint32_t>&	sorted,
+															std::vector<uint8_t>&	chains,
+															std::vector<uint32_t>&	stack,
+															uint32_t*				output) const
 			{
-				const Vec2& BEGIN	= begin();
-				const Vec2& END		= end();
+				const uint32_t* PIECE	= &m_pieces[m_pieceOffsets[PIECE_ID]];
+				const uint32_t	SIZE	= m_pieceOffsets[PIECE_ID + 1] - m_pieceOffsets[PIECE_ID];
 
-				if(less(BEGIN, END))
+				// Triangles are counter-clockwise in the XY axes, which is CW for calculate_polygon_orientation.
+				const bool bFLIP = TARGET_ORIENTATION == Orientation::CCW;
+				auto add_triangle = [&](const uint32_t A, uint32_t b, uint32_t c)
+				{
+					if((calculate_turn(m_points[A], m_points[b], m_points[c]) < 0.0) != bFLIP) std::swap(b, c);
+					*output++ = A;
+					*output++ = b;
+					*output++ = c;
+				};
+
+				if(SIZE < 3) return;
+				if(SIZE == 3) return add_triangle(PIECE[0], PIECE[1], PIECE[2]);
+
+				// Merge left(forward from the top) and right(backward from the top) chains into the sweep order.
+				uint32_t top = 0;
+				for(uint32_t index = 1; index < SIZE; ++index)
 				{
-					const Vec2& LEFT	= BEGIN;
-					const Vec2& RIGHT	= END;
+					if(is_above(m_points[PIECE[index]], m_points[PIECE[top]])) top = index;
+				}
+
+				sorted.resize(SIZE);
+				chains.resize(SIZE);
+				sorted[0] = PIECE[top];
+				chains[0] = 0;
 
-					return less(LEFT, POINT) && less(POINT, RIGHT);
+				uint32_t left	= (top + 1) % SIZE;
+				uint32_t right	= (top + SIZE - 1) % SIZE;
+				for(uint32_t index = 1; index < SIZE; ++index)
+				{
+					if(left != right && is_above(m_points[PIECE[right]], m_points[PIECE[left]]))
+					{
+						sorted[index] = PIECE[right];
+						chains[index] = 1;
+						right = (right + SIZE - 1) % SIZE;
+					}
+					else
+					{
+						sorted[index] = PIECE[left];
+						chains[index] = 0;
+						left = (left + 1) % SIZE;
+					}
 				}
 
-				const Vec2& LEFT	= END;
-				const Vec2& RIGHT	= BEGIN;
+				stack.clear();
+				stack.push_back(0);
+				stack.push_back(1);
 
-				return less(LEFT, POINT) && less(POINT, RIGHT);
-			}
+				for(uint32_t index = 2; index < SIZE - 1; ++index)
+				{
+					const uint32_t VERTEX = sorted[index];
+					if(chains[index] != chains[stack.back()])
+					{
+						// Connect with all vertices on the stack(opposite chain).
+						for(uint32_t stackID = 1; stackID < stack.size(); ++stackID)
+						{
+							add_triangle(VERTEX, sorted[stack[stackID - 1]], sorted[stack[stackID]]);
+						}
 
-			/*
-			inline bool			point_left(		const Vec2&			POINT) const
-			{
-				return less(POINT, glm::min(begin(), end()));
+						const uint32_t LAST = stack.back();
+						stack.clear();
+						stack.push_back(LAST);
+						stack.push_back(index);
+					}
+					else
+					{
+						// Connect with vertices on the same chain while diagonals are inside.
+						uint32_t last = stack.back();
+						stack.pop_back();
+
+						while(!stack.empty())
+						{
+							const double TURN	= calculate_turn(m_points[sorted[stack.back()]], m_points[sorted[last]], m_points[VERTEX]);
+							const bool bINSIDE	= (chains[index] == 0) ? TURN > 0.0 : TURN < 0.0;
+							if(!bINSIDE) break;
+
+							add_triangle(VERTEX, sorted[last], sorted[stack.back()]);
+							last = stack.back();
+							stack.pop_back();
+						}
+
+						stack.push_back(last);
+						stack.push_back(index);
+					}
+				}
+
+				const uint32_t BOTTOM = sorted[SIZE - 1];
+				for(uint32_t stackID = 1; stackID < stack.size(); ++stackID)
+				{
+					add_triangle(BOTTOM, sorted[stack[stackID - 1]], sorted[stack[stackID]]);
+				}
 			}
+		};
+	}
+
+	void						fill(			std::vector<p2t::Point>&	output,
+												const std::vector<Vec2>&	POLYGON,
+												const Orientation			TARGET_ORIENTATION)
+	{
+		output.reserve(output.size() + POLYGON.size());
+
+		const uint32_t		NUM_POINTS	= static_cast<uint32_t>(POLYGON.size());
+		const Orientation	ORIENTATION = calculate_polygon_orientation(POLYGON.data(), NUM_POINTS);
 
-			inline bool			point_right(	const Vec2&			POINT) const
+		if(ORIENTATION == TARGET_ORIENTATION)
+		{
+			for(auto& iVertex : POLYGON)
 			{
-				return less(glm::max(begin(), end()), POINT);
+				output.emplace_back(iVertex.x, iVertex.y);
 			}
-			*/
-		private: // functions
-			inline bool			less(			const Vec2& LHS, const Vec2& RHS) const
+		}
+		else // Inverse
+		{
+			for(uint32_t index = 0; index < NUM_POINTS;++index)
 			{
-				if(LHS.x > RHS.x)	return false;
-				if(LHS.x < RHS.x)	return true;
-				return LHS.y < RHS.y;
+				const auto& VERTEX = POLYGON[NUM_POINTS-1-index];
+				output.emplace_back(VERTEX.x, VERTEX.y);
 			}
+		}
+	}
 
-			inline bool			less_equal(		const Vec2& LHS, const Vec2& RHS) const
-			{
-				if(LHS.x > RHS.x)	return false;
-				if(LHS.x < RHS.x)	return true;
-				return LHS.y <= RHS.y;
-			}
-		};
+	std::vector<p2t::Point*>	to_contour(		std::vector<p2t::Point>&	vertices,
+												const uint64_t				BEGIN,
+												const uint64_t				END)
+	{
+		std::vector<p2t::Point*>	contour;
+									contour.reserve(END-BEGIN);
+
+		for(uint64_t index = BEGIN; index < END; ++index)
+		{
+			contour.push_back(&vertices[index]);
+		}
 
-		using	Triangle		= std::array<uint32_t, 3>;
-		using	Triangles		= std::vector<Triangle>;
-		using	SortedEdges		= std::map<OrientedEdge, std::unique_ptr<Contour>>; // Maps edges with potential monotone polygons.
-		using	Intersections	= std::unordered_map<float, std::vector<SortedEdges::iterator>>; // All edges that intersect given X coordinate.
+		return contour;
 	}
-}
 
-namespace std
-{
-	template <>
-	struct hash<cml::Triangulation::OrientedEdge>
+//=====> TriangleMesh -> public functions
+	void		TriangleMesh::triangulate(		const CoordinateSystem& RPS,
+												const uint32_t			X_2D_INDEX,
+												const uint32_t			Y_2D_INDEX,
+												const Vertices2D&		BORDER_POLYGON,
+												const Vertices2DArray&	HOLE_POLYGONS,
+												const Orientation		TARGET_ORIENTATION,
+												const TriangulationMethod METHOD,
+												dpl::ThreadPool*		pool)
 	{
-		static size_t	calculate(	const cml::Triangulation::OrientedEdge& EDGE)
-		{
-			if(EDGE.beginID > EDGE.endID)
-				return (hash<uint32_t>()(EDGE.beginID) ^ hash<uint32_t>()(EDGE.endID) << 1);
+		Vertices2D vertices2D;
 
-			return (hash<uint32_t>()(EDGE.endID) ^ hash<uint32_t>()(EDGE.beginID) << 1);
+		if(METHOD == TriangulationMethod::MONOTONE)
+		{
+			triangulate_monotone(BORDER_POLYGON, HOLE_POLYGONS, TARGET_ORIENTATION, pool, vertices2D);
+		}
+		else
+		{
+			triangulate_delaunay(BORDER_POLYGON, HOLE_POLYGONS, TARGET_ORIENTATION, vertices2D);
 		}
+		
+		// Transform 2D vertices into 3D RPS space.
+		vertices = Vertices(vertices2D.size());
+		for(uint64_t vertexID = 0; vertexID < vertices2D.size(); ++vertexID)
+		{
+			(*vertices)[vertexID] = RPS.unproject_point(vertices2D[vertexID], X_2D_INDEX, Y_2D_INDEX);
+		}
+	}
+
+	void		TriangleMesh::validate_index_count() const
+	{
+		if(get_numIndices() % 3 != 0)
+			throw dpl::GeneralException(this, __LINE__, "Number of indices must be divisible by 3.");
+	}
 
-		size_t			operator()(	const cml::Triangulation::OrientedEdge& link) const
+	void		TriangleMesh::validate_indices() const
+	{
+		validate_index_count();
+
+		const uint32_t NUM_VERTICES = get_numVertices();
+		for(auto& index : indices())
 		{
-			return calculate(link);
+			if(index >= NUM_VERTICES)
+				throw dpl::GeneralException(this, __LINE__, "TriangleMesh contains at least one invalid index.");
 		}
-	};
+	}
 
-	template <>
-	struct hash<cml::Triangulation2::OrientedEdge>
+	void		TriangleMesh::extend(			const TriangleMesh&		OTHER,
+												const Mat4&				OTHER_TRANSFORMATION)
 	{
-		static size_t	calculate(	const cml::Triangulation2::OrientedEdge& EDGE)
+		vertices->reserve(get_numVertices() + OTHER.get_numVertices());
+		indices->reserve(get_numIndices() + OTHER.get_numIndices());
+
+		const uint32_t VERTEX_OFFSET = get_numVertices();
+
+		for(auto& OTHER_VERTEX : OTHER.vertices())
 		{
-			if(EDGE.beginID > EDGE.endID)
-				return (hash<uint32_t>()(EDGE.beginID) ^ hash<uint32_t>()(EDGE.endID) << 1);
+			vertices->push_back(OTHER_TRANSFORMATION * Vec4(OTHER_VERTEX, 1.f));
+		}
 
-			return (hash<uint32_t>()(EDGE.endID) ^ hash<uint32_t>()(EDGE.beginID) << 1);
+		for(auto& OTHER_INDEX : OTHER.indices())
+		{
+			indices->push_back(OTHER_INDEX + VERTEX_OFFSET);
 		}
+	}
 
-		size_t			operator()(	const cml::Triangulation2::OrientedEdge& link) const
+	void		TriangleMesh::flip()
+	{
+		validate_index_count();
+
+		const uint32_t NUM_TRIANGLES = get_numIndices() / 3;
+
+		// Swap second and third vertex index of each triangle.
+		for(uint32_t triangleID = 0; triangleID < NUM_TRIANGLES; ++triangleID)
 		{
-			return calculate(link);
+			const uint32_t OFFSET = triangleID * 3;
+			std::swap((*indices)[OFFSET+1], (*indices)[OFFSET+2]);
 		}
-	};
-}
+	}
 
-namespace cml
-{
-	namespace Triangulation
+	namespace
 	{
-		Orientation			calculate_winding(		const uint32_t*						CONTOUR,
-													const uint64_t						CONTOUR_SIZE,
-													const Vec2*							VERTEX_BUFFER)
+		const uint32_t NORMALS_CHUNK_SIZE		= 16384;	// Minimal number of triangles or vertices processed by a separate task.
+		const uint32_t NORMALS_MAX_SPAN_FACTOR	= 2;		// Partition sums may take at most this many times the number of vertices.
+
+		/*
+			Triangles adjacent to each vertex(CSR): [offsets[V], offsets[V+1]) in triangles.
+		*/
+		struct	VertexAdjacency
+		{
+			std::vector<uint32_t> offsets;
+			std::vector<uint32_t> triangles;
+
+			CLASS_CTOR	VertexAdjacency(	const uint32_t*		INDICES,
+											const uint32_t		NUM_INDICES,
+											const uint32_t		NUM_VERTICES)
+				: offsets(NUM_VERTICES + 1, 0)
+				, triangles(NUM_INDICES)
+			{
+				for(uint32_t index = 0; index < NUM_INDICES; ++index)
+				{
+					++offsets[INDICES[index] + 1];
+				}
+
+				for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+				{
+					offsets[vertexID + 1] += offsets[vertexID];
+				}
+
+				std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+				for(uint32_t index = 0; index < NUM_INDICES; ++index)
+				{
+					triangles[cursors[INDICES[index]]++] = index / 3;
+				}
+			}
+		};
+
+		/*
+			Normal sums of the vertices [firstVertex, firstVertex + span) referenced by one range of triangles.
+		*/
+		struct	NormalPartition
+		{
+			uint32_t			firstVertex = 0;
+			uint32_t			span		= 0;
+			std::vector<Vec3>	sums;
+		};
+
+		/*
+			Approximation of atan2(Y, X) for Y >= 0(maximal error is about 1e-5 radians).
+		*/
+		inline Lanes::Reg	approximate_angle(	const Lanes::Reg	Y,
+												const Lanes::Reg	X)
+		{
+			const Lanes::Reg ZERO	= Lanes::set(0.f);
+			const Lanes::Reg ABS_X	= Lanes::abs(X);
+			const Lanes::Reg MIN	= Lanes::min(ABS_X, Y);
+			const Lanes::Reg MAX	= Lanes::max(ABS_X, Y);
+			const Lanes::Reg T		= Lanes::masked(Lanes::greater(MAX, ZERO), Lanes::div(MIN, MAX));
+			const Lanes::Reg T2		= Lanes::mul(T, T);
+
+			Lanes::Reg	angle = Lanes::add(Lanes::mul(Lanes::set(-0.0464964749f), T2), Lanes::set(0.15931422f));
+						angle = Lanes::add(Lanes::mul(angle, T2), Lanes::set(-0.327622764f));
+						angle = Lanes::add(Lanes::mul(Lanes::mul(angle, T2), T), T);
+						angle = Lanes::select(Lanes::greater(Y, ABS_X), Lanes::sub(Lanes::set(glm::half_pi<float>()), angle), angle);
+			return		Lanes::select(Lanes::less(X, ZERO), Lanes::sub(Lanes::set(glm::pi<float>()), angle), angle);
+		}
+
+		/*
+			Calls EMIT(triangleID, N, WEIGHTS) for the triangles [BEGIN, END), where N is the weighted normal of the triangle
+			and WEIGHTS are the angles at its corners(ones if weighting is not by angle).
+			Cross products are computed in groups of Lanes::WIDTH triangles, degenerate triangles have zero normal.
+		*/
+		template<typename EmitT>
+		void		compute_normals(		const Vec3*				VERTICES,
+											const uint32_t*			INDICES,
+											const uint32_t			BEGIN,
+											const uint32_t			END,
+											const TriangleMesh::NormalWeighting WEIGHTING,
+											EmitT&&					emit)
 		{
-			float signedArea = 0.f;
+			const uint32_t W = Lanes::WIDTH;
+			const Lanes::Reg ZERO	= Lanes::set(0.f);
+			const Lanes::Reg ONE	= Lanes::set(1.f);
+
+			float abX[W], abY[W], abZ[W];
+			float acX[W], acY[W], acZ[W];
+			float nX[W], nY[W], nZ[W];
+			float angleA[W], angleB[W], angleC[W];
+
+			for(uint32_t first = BEGIN; first < END; first += W)
+			{
+				const uint32_t NUM_LANES = std::min(W, END - first);
+				for(uint32_t lane = 0; lane < W; ++lane)
+				{
+					if(lane < NUM_LANES)
+					{
+						const uint32_t* TRIANGLE = &INDICES[(first + lane) * 3];
+						const Vec3& A	= VERTICES[TRIANGLE[0]];
+						const Vec3 AB	= VERTICES[TRIANGLE[1]] - A;
+						const Vec3 AC	= VERTICES[TRIANGLE[2]] - A;
+						abX[lane] = AB.x; abY[lane] = AB.y; abZ[lane] = AB.z;
+						acX[lane] = AC.x; acY[lane] = AC.y; acZ[lane] = AC.z;
+					}
+					else
+					{
+						abX[lane] = abY[lane] = abZ[lane] = 0.f;
+						acX[lane] = acY[lane] = acZ[lane] = 0.f;
+					}
+				}
+
+				const Lanes::Reg ABX = Lanes::load(abX), ABY = Lanes::load(abY), ABZ = Lanes::load(abZ);
+				const Lanes::Reg ACX = Lanes::load(acX), ACY = Lanes::load(acY), ACZ = Lanes::load(acZ);
+
+				const Lanes::Reg NX		= Lanes::sub(Lanes::mul(ABY, ACZ), Lanes::mul(ABZ, ACY));
+				const Lanes::Reg NY		= Lanes::sub(Lanes::mul(ABZ, ACX), Lanes::mul(ABX, ACZ));
+				const Lanes::Reg NZ		= Lanes::sub(Lanes::mul(ABX, ACY), Lanes::mul(ABY, ACX));
+				const Lanes::Reg LENGTH	= Lanes::sqrt(Lanes::add(Lanes::add(Lanes::mul(NX, NX), Lanes::mul(NY, NY)), Lanes::mul(NZ, NZ)));
+
+				// Length of the cross product is twice the area of the triangle, so area weighting keeps it.
+				const Lanes::Reg SCALE	= (WEIGHTING == TriangleMesh::NormalWeighting::AREA)? ONE
+										: Lanes::masked(Lanes::greater(LENGTH, ZERO), Lanes::div(ONE, LENGTH));
+
+				Lanes::store(nX, Lanes::mul(NX, SCALE));
+				Lanes::store(nY, Lanes::mul(NY, SCALE));
+				Lanes::store(nZ, Lanes::mul(NZ, SCALE));
+
+				if(WEIGHTING == TriangleMesh::NormalWeighting::ANGLE)
+				{
+					/*
+						Angle at the corner is atan2(|E1 x E2|, E1 . E2), where the cross product has the same length for each corner:
+						A: AB . AC
+						B: BC . BA = |AB|^2 - AB . AC
+						C: CA . CB = |AC|^2 - AB . AC
+					*/
+					const Lanes::Reg DOT_A	= Lanes::add(Lanes::add(Lanes::mul(ABX, ACX), Lanes::mul(ABY, ACY)), Lanes::mul(ABZ, ACZ));
+					const Lanes::Reg AB2	= Lanes::add(Lanes::add(Lanes::mul(ABX, ABX), Lanes::mul(ABY, ABY)), Lanes::mul(ABZ, ABZ));
+					const Lanes::Reg AC2	= Lanes::add(Lanes::add(Lanes::mul(ACX, ACX), Lanes::mul(ACY, ACY)), Lanes::mul(ACZ, ACZ));
+					Lanes::store(angleA, approximate_angle(LENGTH, DOT_A));
+					Lanes::store(angleB, approximate_angle(LENGTH, Lanes::sub(AB2, DOT_A)));
+					Lanes::store(angleC, approximate_angle(LENGTH, Lanes::sub(AC2, DOT_A)));
+				}
+
+				for(uint32_t lane = 0; lane < NUM_LANES; ++lane)
+				{
+					const Vec3 N(nX[lane], nY[lane], nZ[lane]);
+					if(WEIGHTING == TriangleMesh::NormalWeighting::ANGLE)	emit(first + lane, N, Vec3(angleA[lane], angleB[lane], angleC[lane]));
+					else													emit(first + lane, N, Vec3(1.f, 1.f, 1.f));
+				}
+			}
+		}
 
-			for(uint64_t i = CONTOUR_SIZE -1, j = 0; j < CONTOUR_SIZE; i = j++)
+		/*
+			Adds weighted normals of the triangles [BEGIN, END) to the sums[vertexID - FIRST_VERTEX].
+		*/
+		void		accumulate_normals(		const Vec3*				VERTICES,
+											const uint32_t*			INDICES,
+											const uint32_t			BEGIN,
+											const uint32_t			END,
+											const TriangleMesh::NormalWeighting WEIGHTING,
+											const uint32_t			FIRST_VERTEX,
+											Vec3*					sums)
+		{
+			compute_normals(VERTICES, INDICES, BEGIN, END, WEIGHTING, [&](const uint32_t TRIANGLE_ID, const Vec3& N, const Vec3& WEIGHTS)
 			{
-				const auto& FIRST_VERTEX	= VERTEX_BUFFER[CONTOUR[i]];
-				const auto& SECOND_VERTEX	= VERTEX_BUFFER[CONTOUR[j]];
+				const uint32_t* TRIANGLE = &INDICES[TRIANGLE_ID * 3];
+				sums[TRIANGLE[0] - FIRST_VERTEX] += N * WEIGHTS.x;
+				sums[TRIANGLE[1] - FIRST_VERTEX] += N * WEIGHTS.y;
+				sums[TRIANGLE[2] - FIRST_VERTEX] += N * WEIGHTS.z;
+			});
+		}
+
+		inline Vec3	normalize_sum(			const Vec3&				SUM)
+		{
+			const float LENGTH = glm::length(SUM);
+			return (LENGTH > 0.f)? SUM / LENGTH : Vec3(0.f, 0.f, 0.f);
+		}
+	}
+
+	void		TriangleMesh::generate_normals(	Vec3*					output,
+												const NormalWeighting	WEIGHTING,
+												dpl::ThreadPool*		pool) const
+	{
+		validate_indices();
+
+		const uint32_t	NUM_VERTICES	= get_numVertices();
+		const uint32_t	NUM_TRIANGLES	= get_numIndices() / 3;
+		const Vec3*		VERTICES		= vertices().data();
+		const uint32_t*	INDICES			= indices().data();
 
-				signedArea += FIRST_VERTEX.x * SECOND_VERTEX.y - SECOND_VERTEX.x * FIRST_VERTEX.y;
+		const uint32_t	NUM_CHUNKS		= (NUM_TRIANGLES + NORMALS_CHUNK_SIZE - 1) / NORMALS_CHUNK_SIZE;
+		const uint32_t	NUM_PARTITIONS	= pool? std::min(NUM_CHUNKS, static_cast<uint32_t>(pool->get_numWorkers())) : 1;
+
+		if(NUM_PARTITIONS <= 1)
+		{
+			std::fill(output, output + NUM_VERTICES, Vec3(0.f, 0.f, 0.f));
+			accumulate_normals(VERTICES, INDICES, 0, NUM_TRIANGLES, WEIGHTING, 0, output);
+			for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+			{
+				output[vertexID] = normalize_sum(output[vertexID]);
 			}
+			return;
+		}
 
-			return signedArea < 0.f ? Orientation::CW : Orientation::CCW;
+		/*
+			Each task accumulates one range of triangles into its own sums, bounded by the range of referenced vertices
+			(narrow for meshes with coherent indices, e.g. terrain grids). Sums are then gathered per vertex in the order of partitions.
+		*/
+		std::vector<NormalPartition> partitions(NUM_PARTITIONS);
+		for(uint32_t partitionID = 0; partitionID < NUM_PARTITIONS; ++partitionID)
+		{
+			pool->add_task([&, partitionID]()
+			{
+				const uint32_t BEGIN	= static_cast<uint32_t>(uint64_t(NUM_TRIANGLES) * partitionID / NUM_PARTITIONS);
+				const uint32_t END		= static_cast<uint32_t>(uint64_t(NUM_TRIANGLES) * (partitionID + 1) / NUM_PARTITIONS);
+				const auto BOUNDS		= std::minmax_element(INDICES + BEGIN * 3, INDICES + END * 3);
+
+				NormalPartition& partition = partitions[partitionID];
+				partition.firstVertex	= *BOUNDS.first;
+				partition.span			= *BOUNDS.second - *BOUNDS.first + 1;
+			});
 		}
+		pool->wait();
 
-		void				contour_to_TNodes(		const Contour&						CONTOUR,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER,
-													SortedNodes&						output)
+		uint64_t totalSpan = 0;
+		for(const NormalPartition& PARTITION : partitions)
 		{
-			validate_contour(CONTOUR);
+			totalSpan += PARTITION.span;
+		}
 
-			const uint32_t		NUM_VERTICES	= static_cast<uint32_t>(CONTOUR.size());
-			const Orientation	ORIENTATION		= calculate_winding(CONTOUR.data(), NUM_VERTICES, VERTEX_BUFFER);
+		// Incoherent indices(merged or shuffled meshes) make each partition cover most of the vertices.
+		if(totalSpan > uint64_t(NORMALS_MAX_SPAN_FACTOR) * NUM_VERTICES)
+		{
+			generate_normals_by_adjacency(output, WEIGHTING, *pool);
+			return;
+		}
 
-			for (uint32_t i = NUM_VERTICES - 1, j = 0; j < NUM_VERTICES; i = j++)
+		for(uint32_t partitionID = 0; partitionID < NUM_PARTITIONS; ++partitionID)
+		{
+			pool->add_task([&, partitionID]()
 			{
-				const uint32_t	CURRENT_ID	= CONTOUR.at(j);
-				uint32_t		prevID		= CONTOUR.at(i);
-				uint32_t		nextID		= CONTOUR.at((j+1)%NUM_VERTICES);
+				const uint32_t BEGIN	= static_cast<uint32_t>(uint64_t(NUM_TRIANGLES) * partitionID / NUM_PARTITIONS);
+				const uint32_t END		= static_cast<uint32_t>(uint64_t(NUM_TRIANGLES) * (partitionID + 1) / NUM_PARTITIONS);
 
-				if(ORIENTATION != TARGET_ORIENTATION) std::swap(prevID, nextID);
-
-				auto result = output.emplace(TARGET_ORIENTATION, CONTOUR.at(j), prevID, nextID, VERTEX_BUFFER);
-				if(result.second == false)
-					throw dpl::GeneralException(__FILE__, __LINE__, "No two, arbitrary vertices of the polygon and its holes can share the same X and Y coordinate.");
-			}
+				NormalPartition& partition = partitions[partitionID];
+				partition.sums.assign(partition.span, Vec3(0.f, 0.f, 0.f));
+				accumulate_normals(VERTICES, INDICES, BEGIN, END, WEIGHTING, partition.firstVertex, partition.sums.data());
+			});
 		}
+		pool->wait();
 
-		ContourList			TNodes_to_monotones(	const SortedNodes&					NODES,
-													const Vec2*							VERTEX_BUFFER)
+		for(uint32_t begin = 0; begin < NUM_VERTICES; begin += NORMALS_CHUNK_SIZE)
 		{
-			ContourList output;
-
-			// Pointer to Contour forces output to be a list instead of a vector.
-			std::unordered_map<OrientedEdge, Contour*>	openPolygons;  // open map of edges that are used to generate monotone polygons
-
-			// Triangulation starts here.
-			// We process each T-Node from left to right and try to assign it to the monotone polygon.
-			for(auto& iNode : NODES)
+			const uint32_t END = std::min(begin + NORMALS_CHUNK_SIZE, NUM_VERTICES);
+			pool->add_task([&, begin, END]()
 			{
-				const OrientedEdge IN  = iNode.calculate_IN();
-				const OrientedEdge OUT = iNode.calculate_OUT();
-
-				// Distance to closest edge above the node.
-				const OrientedEdge* edgeAbove		= nullptr;
-				float				aboveDistance	= std::numeric_limits<float>::max();
-
-				// Distance to closest edge below the node.
-				const OrientedEdge* edgeBelow		= nullptr;
-				float				belowDistance	= std::numeric_limits<float>::max();
-
-				// Each edge, no matter if we can add it to the polygon or not, can override edges above or below.
-				// We will check on which side of the edge is the current TNode and based on that we will decide 
-				// whether or not it will be added. 
-				for(auto& iMonotone : openPolygons)
+				std::fill(output + begin, output + END, Vec3(0.f, 0.f, 0.f));
+				for(const NormalPartition& PARTITION : partitions)
 				{
-					// edge cannot be connected to KNode
-					if(iMonotone.first != IN && iMonotone.first != OUT)
+					const uint32_t FIRST	= std::max(begin, PARTITION.firstVertex);
+					const uint32_t LAST		= std::min(END, PARTITION.firstVertex + PARTITION.span);
+					for(uint32_t vertexID = FIRST; vertexID < LAST; ++vertexID)
 					{
-						const Vec2& EDGE_START	= iMonotone.first.begin(VERTEX_BUFFER);
-						const Vec2& EDGE_END	= iMonotone.first.end(VERTEX_BUFFER);
-
-						//if(right_side(EDGE_START, EDGE_END, iNode.vertex()))
-						{
-							// This is the distance between edge Y coordinate and the TNode at the TNode.x position
-							// note that if distance is negative edge is above TNode.
-							if(auto SIGNED_DISTANCE = signed_Y_distance(EDGE_START, EDGE_END, iNode.vertex()))
-							{
-								const float DISTANCE = abs(SIGNED_DISTANCE.value());
-								if(SIGNED_DISTANCE < 0.f)
-								{
-									if(DISTANCE < aboveDistance)
-									{
-										aboveDistance	= DISTANCE;
-										edgeAbove		= &iMonotone.first;
-									}
-								}
-								else 
-								{
-									if(DISTANCE < belowDistance)
-									{
-										belowDistance	= DISTANCE;
-										edgeBelow		= &iMonotone.first;
-									}
-								}
-							}
-						}	
+						output[vertexID] += PARTITION.sums[vertexID - PARTITION.firstVertex];
 					}
 				}
 
-				if(edgeBelow)
+				for(uint32_t vertexID = begin; vertexID < END; ++vertexID)
 				{
-					if(right_side(edgeBelow->begin(VERTEX_BUFFER), edgeBelow->end(VERTEX_BUFFER), iNode.vertex()))
-						openPolygons[*edgeBelow]->push_back(iNode.vertexID());
-				}
-				if(edgeAbove && (edgeAbove != edgeBelow || edgeBelow == nullptr))
-				{	
-					if(right_side(edgeAbove->begin(VERTEX_BUFFER), edgeAbove->end(VERTEX_BUFFER), iNode.vertex()))
-						openPolygons[*edgeAbove]->push_back(iNode.vertexID());
+					output[vertexID] = normalize_sum(output[vertexID]);
 				}
+			});
+		}
+		pool->wait();
+	}
 
+//=====> TriangleMesh -> optimization
+	namespace
+	{
+		const uint32_t INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
 
-				{auto& pIN	= openPolygons[IN];
-
-					if(pIN == nullptr) pIN = &output.emplace_back();
-					pIN->push_back(iNode.vertexID());
-				}
+		/*
+			Tipsify(Sander et al.): emits triangle fans around vertices, choosing next fanning vertex that stays in the cache.
+		*/
+		std::vector<uint32_t>	tipsify(	const uint32_t*		INDICES,
+											const uint32_t		NUM_INDICES,
+											const uint32_t		NUM_VERTICES,
+											const uint32_t		CACHE_SIZE)
+		{
+			const VertexAdjacency ADJACENCY(INDICES, NUM_INDICES, NUM_VERTICES);
 
-				{auto& pOUT	= openPolygons[OUT];
+			std::vector<uint32_t>	liveTriangles(NUM_VERTICES);
+			std::vector<uint32_t>	cacheTimes(NUM_VERTICES, 0);
+			std::vector<bool>		emitted(NUM_INDICES / 3, false);
+			std::vector<uint32_t>	deadEnds;
+			std::vector<uint32_t>	candidates;
+			std::vector<uint32_t>	output;
+			output.reserve(NUM_INDICES);
 
-					if(pOUT == nullptr) pOUT = &output.emplace_back();
-					pOUT->push_back(iNode.vertexID());
-				}
-		
-				// Close the polygon(remove polygon from the open list).
-				if(iNode.is_IN_end())	openPolygons.erase(IN);
-				if(iNode.is_OUT_end())	openPolygons.erase(OUT);
+			for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+			{
+				liveTriangles[vertexID] = ADJACENCY.offsets[vertexID + 1] - ADJACENCY.offsets[vertexID];
 			}
 
-			if(openPolygons.size() != 0)
-				throw dpl::GeneralException(__FILE__, __LINE__, "Triangulation could not be completed. Number of edges that was not processed: " + std::to_string(openPolygons.size()));
-
-			uint32_t numInvalid = 0;
+			uint32_t time	= CACHE_SIZE + 1;
+			uint32_t cursor	= 0;
 
-			// Erase contours with less than 3 vertices.
-			for(auto iContour = output.begin(); iContour != output.end();)
+			// Most recently used vertex with live triangles, or the next one in the input order.
+			auto skip_dead_end = [&]()
 			{
-				if(iContour->size() < 3)
+				while(!deadEnds.empty())
 				{
-					++numInvalid;
-					iContour = output.erase(iContour);
+					const uint32_t VERTEX_ID = deadEnds.back();
+					deadEnds.pop_back();
+					if(liveTriangles[VERTEX_ID] > 0) return VERTEX_ID;
 				}
-				else
+
+				for(; cursor < NUM_VERTICES; ++cursor)
 				{
-					++iContour;
+					if(liveTriangles[cursor] > 0) return cursor;
 				}
-			}
 
-			if(numInvalid > 0)
+				return INVALID_VERTEX;
+			};
+
+			for(uint32_t fanningVertex = skip_dead_end(); fanningVertex != INVALID_VERTEX;)
 			{
-				int breakpoint = 0;
-			}
+				candidates.clear();
+				for(uint32_t offset = ADJACENCY.offsets[fanningVertex]; offset < ADJACENCY.offsets[fanningVertex + 1]; ++offset)
+				{
+					const uint32_t TRIANGLE_ID = ADJACENCY.triangles[offset];
+					if(emitted[TRIANGLE_ID]) continue;
 
-			return output;
-		}
+					for(uint32_t corner = 0; corner < 3; ++corner)
+					{
+						const uint32_t VERTEX_ID = INDICES[TRIANGLE_ID * 3 + corner];
+						output.push_back(VERTEX_ID);
+						deadEnds.push_back(VERTEX_ID);
+						candidates.push_back(VERTEX_ID);
+						--liveTriangles[VERTEX_ID];
+
+						if(time - cacheTimes[VERTEX_ID] > CACHE_SIZE)
+							cacheTimes[VERTEX_ID] = time++;
+					}
 
-		Triangle			create_triangle(		std::list<OrientedEdge>::iterator	current, 
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER)
-		{
-			Triangle triangle{current->beginID(), current->endID(), (++current)->endID()};
+					emitted[TRIANGLE_ID] = true;
+				}
 
-			if(calculate_winding(triangle.data(), 3, VERTEX_BUFFER) != TARGET_ORIENTATION)
-			{
-				std::swap(triangle[1], triangle[2]);
+				// Prefer candidate that will still be in the cache after its remaining triangles are emitted.
+				fanningVertex = INVALID_VERTEX;
+				int64_t bestPriority = -1;
+				for(const uint32_t VERTEX_ID : candidates)
+				{
+					if(liveTriangles[VERTEX_ID] == 0) continue;
+
+					const int64_t AGE		= int64_t(time) - cacheTimes[VERTEX_ID];
+					const int64_t PRIORITY	= (AGE + 2 * int64_t(liveTriangles[VERTEX_ID]) <= CACHE_SIZE) ? AGE : 0;
+					if(PRIORITY > bestPriority)
+					{
+						bestPriority	= PRIORITY;
+						fanningVertex	= VERTEX_ID;
+					}
+				}
+
+				if(fanningVertex == INVALID_VERTEX)
+					fanningVertex = skip_dead_end();
 			}
 
-			return triangle;
+			return output;
 		}
 
-		void				perform_triangulation(	const Contour&						MONOTONE,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER,
-													Triangles&							output)
+		/*
+			Open addressing hash table of the grid cells, maps cell to the first vertex in the cell.
+			Note: Cells with the same key share the bucket, so vertices from the bucket must be compared anyway.
+		*/
+		class	CellTable
 		{
-			validate_contour(MONOTONE);
+		private: // data
+			std::vector<uint64_t>	m_keys;
+			std::vector<uint32_t>	m_heads;
+			uint64_t				m_mask;
 
-			const uint32_t		NUM_VERTICES	= static_cast<uint32_t>(MONOTONE.size());
-			const Orientation	ORIENTATION		= calculate_winding(MONOTONE.data(), NUM_VERTICES, VERTEX_BUFFER);
+		public: // lifecycle
+			CLASS_CTOR				CellTable(	const uint32_t		NUM_CELLS)
+				: m_keys(std::bit_ceil(std::max<uint64_t>(16, uint64_t(NUM_CELLS) * 2)))
+				, m_heads(m_keys.size(), INVALID_VERTEX)
+				, m_mask(m_keys.size() - 1)
+			{
 
-			std::list<OrientedEdge> openList; // list of edges to process
+			}
 
-			for(uint32_t index = 0; index < NUM_VERTICES; ++index)
+		public: // functions
+			static inline uint64_t	get_key(	const int64_t*		CELL)
 			{
-				openList.emplace_back(MONOTONE[index], MONOTONE[(index+1)%NUM_VERTICES], ORIENTATION);
+				uint64_t key = uint64_t(CELL[0]) * 0x9E3779B97F4A7C15ull ^ uint64_t(CELL[1]) * 0xC2B2AE3D27D4EB4Full ^ uint64_t(CELL[2]) * 0x165667B19E3779F9ull;
+				return key ^ (key >> 29);
 			}
 
-			auto current = openList.begin();
-			
-			while(openList.size() > 3)
+			/*
+				Returns the first vertex in the cell or INVALID_VERTEX.
+			*/
+			inline uint32_t			find(		const uint64_t		KEY) const
 			{
-				auto next = std::next(current);
-
-				while(1)
+				for(uint64_t slot = KEY & m_mask; m_heads[slot] != INVALID_VERTEX; slot = (slot + 1) & m_mask)
 				{
-					const bool bRIGHT = right_side(	current->begin(VERTEX_BUFFER), 
-													current->end(VERTEX_BUFFER), 
-													next->end(VERTEX_BUFFER));
-
-					if(ORIENTATION == Orientation::CW ? !bRIGHT : bRIGHT)
-						current = next++; // based on how monotone polygon was created we will never go out of bounds
-					else
-						break;
+					if(m_keys[slot] == KEY) return m_heads[slot];
 				}
 
-				output.emplace_back(create_triangle(current, TARGET_ORIENTATION, VERTEX_BUFFER));
-
-				/*
-					-> [newCurrent] -> [oldCurrent] -> [oldNext] ->
-							(insert)       (erase[1])     (erase[2])
-				*/
-				current = openList.insert(current, OrientedEdge(current->beginID(), next->endID(), ORIENTATION));
-				openList.erase(openList.erase(std::next(current)));
-
-				// now is an interesting part, if we skip this step, we may generate invalid polygon,
-				// we must try to decrement current iterator in order to combine some previous edge with newly generated one
-				// otherwise we will reach the point in which we have to loop whole triangulation process ...
-				if(current != openList.begin())
-					--current;
+				return INVALID_VERTEX;
 			}
 
-			// Generate last triangle from remaining 3 edges.
-			output.emplace_back(create_triangle(openList.begin(), TARGET_ORIENTATION, VERTEX_BUFFER));
-		}
-
-		Result				execute(				const Contour&						BORDER,
-													const ContourArray&					HOLES,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER)
-		{
-			Result	result;
-					result.triangles.reserve(estimate_numTriangles(BORDER, HOLES));
-					
-			contour_to_TNodes(BORDER, Orientation::CW, VERTEX_BUFFER, result.nodes);
-			for (auto& iHole : HOLES)
+			/*
+				Returns the first vertex in the cell(INVALID_VERTEX if cell was empty).
+			*/
+			inline uint32_t&		insert(		const uint64_t		KEY)
 			{
-				contour_to_TNodes(iHole, Orientation::CCW, VERTEX_BUFFER, result.nodes);
-			}
+				uint64_t slot = KEY & m_mask;
+				while(m_heads[slot] != INVALID_VERTEX && m_keys[slot] != KEY)
+				{
+					slot = (slot + 1) & m_mask;
+				}
 
-			auto monotones = TNodes_to_monotones(result.nodes, VERTEX_BUFFER);
-			for(auto& iMonotone : monotones)
-			{
-				perform_triangulation(iMonotone, TARGET_ORIENTATION, VERTEX_BUFFER, result.triangles);
+				m_keys[slot] = KEY;
+				return m_heads[slot];
 			}
-
-			return result;
-		}
+		};
 	}
 
-	namespace Triangulation2
+	TriangleMesh::Statistics	TriangleMesh::calculate_statistics(	const uint32_t	CACHE_SIZE) const
 	{
-		Orientation			calculate_winding(		const uint32_t*						CONTOUR,
-													const uint64_t						CONTOUR_SIZE,
-													const Vec2*							VERTEX_BUFFER)
-		{
-			float signedArea = 0.f;
+		const uint32_t LINE_SIZE	= 64;
+		const uint32_t VERTEX_SIZE	= sizeof(Vec3);
 
-			for(uint64_t i = CONTOUR_SIZE -1, j = 0; j < CONTOUR_SIZE; i = j++)
-			{
-				const auto& FIRST_VERTEX	= VERTEX_BUFFER[CONTOUR[i]];
-				const auto& SECOND_VERTEX	= VERTEX_BUFFER[CONTOUR[j]];
+		Statistics result;
+		result.numVertices	= get_numVertices();
+		result.numTriangles	= get_numIndices() / 3;
+		result.vertexBytes	= uint64_t(get_numVertices()) * VERTEX_SIZE;
+		result.indexBytes	= uint64_t(get_numIndices()) * ((get_numVertices() <= 0x10000) ? sizeof(uint16_t) : sizeof(uint32_t));
 
-				signedArea += FIRST_VERTEX.x * SECOND_VERTEX.y - SECOND_VERTEX.x * FIRST_VERTEX.y;
-			}
+		if(result.numTriangles == 0 || result.numVertices == 0)
+			return result;
 
-			return signedArea < 0.f ? Orientation::CW : Orientation::CCW;
-		}
+		// Entry is in the FIFO cache if less than CACHE_SIZE entries were added after it.
+		std::vector<uint32_t> vertexTimes(get_numVertices(), 0);
+		std::vector<uint32_t> lineTimes((result.vertexBytes + LINE_SIZE - 1) / LINE_SIZE, 0);
+		uint32_t vertexTime		= CACHE_SIZE + 1;
+		uint32_t lineTime		= FETCH_CACHE_LINES + 1;
+		uint64_t numTransformed	= 0;
+		uint64_t numFetched		= 0;
 
-		void				contour_to_edges(		const Contour&						CONTOUR,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER,
-													SortedEdges&						edges)
+		for(const uint32_t VERTEX_ID : indices())
 		{
-			validate_contour(CONTOUR);
-
-			const uint32_t		NUM_VERTICES	= static_cast<uint32_t>(CONTOUR.size());
-			const Orientation	ORIENTATION		= calculate_winding(CONTOUR.data(), NUM_VERTICES, VERTEX_BUFFER);
-
-			for (uint32_t i = NUM_VERTICES - 1, j = 0; j < NUM_VERTICES; i = j++)
-			{			
-				uint32_t	beginID	= CONTOUR.at(i);
-				uint32_t	endID	= CONTOUR.at(j);
+			if(vertexTime - vertexTimes[VERTEX_ID] <= CACHE_SIZE)
+				continue;
 
-				if(ORIENTATION != TARGET_ORIENTATION) std::swap(beginID, endID);
+			vertexTimes[VERTEX_ID] = vertexTime++;
+			++numTransformed;
 
-				auto result = edges.emplace(OrientedEdge(beginID, endID, TARGET_ORIENTATION, VERTEX_BUFFER), nullptr);
-				if(result.second == false)
-					throw dpl::GeneralException(__FILE__, __LINE__, "No two, arbitrary vertices of the polygon and its holes can share the same X and Y coordinate.");
+			const uint64_t FIRST_BYTE = uint64_t(VERTEX_ID) * VERTEX_SIZE;
+			for(uint64_t lineID = FIRST_BYTE / LINE_SIZE; lineID <= (FIRST_BYTE + VERTEX_SIZE - 1) / LINE_SIZE; ++lineID)
+			{
+				if(lineTime - lineTimes[lineID] > FETCH_CACHE_LINES)
+				{
+					lineTimes[lineID] = lineTime++;
+					++numFetched;
+				}
 			}
 		}
 
-		Triangle			create_triangle(		std::list<OrientedEdge>::iterator	current, 
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER)
-		{
-			Triangle triangle{current->beginID(), current->endID(), (++current)->endID()};
+		result.ACMR			= float(double(numTransformed) / result.numTriangles);
+		result.ATVR			= float(double(numTransformed) / result.numVertices);
+		result.overfetch	= float(double(numFetched * LINE_SIZE) / result.vertexBytes);
+		return result;
+	}
 
-			if(calculate_winding(triangle.data(), 3, VERTEX_BUFFER) != TARGET_ORIENTATION)
-			{
-				std::swap(triangle[1], triangle[2]);
-			}
+	TriangleMesh::OptimizationReport	TriangleMesh::weld_vertices(	const float		TOLERANCE)
+	{
+		validate_indices();
 
-			return triangle;
-		}
+		OptimizationReport report;
+		report.before = calculate_statistics();
 
-		void				perform_triangulation(	const Contour&						MONOTONE,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER,
-													Triangles&							output)
-		{
-			validate_contour(MONOTONE);
+		const uint32_t	NUM_VERTICES	= get_numVertices();
+		const float		DISTANCE		= std::max(TOLERANCE, 0.f);
+		const float		CELL_SIZE		= (DISTANCE > 0.f) ? 2.f * DISTANCE : 1.f; // Vertex is closer than DISTANCE to at most one side of the cell per axis.
+		const float		MAX_DISTANCE2	= DISTANCE * DISTANCE;
 
-			const uint32_t		NUM_VERTICES	= static_cast<uint32_t>(MONOTONE.size());
-			const Orientation	ORIENTATION		= calculate_winding(MONOTONE.data(), NUM_VERTICES, VERTEX_BUFFER);
+		// Hash grid of the unique vertices, vertices in the same bucket are linked.
+		CellTable				buckets(NUM_VERTICES);
+		std::vector<uint32_t>	nextInBucket;
+		std::vector<uint32_t>	remap(NUM_VERTICES);
+		Vertices				unique;
+		nextInBucket.reserve(NUM_VERTICES);
+		unique.reserve(NUM_VERTICES);
 
-			std::list<OrientedEdge> openList; // list of edges to process
+		for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+		{
+			const Vec3& VERTEX = vertices()[vertexID];
 
-			for(uint32_t index = 0; index < NUM_VERTICES; ++index)
+			int64_t cell[3];
+			int64_t neighbour[3]; // Offset of the neighbouring cell that may contain vertices within DISTANCE(or 0).
+			for(uint32_t axis = 0; axis < 3; ++axis)
 			{
-				openList.emplace_back(MONOTONE[index], MONOTONE[(index+1)%NUM_VERTICES], ORIENTATION, VERTEX_BUFFER);
+				const float SCALED	= VERTEX[axis] / CELL_SIZE;
+				cell[axis]			= static_cast<int64_t>(std::floor(SCALED));
+
+				const float OFFSET	= (SCALED - std::floor(SCALED)) * CELL_SIZE;
+				neighbour[axis]		= (DISTANCE == 0.f) ? 0 : (OFFSET <= DISTANCE) ? -1 : (CELL_SIZE - OFFSET <= DISTANCE) ? 1 : 0;
 			}
 
-			auto current = openList.begin();
-			
-			while(openList.size() > 3)
+			uint32_t match = INVALID_VERTEX;
+			for(uint32_t corner = 0; corner < 8 && match == INVALID_VERTEX; ++corner)
 			{
-				auto next = std::next(current);
+				if(((corner & 1) && !neighbour[0]) || ((corner & 2) && !neighbour[1]) || ((corner & 4) && !neighbour[2])) continue;
 
-				while(1)
-				{
-					const bool bRIGHT = right_side(	current->begin(), 
-													current->end(), 
-													next->end());
+				const int64_t CELL[3] = {	cell[0] + ((corner & 1) ? neighbour[0] : 0),
+											cell[1] + ((corner & 2) ? neighbour[1] : 0),
+											cell[2] + ((corner & 4) ? neighbour[2] : 0)};
 
-					if(ORIENTATION == Orientation::CW ? !bRIGHT : bRIGHT)
-						current = next++; // based on how monotone polygon was created we will never go out of bounds
-					else
+				for(uint32_t uniqueID = buckets.find(CellTable::get_key(CELL)); uniqueID != INVALID_VERTEX; uniqueID = nextInBucket[uniqueID])
+				{
+					const Vec3 OFFSET = unique[uniqueID] - VERTEX;
+					if(glm::dot(OFFSET, OFFSET) <= MAX_DISTANCE2)
+					{
+						match = uniqueID;
 						break;
+					}
 				}
+			}
 
-				output.emplace_back(create_triangle(current, TARGET_ORIENTATION, VERTEX_BUFFER));
-
-				/*
-					-> [newCurrent] -> [oldCurrent] -> [oldNext] ->
-							(insert)       (erase[1])     (erase[2])
-				*/
-				current = openList.insert(current, OrientedEdge(current->beginID(), next->endID(), ORIENTATION, VERTEX_BUFFER));
-				openList.erase(openList.erase(std::next(current)));
+			if(match == INVALID_VERTEX)
+			{
+				match = static_cast<uint32_t>(unique.size());
+				unique.push_back(VERTEX);
 
-				// now is an interesting part, if we skip this step, we may generate invalid polygon,
-				// we must try to decrement current iterator in order to combine some previous edge with newly generated one
-				// otherwise we will reach the point in which we have to loop whole triangulation process ...
-				if(current != openList.begin())
-					--current;
+				uint32_t& head = buckets.insert(CellTable::get_key(cell));
+				nextInBucket.push_back(head);
+				head = match;
 			}
 
-			// Generate last triangle from remaining 3 edges.
-			output.emplace_back(create_triangle(openList.begin(), TARGET_ORIENTATION, VERTEX_BUFFER));
+			remap[vertexID] = match;
 		}
 
-		Triangles			execute(				const Contour&						BORDER,
-													const ContourArray&					HOLES,
-													const Orientation					TARGET_ORIENTATION,
-													const Vec2*							VERTEX_BUFFER)
+		// Remap indices and remove collapsed triangles.
+		uint32_t numIndices = 0;
+		for(uint32_t offset = 0; offset < get_numIndices(); offset += 3)
 		{
-			Triangles	triangles;
-						triangles.reserve(estimate_numTriangles(BORDER, HOLES));
-
-			SortedEdges	edges;
-					
-			contour_to_edges(BORDER, Orientation::CW, VERTEX_BUFFER, edges);
-			for (auto& iHole : HOLES)
-			{
-				contour_to_edges(iHole, Orientation::CCW, VERTEX_BUFFER, edges);
-			}
+			const uint32_t A = remap[indices()[offset + 0]];
+			const uint32_t B = remap[indices()[offset + 1]];
+			const uint32_t C = remap[indices()[offset + 2]];
+			if(A == B || B == C || C == A) continue;
+
+			(*indices)[numIndices++] = A;
+			(*indices)[numIndices++] = B;
+			(*indices)[numIndices++] = C;
+		}
 
-			Intersections	intersections;
-							intersections.reserve(edges.size());
+		indices->resize(numIndices);
+		vertices = std::move(unique);
 
-			// Find all unique X coordinates.
-			for(auto& iEdge : edges) intersections[iEdge.first.begin().x];
+		report.after = calculate_statistics();
+		return report;
+	}
 
-			// Find all intersections(O(n^2), very slow).
-			for(auto iEdge = edges.begin(); iEdge != edges.end(); ++iEdge)
-			{
-				const Vec2& BEGIN	= iEdge->first.begin();
-				const Vec2& END		= iEdge->first.end();
+	TriangleMesh::OptimizationReport	TriangleMesh::optimize_vertex_cache(	const uint32_t	CACHE_SIZE)
+	{
+		validate_indices();
 
-				const float MIN = glm::min(BEGIN.x, END.x);
-				const float MAX = glm::max(BEGIN.x, END.x);
+		OptimizationReport report;
+		report.before = calculate_statistics(CACHE_SIZE);
 
-				for(auto& iIntersection : intersections)
-				{
-					if(MIN <= iIntersection.first 
-					&& MAX >= iIntersection.first)
-					{
-						iIntersection.second.push_back(iEdge);
-					}
-				}
-			}
+		indices = tipsify(indices().data(), get_numIndices(), get_numVertices(), CACHE_SIZE);
 
-			for(auto it = edges.begin(); it != edges.end(); ++it)
-			{
-				const uint32_t	VERTEX_ID	= it->first.beginID();
-				const Vec2&		VERTEX		= it->first.begin();
-
-				// Distance to closest edge above the node.
-				SortedEdges::iterator	edgeAbove		= edges.end();
-				float					distanceAbove	= std::numeric_limits<float>::max();
-				float					dotAbove		= -1.f;
-
-				// Distance to closest edge below the node.
-				SortedEdges::iterator	edgeBelow		= edges.end();
-				float					distanceBelow	= std::numeric_limits<float>::max();
-				float					dotBelow		= -1.f;
-
-				// Find closest edges.
-				const auto& POTENTIAL_MONOTONES = intersections[VERTEX.x];
-				for(auto& iBASE : POTENTIAL_MONOTONES)
-				{
-					if(iBASE->first.point_between(VERTEX))
-					{
-						const Vec2& EDGE_START	= iBASE->first.begin();
-						const Vec2& EDGE_END	= iBASE->first.end();
+		report.after = calculate_statistics(CACHE_SIZE);
+		return report;
+	}
 
-						if(auto SIGNED_DISTANCE = signed_Y_distance(EDGE_START, EDGE_END, VERTEX))
-						{
-							const float DISTANCE = abs(SIGNED_DISTANCE.value());
-
-							if(SIGNED_DISTANCE < 0.f && DISTANCE < distanceAbove)
-							{
-								const float DOT = glm::dot(Vec2(0.f, -1.f), EDGE_START-EDGE_END);
-
-								if(DISTANCE < distanceAbove)
-								{
-									distanceAbove	= DISTANCE;
-									dotAbove		= DOT;
-									edgeAbove		= iBASE;
-								}
-								else if(DISTANCE == distanceAbove)
-								{
-									if(DOT > dotAbove)
-									{
-										distanceAbove	= DISTANCE;
-										dotAbove		= DOT;
-										edgeAbove		= iBASE;
-									}
-								}
-							}
-							else if(SIGNED_DISTANCE >= 0.f) 
-							{
-								const float DOT = glm::dot(Vec2(0.f, 1.f), EDGE_START-EDGE_END);
-
-								if(DISTANCE < distanceBelow)
-								{
-									distanceBelow	= DISTANCE;
-									dotBelow		= DOT;
-									edgeBelow		= iBASE;
-								}
-								if(DISTANCE == distanceBelow)
-								{
-									if(DOT > dotBelow)
-									{
-										distanceBelow	= DISTANCE;
-										dotBelow		= DOT;
-										edgeBelow		= iBASE;
-									}
-								}
-							}
-						}
-					}
-				}
+	TriangleMesh::OptimizationReport	TriangleMesh::optimize_vertex_fetch()
+	{
+		validate_indices();
 
-				if(edgeBelow != edges.end())
-				{
-					const Vec2& EDGE_START	= edgeBelow->first.begin();
-					const Vec2& EDGE_END	= edgeBelow->first.end();
+		OptimizationReport report;
+		report.before = calculate_statistics();
 
-					if(right_side(EDGE_START, EDGE_END, VERTEX))
-					{
-						auto& monotone = edgeBelow->second;
-						if(!monotone)
-						{
-							monotone = std::make_unique<Contour>();
-							monotone->push_back(edgeBelow->first.get_monotone_beginID());
-						}
+		const uint32_t			NUM_VERTICES = get_numVertices();
+		std::vector<uint32_t>	remap(NUM_VERTICES, INVALID_VERTEX);
+		uint32_t				numUsed = 0;
 
-						monotone->push_back(VERTEX_ID);
-					}
-				}
-				if((edgeAbove != edges.end()) && (edgeAbove != edgeBelow || edgeBelow == edges.end()))
-				{	
-					const Vec2& EDGE_START	= edgeAbove->first.begin();
-					const Vec2& EDGE_END	= edgeAbove->first.end();
+		for(uint32_t& index : *indices)
+		{
+			if(remap[index] == INVALID_VERTEX)
+				remap[index] = numUsed++;
 
-					if(right_side(EDGE_START, EDGE_END, VERTEX))
-					{
-						auto& monotone = edgeAbove->second;
-						if(!monotone)
-						{
-							monotone = std::make_unique<Contour>();
-							monotone->push_back(edgeAbove->first.get_monotone_beginID());
-						}
+			index = remap[index];
+		}
 
-						monotone->push_back(VERTEX_ID);
-					}
-				}			
-			}
+		Vertices reordered(NUM_VERTICES);
+		for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+		{
+			if(remap[vertexID] == INVALID_VERTEX)
+				remap[vertexID] = numUsed++;
 
-			// Erase contours with less than 3 vertices.
-			for(auto& it : edges)
-			{
-				if(it.second)
-				{
-					if(it.second->size() < 2)
-					{
-						it.second.reset();
-					}
-					else // Close monotone and go to the next.
-					{
-						const auto& EDGE = it.first;
-						it.second->push_back(EDGE.get_monotone_endID());
+			reordered[remap[vertexID]] = vertices()[vertexID];
+		}
 
-						perform_triangulation(*it.second, TARGET_ORIENTATION, VERTEX_BUFFER, triangles);
-					}
-				}
-			}
+		vertices = std::move(reordered);
 
-			return triangles;
-		}
+		report.after = calculate_statistics();
+		return report;
 	}
 
-	void						fill(			std::vector<p2t::Point>&	output,
-												const std::vector<Vec2>&	POLYGON,
-												const Orientation			TARGET_ORIENTATION)
+	TriangleMesh::OptimizationReport	TriangleMesh::optimize(	const float		WELD_TOLERANCE,
+																const uint32_t	CACHE_SIZE)
 	{
-		output.reserve(output.size() + POLYGON.size());
+		OptimizationReport report;
+		report.before = calculate_statistics(CACHE_SIZE);
 
-		const uint32_t		NUM_POINTS	= static_cast<uint32_t>(POLYGON.size());
-		const Orientation	ORIENTATION = calculate_polygon_orientation(POLYGON.data(), NUM_POINTS);
+		weld_vertices(WELD_TOLERANCE);
+		optimize_vertex_cache(CACHE_SIZE);
+		optimize_vertex_fetch();
 
-		if(ORIENTATION == TARGET_ORIENTATION)
-		{
-			for(auto& iVertex : POLYGON)
-			{
-				output.emplace_back(iVertex.x, iVertex.y);
-			}
-		}
-		else // Inverse
-		{
-			for(uint32_t index = 0; index < NUM_POINTS;++index)
-			{
-				const auto& VERTEX = POLYGON[NUM_POINTS-1-index];
-				output.emplace_back(VERTEX.x, VERTEX.y);
-			}
-		}
+		report.after = calculate_statistics(CACHE_SIZE);
+		return report;
 	}
 
-	std::vector<p2t::Point*>	to_contour(		std::vector<p2t::Point>&	vertices,
-												const uint64_t				BEGIN,
-												const uint64_t				END)
+	bool		TriangleMesh::get_16bit_indices(	std::vector<uint16_t>&	output) const
 	{
-		std::vector<p2t::Point*>	contour;
-									contour.reserve(END-BEGIN);
+		if(get_numVertices() > 0x10000)
+			return false;
 
-		for(uint64_t index = BEGIN; index < END; ++index)
+		output.resize(get_numIndices());
+		for(uint32_t offset = 0; offset < get_numIndices(); ++offset)
 		{
-			contour.push_back(&vertices[index]);
+			output[offset] = static_cast<uint16_t>(indices()[offset]);
 		}
 
-		return contour;
+		return true;
 	}
 
-//=====> TriangleMesh -> public functions
-	void		TriangleMesh::triangulate(		const CoordinateSystem& RPS,
-												const uint32_t			X_2D_INDEX,
-												const uint32_t			Y_2D_INDEX,
-												const Vertices2D&		BORDER_POLYGON,
-												const Vertices2DArray&	HOLE_POLYGONS,
-												const Orientation		TARGET_ORIENTATION)
+//=====> TriangleMesh -> private functions
+	void		TriangleMesh::triangulate_delaunay(	const Vertices2D&		BORDER_POLYGON,
+													const Vertices2DArray&	HOLE_POLYGONS,
+													const Orientation		TARGET_ORIENTATION,
+													Vertices2D&				vertices2D)
 	{
-		std::vector<p2t::Point>	vertices2D;
+		std::vector<p2t::Point>	points;
 		
-		fill(vertices2D, BORDER_POLYGON, Orientation::CW);
+		fill(points, BORDER_POLYGON, Orientation::CW);
 
 		for(auto& iHole : HOLE_POLYGONS)
 		{
-			fill(vertices2D, *iHole, Orientation::CW);
+			fill(points, *iHole, Orientation::CW);
 		}
 
-		p2t::CDT cdt(to_contour(vertices2D, 0, BORDER_POLYGON.size()));
+		p2t::CDT cdt(to_contour(points, 0, BORDER_POLYGON.size()));
 
 		uint64_t offset = BORDER_POLYGON.size();
 		for(auto& iHole : HOLE_POLYGONS)
 		{
-			cdt.AddHole(to_contour(vertices2D, offset, offset + iHole->size()));
+			cdt.AddHole(to_contour(points, offset, offset + iHole->size()));
 			offset += iHole->size();
 		}
 
 		cdt.Triangulate();
-		
-		// Transform 2D vertices into 3D RPS space.
-		vertices = Vertices(vertices2D.size());
-		for(uint64_t vertexID = 0; vertexID < vertices2D.size(); ++vertexID)
+
+		vertices2D.resize(points.size());
+		for(uint64_t vertexID = 0; vertexID < points.size(); ++vertexID)
 		{
-			const auto& p2tPoint = vertices2D[vertexID];
-			const Vec2 VERTEX_2D(p2tPoint.x, p2tPoint.y);
-			(*vertices)[vertexID] = RPS.unproject_point(VERTEX_2D, X_2D_INDEX, Y_2D_INDEX);;
+			vertices2D[vertexID] = Vec2(points[vertexID].x, points[vertexID].y);
 		}
 
 		const auto TRIANGLES = cdt.GetTriangles();
@@ -1056,7 +1307,11 @@ namespace cml
 		indices->clear();
 		indices->reserve(TRIANGLES.size() * 3);
 
-		const auto* ARRAY_START = reinterpret_cast<const p2t::Point*>(vertices2D.data());
+		const auto* ARRAY_START = reinterpret_cast<const p2t::Point*>(points.data());
+
+		// poly2tri triangles are counter-clockwise in the XY axes, which is CW for calculate_polygon_orientation.
+		const uint32_t SECOND = (TARGET_ORIENTATION == Orientation::CCW) ? 2 : 1;
+		const uint32_t THIRD	= 3 - SECOND;
 
 		for(uint64_t triangleID = 0; triangleID < TRIANGLES.size(); ++triangleID)
 		{
@@ -1064,101 +1319,114 @@ namespace cml
 
 			if(TRIANGLE->IsInterior())
 			{
-				const uint64_t OFFSET = triangleID * 3;
-
 				indices->push_back(static_cast<uint32_t>(TRIANGLE->GetPoint(0) - ARRAY_START));
-				indices->push_back(static_cast<uint32_t>(TRIANGLE->GetPoint(1) - ARRAY_START));
-				indices->push_back(static_cast<uint32_t>(TRIANGLE->GetPoint(2) - ARRAY_START));
+				indices->push_back(static_cast<uint32_t>(TRIANGLE->GetPoint(SECOND) - ARRAY_START));
+				indices->push_back(static_cast<uint32_t>(TRIANGLE->GetPoint(THIRD) - ARRAY_START));
 			}
-			else
-			{
-				int breakpoint = 0;
-			}
-		}
-	}
-
-	void		TriangleMesh::validate_index_count() const
-	{
-		if(get_numIndices() % 3 != 0)
-			throw dpl::GeneralException(this, __LINE__, "Number of indices must be divisible by 3.");
-	}
-
-	void		TriangleMesh::validate_indices() const
-	{
-		validate_index_count();
-
-		const uint32_t NUM_VERTICES = get_numVertices();
-		for(auto& index : indices())
-		{
-			if(index >= NUM_VERTICES)
-				throw dpl::GeneralException(this, __LINE__, "TriangleMesh contains at least one invalid index.");
 		}
 	}
 
-	void		TriangleMesh::extend(			const TriangleMesh&		OTHER,
-												const Mat4&				OTHER_TRANSFORMATION)
+	void		TriangleMesh::triangulate_monotone(	const Vertices2D&		BORDER_POLYGON,
+													const Vertices2DArray&	HOLE_POLYGONS,
+													const Orientation		TARGET_ORIENTATION,
+													dpl::ThreadPool*		pool,
+													Vertices2D&				vertices2D)
 	{
-		vertices->reserve(get_numVertices() + OTHER.get_numVertices());
-		indices->reserve(get_numIndices() + OTHER.get_numIndices());
-
-		const uint32_t VERTEX_OFFSET = get_numVertices();
-
-		for(auto& OTHER_VERTEX : OTHER.vertices())
+		uint64_t numVertices = BORDER_POLYGON.size();
+		for(auto& iHole : HOLE_POLYGONS)
 		{
-			vertices->push_back(OTHER_TRANSFORMATION * Vec4(OTHER_VERTEX, 1.f));
+			numVertices += iHole->size();
 		}
 
-		for(auto& OTHER_INDEX : OTHER.indices())
+		vertices2D.clear();
+		vertices2D.reserve(numVertices);
+		vertices2D.insert(vertices2D.end(), BORDER_POLYGON.begin(), BORDER_POLYGON.end());
+		for(auto& iHole : HOLE_POLYGONS)
 		{
-			indices->push_back(OTHER_INDEX + VERTEX_OFFSET);
+			vertices2D.insert(vertices2D.end(), iHole->begin(), iHole->end());
 		}
-	}
-
-	void		TriangleMesh::flip()
-	{
-		validate_index_count();
 
-		const uint32_t NUM_TRIANGLES = get_numIndices() / 3;
+		Triangulation::MonotoneTriangulator triangulator(vertices2D.data(), static_cast<uint32_t>(numVertices));
+		triangulator.add_contour(0, static_cast<uint32_t>(BORDER_POLYGON.size()), false);
 
-		// Swap second and third vertex index of each triangle.
-		for(uint32_t triangleID = 0; triangleID < NUM_TRIANGLES; ++triangleID)
+		uint32_t offset = static_cast<uint32_t>(BORDER_POLYGON.size());
+		for(auto& iHole : HOLE_POLYGONS)
 		{
-			const uint32_t OFFSET = triangleID * 3;
-			std::swap((*indices)[OFFSET+1], (*indices)[OFFSET+2]);
+			triangulator.add_contour(offset, static_cast<uint32_t>(iHole->size()), true);
+			offset += static_cast<uint32_t>(iHole->size());
 		}
+
+		const uint32_t NUM_TRIANGLES = triangulator.split_into_monotones();
+		indices->resize(NUM_TRIANGLES * 3);
+		triangulator.triangulate_monotones(TARGET_ORIENTATION, pool, indices->data());
 	}
 
-	void		TriangleMesh::generate_normals(	Vec3*					output) const
+	void		TriangleMesh::generate_normals_by_adjacency(	Vec3*					output,
+																const NormalWeighting	WEIGHTING,
+																dpl::ThreadPool&		pool) const
 	{
-		validate_indices();
+		const uint32_t	NUM_VERTICES	= get_numVertices();
+		const uint32_t	NUM_INDICES		= get_numIndices();
+		const uint32_t	NUM_TRIANGLES	= NUM_INDICES / 3;
+		const Vec3*		VERTICES		= vertices().data();
+		const uint32_t*	INDICES			= indices().data();
+		const bool		bANGLE			= WEIGHTING == NormalWeighting::ANGLE;
 
-		const uint32_t NUM_VERTICES		= get_numVertices();
-		const uint32_t NUM_TRIANGLES	= get_numIndices() / 3;
+		/*
+			Normals(and corner weights) are stored per triangle, then each vertex gathers its adjacent triangles in their order,
+			so no memory depends on the spread of the indices and the sums are the same as in the serial loop.
+		*/
+		std::vector<Vec3>				normals(NUM_TRIANGLES);
+		std::vector<Vec3>				weights(bANGLE? NUM_TRIANGLES : 0);
+		std::unique_ptr<VertexAdjacency> adjacency;
 
-		for(uint32_t triangleID = 0; triangleID < NUM_TRIANGLES; ++triangleID)
+		pool.add_task([&]()
 		{
-			const uint32_t OFFSET = triangleID * 3;
-			const uint32_t AID = indices()[OFFSET+0];
-			const uint32_t BID = indices()[OFFSET+1];
-			const uint32_t CID = indices()[OFFSET+2];
-
-			auto& A = vertices()[AID];
-			auto& B = vertices()[BID];
-			auto& C = vertices()[CID];
-
-			const Vec3 AB	= glm::normalize(B-A);
-			const Vec3 AC	= glm::normalize(C-A);
-			const Vec3 N	= glm::normalize(glm::cross(AB, AC));
+			adjacency = std::make_unique<VertexAdjacency>(INDICES, NUM_INDICES, NUM_VERTICES);
+		});
 
-			output[AID] += N;
-			output[BID] += N;
-			output[CID] += N;
+		for(uint32_t begin = 0; begin < NUM_TRIANGLES; begin += NORMALS_CHUNK_SIZE)
+		{
+			const uint32_t END = std::min(begin + NORMALS_CHUNK_SIZE, NUM_TRIANGLES);
+			pool.add_task([&, begin, END]()
+			{
+				compute_normals(VERTICES, INDICES, begin, END, WEIGHTING, [&](const uint32_t TRIANGLE_ID, const Vec3& N, const Vec3& WEIGHTS)
+				{
+					normals[TRIANGLE_ID] = N;
+					if(bANGLE) weights[TRIANGLE_ID] = WEIGHTS;
+				});
+			});
 		}
+		pool.wait();
 
-		for(uint32_t vertexID = 0; vertexID < NUM_VERTICES; ++vertexID)
+		for(uint32_t begin = 0; begin < NUM_VERTICES; begin += NORMALS_CHUNK_SIZE)
 		{
-			auto&	normal = output[vertexID];
-					normal = glm::normalize(normal);
+			const uint32_t END = std::min(begin + NORMALS_CHUNK_SIZE, NUM_VERTICES);
+			pool.add_task([&, begin, END]()
+			{
+				const VertexAdjacency& ADJACENCY = *adjacency;
+				for(uint32_t vertexID = begin; vertexID < END; ++vertexID)
+				{
+					Vec3 sum(0.f, 0.f, 0.f);
+					for(uint32_t entry = ADJACENCY.offsets[vertexID]; entry < ADJACENCY.offsets[vertexID + 1]; ++entry)
+					{
+						const uint32_t TRIANGLE_ID = ADJACENCY.triangles[entry];
+						if(!bANGLE)
+						{
+							sum += normals[TRIANGLE_ID];
+							continue;
+						}
+
+						// Triangle that references the vertex twice is degenerate(zero normal), so the first corner is enough.
+						const uint32_t* TRIANGLE	= &INDICES[TRIANGLE_ID * 3];
+						const Vec3&		WEIGHTS		= weights[TRIANGLE_ID];
+						const float		WEIGHT		= (TRIANGLE[0] == vertexID)? WEIGHTS.x : (TRIANGLE[1] == vertexID)? WEIGHTS.y : WEIGHTS.z;
+						sum += normals[TRIANGLE_ID] * WEIGHT;
+					}
+					output[vertexID] = normalize_sum(sum);
+				}
+			});
 		}
+		pool.wait();
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "complex_Systems.h"
 #include "complex_StateMachine.h"
 #include "complex_TimeManager.h"
+#include "complex_FramePipeline.h"
 
 // OBSOLETE
 #include <dpl_EventDispatcher.h>
@@ -78,7 +79,8 @@ namespace complex
 			WORKING,
 			INSTALLED,	// All systems and components are installed.
 			STARTED,	// Application was initialized and has now entered the main loop.
-			SHUTDOWN	// User confirmed that he wants to exit the application.
+			SHUTDOWN,	// User confirmed that he wants to exit the application.
+			PIPELINED	// Systems simulate the next frame while the frame renderer presents the previous one.
 		};
 
 		using	Cycle = uint64_t;
@@ -95,6 +97,9 @@ namespace complex
 		//dpl::ResourceManager										resources;
 		mutable dpl::EventDispatcher								dispatcher;
 
+	private: // data
+		FramePipeline												m_framePipeline;
+
 	public: // system functions
 		using SingletonBase::ref;
 		using SingletonBase::ptr;
@@ -128,6 +133,19 @@ namespace complex
 			main_loop()? shutdown() : terminate();
 		}
 
+		/*
+			In pipelined mode systems are updated on the simulation thread, while the frame renderer presents the previous frame
+			from the data copied by the frame extractors(see FramePipeline). Main window is updated after the sync point.
+			Throws if the frame pipeline has no renderer or extractors.
+			Note: Systems must not use GL or ImGui in pipelined mode(they are not updated on the main thread).
+		*/
+		void				enable_pipelined_frames(	const bool						bENABLE);
+
+		inline FramePipeline&	get_frame_pipeline()
+		{
+			return m_framePipeline;
+		}
+
 		/*
 			Ignore current state and shutdown the application.
 		*/
@@ -157,6 +175,10 @@ namespace complex
 
 		bool				main_loop();
 
+		void				update_serial_frame();
+
+		void				update_pipelined_frame();
+
 		void				shutdown();
 
 		void				terminate();
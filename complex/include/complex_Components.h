@@ -2,9 +2,12 @@
 
 
 #include <tuple>
+#include <span>
+#include <algorithm>
 #include <dpl_NamedType.h>
 #include <dpl_TypeTraits.h>
 #include <dpl_DataTransfer.h>
+#include <dpl_ThreadPool.h>
 #include "complex_Utilities.h"
 
 
@@ -102,6 +105,21 @@ namespace complex
 				else							return MyStorageBase::data();
 			}
 
+			/*
+				Modify components in range [BEGIN, END), only this range is transferred.
+			*/
+			inline T*			modify_range(		const uint32_t			BEGIN,
+													const uint32_t			END)
+			{
+				if constexpr(IS_TRANSFERABLE)	return MyStorageBase::modify_range(BEGIN, END);
+				else							return MyStorageBase::data() + BEGIN;
+			}
+
+			inline T&			modify_at(			const uint32_t			COLUMN_INDEX)
+			{
+				return *modify_range(COLUMN_INDEX, COLUMN_INDEX + 1);
+			}
+
 			inline void			modify_each(		const Invocation&		INVOKE)
 			{
 				if constexpr(IS_TRANSFERABLE)	return MyStorageBase::modify_each(INVOKE);
@@ -139,10 +157,116 @@ namespace complex
 			{
 				MyStorageBase::fast_erase(COLUMN_INDEX);
 			}
+
+			inline void			import_from(		std::istream&			binary)
+			{
+				MyStorageBase::import_from(binary);
+			}
+
+			inline bool			import_from(		dpl::ByteReader&		bytes)
+			{
+				return MyStorageBase::import_from(bytes);
+			}
+
+			inline void			export_to(			std::ostream&			binary) const
+			{
+				MyStorageBase::export_to(binary);
+			}
 		};
 
 		using	Rows			= std::tuple<Row<ComponentTn>...>;
 
+		/*
+			Contiguous arrays of the selected component types(const types are read only).
+			Loops over the view use raw pointers, so they can be vectorized by the compiler.
+			Note: View is invalidated when columns are added or removed.
+		*/
+		template<typename... Ts>
+		class	View
+		{
+		public: // friends
+			friend	ComponentTable;
+
+		private: // data
+			std::tuple<Ts*...>	m_data;
+			uint32_t			m_size;
+
+		private: // lifecycle
+			CLASS_CTOR					View(				const uint32_t			SIZE,
+															Ts*...					data)
+				: m_data(data...)
+				, m_size(SIZE)
+			{
+
+			}
+
+		public: // functions
+			inline uint32_t				size() const
+			{
+				return m_size;
+			}
+
+			template<dpl::is_one_of<dpl::TypeList<Ts...>> T>
+			inline std::span<T>			span() const
+			{
+				return std::span<T>(std::get<T*>(m_data), m_size);
+			}
+
+			/*
+				Calls function(Ts&...) for each column.
+			*/
+			template<typename FunctionT>
+			inline void					for_each(			FunctionT&&				function) const
+			{
+				for_range(0, m_size, function);
+			}
+
+			/*
+				Calls function(Ts&...) for columns in range [BEGIN, END).
+			*/
+			template<typename FunctionT>
+			inline void					for_range(			const uint32_t			BEGIN,
+															const uint32_t			END,
+															FunctionT&&				function) const
+			{
+				std::apply([&](Ts*... data)
+				{
+					for(uint32_t index = BEGIN; index < END; ++index)
+					{
+						function(data[index]...);
+					}
+				}, m_data);
+			}
+
+			/*
+				Splits columns into chunks, which are processed by the parallel phase.
+				Function must be safe to call from multiple threads.
+			*/
+			template<typename FunctionT>
+			void						parallel_for_each(	dpl::ParallelPhase&		phase,
+															FunctionT&&				function,
+															const uint32_t			MIN_CHUNK_SIZE = 1024) const
+			{
+				if(m_size <= MIN_CHUNK_SIZE)
+				{
+					return for_each(function);
+				}
+
+				const uint32_t NUM_JOBS		= std::max(phase.numJobs(), 1u);
+				const uint32_t CHUNK_SIZE	= std::max(MIN_CHUNK_SIZE, (m_size + NUM_JOBS - 1) / NUM_JOBS);
+				for(uint32_t begin = 0; begin < m_size; begin += CHUNK_SIZE)
+				{
+					const uint32_t END = std::min(begin + CHUNK_SIZE, m_size);
+					phase.add_task(END - begin, [this, begin, END, &function]()
+					{
+						for_range(begin, END, function);
+					});
+				}
+
+				phase.start();
+			}
+		};
+
 	private: // data
 		Rows m_rows; //<-- Each row has the same size.
 
@@ -190,6 +314,44 @@ namespace complex
 			return ComponentTable::row<T>().index_of(COMPONENT_ADDRESS);
 		}
 
+	public: // view functions
+		/*
+			Returns arrays of the given component types, e.g. view<Position, const Velocity>().
+			Rows of non-const types are marked as modified.
+		*/
+		template<typename... Ts> requires (dpl::is_one_of<std::remove_const_t<Ts>, COMPONENT_TYPES> && ...)
+		inline View<Ts...>				view()
+		{
+			return View<Ts...>(numColumns(), ComponentTable::row_data<Ts>()...);
+		}
+
+		template<typename... Ts> requires ((std::is_const_v<Ts> && dpl::is_one_of<std::remove_const_t<Ts>, COMPONENT_TYPES>) && ...)
+		inline View<Ts...>				view() const
+		{
+			return View<Ts...>(numColumns(), ComponentTable::row<std::remove_const_t<Ts>>().read()...);
+		}
+
+	public: // import/export
+		inline void						export_rows_to(	std::ostream&		binary) const
+		{
+			(ComponentTable::row<ComponentTn>().export_to(binary), ...);
+		}
+
+		inline void						import_rows_from(std::istream&		binary)
+		{
+			(ComponentTable::row<ComponentTn>().import_from(binary), ...);
+		}
+
+		/*
+			Imports rows directly from memory(e.g. uncompressed chunk of the mapped file), each row is copied at once.
+			Returns false if there was not enough data or rows have different sizes(content of the table is then undefined).
+		*/
+		bool							import_rows_from(dpl::ByteReader&	bytes) requires (std::is_trivially_copyable_v<ComponentTn> && ...)
+		{
+			if(!(ComponentTable::row<ComponentTn>().import_from(bytes) && ...)) return false;
+			return ((ComponentTable::row<ComponentTn>().size() == numColumns()) && ...);
+		}
+
 	protected: // column functions
 		inline Column					add_columns(	const uint32_t		NUM_COLUMNS)
 		{
@@ -205,6 +367,14 @@ namespace complex
 		{
 			(ComponentTable::row<ComponentTn>().destroy_at(COLUMN_INDEX), ...);
 		}
+
+	private: // view functions
+		template<typename T>
+		inline T*						row_data()
+		{
+			if constexpr(std::is_const_v<T>)	return ComponentTable::row<std::remove_const_t<T>>().read();
+			else								return ComponentTable::row<T>().modify();
+		}
 	};
 }
 
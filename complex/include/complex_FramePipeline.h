@@ -0,0 +1,239 @@
+#pragma once
+
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <dpl_ReadOnly.h>
+#include <dpl_ThreadPool.h>
+#include <dpl_Profiler.h>
+#include <dpl_GeneralException.h>
+
+
+// declarations
+namespace complex
+{
+	/*
+		Interface of the object that presents extracted render data on the main thread.
+	*/
+	class	FrameRenderer;
+
+	/*
+		Renderer that only counts submitted frames(headless runs and tests).
+	*/
+	class	NullFrameRenderer;
+
+	/*
+		Two copies of the render data: one written by the extract stage, one read by the renderer.
+	*/
+	template<typename T>
+	class	FrameBuffered;
+
+	/*
+		Overlaps simulation of the next frame with the submission of the previous one.
+	*/
+	class	FramePipeline;
+}
+
+// implementations
+namespace complex
+{
+	class	FrameRenderer
+	{
+	public: // lifecycle
+		virtual CLASS_DTOR		~FrameRenderer() = default;
+
+	public: // interface
+		virtual void			submit(				const uint64_t		FRAME) = 0;
+	};
+
+
+	class	NullFrameRenderer : public FrameRenderer
+	{
+	public: // data
+		dpl::ReadOnly<uint64_t, NullFrameRenderer> numSubmitted;
+		dpl::ReadOnly<uint64_t, NullFrameRenderer> lastFrame;
+
+	public: // lifecycle
+		CLASS_CTOR				NullFrameRenderer()
+			: numSubmitted(0)
+			, lastFrame(0)
+		{
+
+		}
+
+	public: // interface
+		virtual void			submit(				const uint64_t		FRAME) override
+		{
+			++(*numSubmitted);
+			lastFrame = FRAME;
+		}
+	};
+
+
+	/*
+		Slot is selected by the parity of the frame, so the extract stage of the frame N+1
+		never writes the data that renderer reads for the frame N.
+	*/
+	template<typename T>
+	class	FrameBuffered
+	{
+	private: // data
+		std::array<T, 2> m_slots;
+
+	public: // functions
+		inline T&				write(				const uint64_t		FRAME)
+		{
+			return m_slots[FRAME & 1];
+		}
+
+		inline const T&			read(				const uint64_t		FRAME) const
+		{
+			return m_slots[FRAME & 1];
+		}
+	};
+
+
+	/*
+		Each frame:
+			simulation thread:	simulate(N+1) -> extract(N+1)
+			main thread:		submit(N)
+			main thread:		wait for the simulation(sync point)
+
+		Renderer is never more than MAX_FRAME_LATENCY frames behind the simulation.
+		Note: During submission, renderer may only read the data written by extractors(e.g. FrameBuffered),
+			  since systems are updated at the same time. Anything else that reads the live state(UI, etc.) must run after the sync point.
+	*/
+	class	FramePipeline
+	{
+	public: // subtypes
+		using	Stage		= std::function<void(const uint64_t FRAME)>;
+		using	Simulation	= std::function<void()>;
+
+	public: // constants
+		static constexpr uint64_t MAX_FRAME_LATENCY = 1;
+
+	public: // data
+		dpl::ReadOnly<uint64_t, FramePipeline> simulatedFrame;	// Last frame that was simulated and extracted(0 if none).
+		dpl::ReadOnly<uint64_t, FramePipeline> submittedFrame;	// Last frame that was submitted to the renderer(0 if none).
+
+	private: // data
+		dpl::ThreadPool		m_simulationThread;
+		std::vector<Stage>	m_extractors;
+		FrameRenderer*		m_renderer;
+
+	public: // lifecycle
+		CLASS_CTOR				FramePipeline()
+			: simulatedFrame(0)
+			, submittedFrame(0)
+			, m_simulationThread(1)
+			, m_renderer(nullptr)
+		{
+
+		}
+
+	public: // functions
+		inline void				set_renderer(		FrameRenderer*		renderer)
+		{
+			m_renderer = renderer;
+		}
+
+		inline FrameRenderer*	get_renderer() const
+		{
+			return m_renderer;
+		}
+
+		/*
+			Extractors copy render data of the simulated frame(on the simulation thread, in order of addition).
+		*/
+		inline void				add_extractor(		const Stage&		EXTRACTOR)
+		{
+			m_extractors.push_back(EXTRACTOR);
+		}
+
+		inline void				remove_all_extractors()
+		{
+			m_extractors.clear();
+		}
+
+		/*
+			Pipelined frames are safe only if something extracts the render data and something consumes it.
+		*/
+		inline bool				is_ready() const
+		{
+			return m_renderer && !m_extractors.empty();
+		}
+
+		inline uint64_t			get_latency() const
+		{
+			return simulatedFrame() - submittedFrame();
+		}
+
+		/*
+			Runs one pipelined frame and returns after the sync point.
+			Exceptions thrown by the simulation are caught on the simulation thread(so its pool stays alive)
+			and rethrown on the calling thread. The sync point is reached even if the submission throws.
+		*/
+		void					run_frame(			const Simulation&	SIMULATE)
+		{
+			const uint64_t		NEXT_FRAME = simulatedFrame() + 1;
+			std::exception_ptr	simulationError;
+
+			m_simulationThread.add_task([&, NEXT_FRAME]()
+			{
+				try
+				{
+					{dpl::ProfileZone zone("FramePipeline::simulate");
+						SIMULATE();
+					}
+
+					dpl::ProfileZone zone("FramePipeline::extract");
+					for(const Stage& EXTRACT : m_extractors)
+					{
+						EXTRACT(NEXT_FRAME);
+					}
+				}
+				catch(...)
+				{
+					simulationError = std::current_exception();
+				}
+			});
+
+			try
+			{
+				submit_last_frame();
+			}
+			catch(...)
+			{
+				m_simulationThread.wait(); // Task references SIMULATE and this.
+				if(!simulationError) simulatedFrame = NEXT_FRAME;
+				throw;
+			}
+
+			m_simulationThread.wait();
+			if(simulationError) std::rethrow_exception(simulationError);
+			simulatedFrame = NEXT_FRAME;
+
+#ifdef _DEBUG
+			if(get_latency() > MAX_FRAME_LATENCY)
+				throw dpl::GeneralException(this, __LINE__, "Frame latency exceeded.");
+#endif // _DEBUG
+		}
+
+		/*
+			Submits the last simulated frame if it was not submitted yet(e.g. before pipeline is disabled).
+		*/
+		void					submit_last_frame()
+		{
+			if(submittedFrame() == simulatedFrame()) return;
+			if(m_renderer)
+			{
+				dpl::ProfileZone zone("FramePipeline::submit");
+				m_renderer->submit(simulatedFrame());
+			}
+
+			submittedFrame = simulatedFrame();
+		}
+	};
+}
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
 
+#include <vector>
+#include <algorithm>
 #include <dpl_Singleton.h>
 #include <dpl_Ownership.h>
 #include <dpl_Chain.h>
 #include <dpl_Labelable.h>
 #include <dpl_Command.h>
 #include <dpl_DataTransfer.h>
+#include <dpl_ChunkFile.h>
+#include <dpl_BytePool.h>
 #include "complex_Utilities.h"
 
 
@@ -53,21 +57,33 @@ namespace complex
 	private: // subtypes
 		using	MyLink	= dpl::Link<InstanceGroup, InstancePack>;
 
+		/*
+			Binary state of the undoable operation.
+			Only the affected instances are stored(tail of the group or the whole detached pack),
+			buffer is returned to the pool as soon as the state is imported back.
+		*/
 		struct	State
 		{
-			std::stringstream	binary;
+			dpl::PooledStream	binary;
+
+			inline bool is_empty() const
+			{
+				return binary.empty();
+			}
 
 			inline void reset_in()
 			{
-				binary.seekg(0);
-				binary.clear();
+				binary.reset_in();
 			}
 
 			inline void reset_out()
 			{
-				binary.str({}); //<-- Remove old state.
-				binary.seekp(0);
-				binary.clear();
+				binary.reset_out(); //<-- Remove old state.
+			}
+
+			inline void release()
+			{
+				binary.release();
 			}
 		};
 
@@ -190,6 +206,8 @@ namespace complex
 		virtual void				swap_instances(				const uint32_t	FIRST_INDEX,
 																const uint32_t	SECOND_INDEX) = 0;
 
+		virtual void				rearrange_instances(		const dpl::DeltaArray&	DELTA) = 0;
+
 		virtual void				import_all_instances_from(	std::istream&	binary) = 0;
 
 		virtual void				import_tail_instances_from(	std::istream&	binary) = 0;
@@ -372,6 +390,42 @@ namespace complex
 			virtual void	unexecute() final override;
 		};
 
+		/*
+			Moves each instance of the group to the new position in all linked packs(newPositions[oldIndex] = newIndex).
+			Undo applies the inverse permutation.
+		*/
+		class	ReorderCommand : public dpl::Command
+		{
+		public: // data
+			dpl::ReadOnly<std::string,				ReorderCommand> groupName;
+			dpl::ReadOnly<std::vector<uint32_t>,	ReorderCommand> newPositions;
+
+		public: // lifecycle
+			CLASS_CTOR		ReorderCommand(			const std::string&				GROUP_NAME,
+													const std::vector<uint32_t>&	NEW_POSITIONS)
+				: groupName(GROUP_NAME)
+				, newPositions(NEW_POSITIONS)
+			{
+
+			}
+
+			CLASS_CTOR		ReorderCommand(			const InstanceGroup&			GROUP,
+													const std::vector<uint32_t>&	NEW_POSITIONS)
+				: ReorderCommand(GROUP.get_label(), NEW_POSITIONS)
+			{
+
+			}
+
+		private: // implementation
+			virtual bool	valid() const final override;
+			virtual void	execute() final override;
+			virtual void	unexecute() final override;
+
+		private: // functions
+			void			fill_delta(				dpl::DeltaArray&				delta,
+													const bool						INVERSE) const;
+		};
+
 		class	DestroyInstanceCommand : public dpl::Command
 		{
 		public: // data
@@ -451,6 +505,62 @@ namespace complex
 			return invoker.invoke<DestroyInstanceCommand>(*this, INSTANCE_INDEX);
 		}
 
+		inline bool		reorder(				dpl::CommandInvoker&		invoker,
+												const std::vector<uint32_t>&	NEW_POSITIONS) const
+		{
+			return invoker.invoke<ReorderCommand>(*this, NEW_POSITIONS);
+		}
+
+		/*
+			Reorders instances by ascending keys(one key per instance, e.g. morton_key of the position or material ID).
+			Returns false if instances are already sorted(nothing is moved).
+		*/
+		inline bool		sort_by(				dpl::CommandInvoker&		invoker,
+												const std::vector<uint32_t>&	KEYS) const
+		{
+			if(std::is_sorted(KEYS.begin(), KEYS.end())) return false;
+			return reorder(invoker, sort_permutation(KEYS));
+		}
+
+	public: // runtime functions
+		/*
+			Moves instances to the new positions(newPositions[oldIndex] = newIndex) without recording a command.
+			Meant for runtime sorting(e.g. every N frames), so the history is not filled with permutations the user did not make.
+			Note: Commands in the history refer to instances by index, so their undo applies to the instances at these positions after sorting.
+			Returns false if positions are not a permutation of the instances.
+		*/
+		bool			reorder(				const std::vector<uint32_t>&	NEW_POSITIONS);
+
+		/*
+			Reorders instances by ascending keys without recording a command(see reorder above).
+			Returns false if keys do not match the instances or instances are already sorted.
+		*/
+		inline bool		sort_by(				const std::vector<uint32_t>&	KEYS)
+		{
+			if(KEYS.size() != query_numInstances() || std::is_sorted(KEYS.begin(), KEYS.end())) return false;
+			return reorder(sort_permutation(KEYS));
+		}
+
+	public: // sort keys
+		/*
+			Returns Morton code(Z-order curve) of the position within given bounds(10 bits per axis).
+			Instances sorted by this key are close in memory when they are close in space.
+		*/
+		static uint32_t	morton_key(				const glm::vec3&			POSITION,
+												const glm::vec3&			MIN,
+												const glm::vec3&			MAX);
+
+		/*
+			Returns new positions of the instances sorted by the given keys(stable radix sort).
+		*/
+		static std::vector<uint32_t> sort_permutation(const std::vector<uint32_t>&	KEYS);
+
+		/*
+			Returns true if each position in [0, NUM_INSTANCES) is used exactly once.
+		*/
+		static bool		is_permutation(			const std::vector<uint32_t>&	NEW_POSITIONS,
+												const uint32_t					NUM_INSTANCES);
+
 	private: // functions
 		void			attach_instance_pack(	InstancePack&				pack,
 												std::istream*				binaryState);
@@ -466,6 +576,8 @@ namespace complex
 		void			swap_instances(			const uint32_t				FIRST_INDEX,
 												const uint32_t				SECOND_INDEX);
 
+		void			rearrange_instances(	const dpl::DeltaArray&		DELTA);
+
 		void			import_all_from(		std::istream&				binaryState);
 
 		void			import_tail_from(		std::istream&				binaryState);
@@ -487,6 +599,9 @@ namespace complex
 	public: // commands
 		using	InvokeGroup = std::function<void(InstanceGroup&)>;
 
+	public: // constants
+		static constexpr const char* GROUP_CHUNK_PREFIX = "InstanceGroup/";
+
 	private: // data
 		dpl::Labeler<char> m_groupLabeler;
 
@@ -538,6 +653,22 @@ namespace complex
 			return DynamicOwner::get_property_at(GROUP_INDEX);
 		}
 
+	public: // import/export
+		/*
+			Adds one chunk per instance group to the writer(named with GROUP_CHUNK_PREFIX and the label of the group).
+			Note: Groups must not be modified until the writer is saved.
+		*/
+		void						export_groups_to(		dpl::ChunkFileWriter&		writer);
+
+		/*
+			Creates instance group for each group chunk in the file.
+			Chunks are decompressed in parallel when thread pool is given.
+			Group whose name is already taken keeps the generated name and the error is logged.
+			Returns number of imported groups.
+		*/
+		uint32_t					import_groups_from(		dpl::ChunkFileReader&		reader,
+															dpl::ThreadPool*			threadPool = nullptr);
+
 	private: // functions
 		void						pull_group(				const std::string&			GROUP_NAME,
 															const InvokeGroup&			INVOKE)
@@ -623,6 +754,11 @@ namespace complex
 			m_instances.swap_elements(FIRST_INDEX, SECOND_INDEX);
 		}
 
+		virtual void				rearrange_instances(		const dpl::DeltaArray&	DELTA) final override
+		{
+			m_instances.rearrange(DELTA);
+		}
+
 		virtual void				import_all_instances_from(	std::istream&			binary) final override
 		{
 			m_instances.import_from(binary);
@@ -2,6 +2,7 @@
 
 
 #include <dpl_Chain.h>
+#include <dpl_PackedChain.h>
 #include <dpl_Variation.h>
 #include <dpl_ThreadPool.h>
 #include <dpl_ResourceControl.h>
@@ -19,13 +20,13 @@ namespace wapp
 
 	class RenderTarget	: public Camera
 						, public glw::FrameBuffer
-						, public dpl::Link<RenderingPipeline, RenderTarget>
+						, public dpl::PackedLink<RenderingPipeline, RenderTarget>
 	{
 	public: // relations
 		friend RenderingPipeline;
 
 	private: // subtypes
-		using MyPipeline	= dpl::Link<RenderingPipeline, RenderTarget>;
+		using MyPipeline	= dpl::PackedLink<RenderingPipeline, RenderTarget>;
 		using MyCamera		= dpl::Association<RenderTarget, Camera>;
 
 	public: // lifecycle
@@ -70,10 +71,11 @@ namespace wapp
 		Stores/updates render targets and invokes renderers.
 
 		Order of render targets is ignored. Removing one may cause other to be moved in memory.
+		Render targets are iterated through the dense array of the packed chain.
 		Order of renderers is preserved. Removing one in the middle will not change order of the others.
 	*/
 	class RenderingPipeline : public dpl::Chain<RenderingPipeline, Renderer>
-							, public dpl::Chain<RenderingPipeline, RenderTarget>
+							, public dpl::PackedChain<RenderingPipeline, RenderTarget>
 	{
 	public: // relations
 		friend Application;
@@ -83,7 +85,7 @@ namespace wapp
 
 	private: // subtypes
 		using MyRenderers		= dpl::Chain<RenderingPipeline, Renderer>;
-		using MyRenderTargets	= dpl::Chain<RenderingPipeline, RenderTarget>;
+		using MyRenderTargets	= dpl::PackedChain<RenderingPipeline, RenderTarget>;
 
 	public: // lifecycle
 		/* CTOR */				RenderingPipeline() = default;
@@ -118,7 +120,7 @@ namespace wapp
 	private: // functions
 		inline void				update()
 		{
-			MyRenderTargets::iterate_forward([](RenderTarget& target)
+			MyRenderTargets::for_each_packed([](RenderTarget& target)
 			{
 				target.update();
 			});
@@ -179,7 +181,7 @@ namespace wapp
 			if(RenderingPipeline* pipeline = Renderer::get_chain())
 			{
 				on_begin(project, threadPool);
-				pipeline->iterate_forward([&](RenderTarget&	target)
+				pipeline->for_each_packed([&](RenderTarget&	target)
 				{
 					if(!target.is_collapsed()) on_render(project, threadPool, target);
 				});
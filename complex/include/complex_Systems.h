@@ -5,6 +5,13 @@
 #include <vector>
 #include <functional>
 #include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cmath>
 #include <dpl_Singleton.h>
 #include <dpl_ReadOnly.h>
 #include <dpl_Timer.h>
@@ -14,6 +21,7 @@
 #include <dpl_Logger.h>
 #include <dpl_Labelable.h>
 #include <dpl_ThreadPool.h>
+#include <dpl_Profiler.h>
 
 
 // declarations
@@ -40,6 +48,22 @@ namespace complex
 									&& SUBSYSTEM_TYPES::ALL_UNIQUE 
 									&& SUBSYSTEM_TYPES::template all<IsSubSystem>();
 
+	template<typename... Ts>
+	struct	Reads{};
+
+	template<typename... Ts>
+	struct	Writes{};
+
+	template<typename SubT>
+	concept	has_AccessList			= requires { typename SubT::Access; }
+									&& dpl::is_TypeList<typename SubT::Access>;
+
+	class	AccessSet;
+
+	class	SubsystemScheduler;
+
+	class	ParallelTicker;
+
 	class	ISupraSystem;
 
 	template<typename SupraT, is_SubSystemTypeList SUBSYSTEMS>
@@ -61,6 +85,8 @@ namespace complex
 	{
 	public: // friends
 		friend	SystemManager;
+		friend	SubsystemScheduler;
+		friend	ParallelTicker;
 		
 		template<typename, is_SubSystemTypeList>
 		friend class SupraSystem;
@@ -114,6 +140,7 @@ namespace complex
 
 		void				update()
 		{
+			dpl::ProfileZone zone(get_label());
 			++(*updateCycle);
 			updateTimer().is_started()? updateTimer->unpause() : updateTimer->start();
 			log_and_throw_on_exception([&](){on_update();});
@@ -164,6 +191,93 @@ namespace complex
 	};
 
 
+	/*
+		Set of component types or resources used by the subsystem.
+		Declared in the subsystem class with:
+			using Access = dpl::TypeList<Reads<A, B>, Writes<C>>;
+
+		Subsystem without declaration is exclusive(conflicts with all other subsystems).
+	*/
+	class	AccessSet
+	{
+	private: // subtypes
+		using	ResourceID = const void*;
+
+		template<typename T>
+		struct	ResourceKey
+		{
+			static inline const char ID = 0; // Address is unique for each type(also incomplete).
+		};
+
+	public: // data
+		dpl::ReadOnly<bool, AccessSet> bExclusive;
+
+	private: // data
+		std::vector<ResourceID> m_reads;
+		std::vector<ResourceID> m_writes;
+
+	public: // lifecycle
+		CLASS_CTOR				AccessSet()
+			: bExclusive(true)
+		{
+
+		}
+
+	public: // functions
+		template<typename SubT>
+		static AccessSet		of()
+		{
+			AccessSet result;
+			if constexpr (has_AccessList<SubT>)
+			{
+				result.bExclusive = false;
+				result.add(typename SubT::Access());
+			}
+			return result;
+		}
+
+		/*
+			Returns true if subsystems may not run concurrently.
+		*/
+		bool					conflicts_with(	const AccessSet&				OTHER) const
+		{
+			if(bExclusive() || OTHER.bExclusive()) return true;
+			return intersects(m_writes, OTHER.m_writes)
+				|| intersects(m_writes, OTHER.m_reads)
+				|| intersects(m_reads,	OTHER.m_writes);
+		}
+
+	private: // functions
+		template<typename... AccessTs>
+		inline void				add(			const dpl::TypeList<AccessTs...>	DUMMY)
+		{
+			(add(AccessTs()), ...);
+		}
+
+		template<typename... Ts>
+		inline void				add(			const Reads<Ts...>				DUMMY)
+		{
+			(m_reads.push_back(&ResourceKey<Ts>::ID), ...);
+		}
+
+		template<typename... Ts>
+		inline void				add(			const Writes<Ts...>				DUMMY)
+		{
+			(m_writes.push_back(&ResourceKey<Ts>::ID), ...);
+		}
+
+		static inline bool		intersects(		const std::vector<ResourceID>&	FIRST,
+												const std::vector<ResourceID>&	SECOND)
+		{
+			for(const ResourceID ID : FIRST)
+			{
+				if(std::find(SECOND.begin(), SECOND.end(), ID) != SECOND.end()) return true;
+			}
+			return false;
+		}
+	};
+
+
 	class	ISubSystem : public SystemInterface
 	{
 	public: // friends
@@ -173,6 +287,11 @@ namespace complex
 		template<typename>
 		friend class ParallelSubSystem;
 
+		friend	SubsystemScheduler;
+
+	private: // data
+		AccessSet m_access;
+
 	private: // lifecycle
 		CLASS_CTOR			ISubSystem(	dpl::Labeler<char>&	systemLabeler,
 										const std::string&	NAME)
@@ -192,7 +311,11 @@ namespace complex
 		template<typename, is_SubSystemTypeList>
 		friend class SupraSystem;
 
+		template<typename, is_SubSystemTypeList>
+		friend class ParallelSystem;
+
 		friend	SystemManager;
+		friend	ParallelTicker;
 
 	private: // subtypes
 		using	MySubsystemPtr	= std::unique_ptr<ISubSystem>;
@@ -201,10 +324,14 @@ namespace complex
 	public: // subtypes
 		using	SystemCallback	= std::function<void(SystemInterface&)>;
 
+	private: // data
+		std::atomic<double> m_tickRate; // [Hz] of the parallel system, 0 means once per frame.
+
 	private: // lifecycle
 		CLASS_CTOR			ISupraSystem(		dpl::Labeler<char>&		systemLabeler,
 												const std::string&		NAME)
 			: SystemInterface(systemLabeler, NAME)
+			, m_tickRate(0.0)
 		{
 			
 		}
@@ -236,11 +363,554 @@ namespace complex
 
 		virtual void		on_subsystems_uninstalled(){}
 	};
+
+
+	/*
+		Updates subsystems of the supra system according to their access declarations.
+
+		Subsystems are split into groups by the exclusive ones(without declaration), which run alone on the main thread
+		and may still use the parallel phase. Within the group, subsystem waits only for the preceding subsystems it conflicts with,
+		and the rest runs concurrently on the given thread pool.
+		Note: Subsystems with declared access must not use the parallel phase.
+	*/
+	class	SubsystemScheduler
+	{
+	private: // subtypes
+		using	Clock		= std::chrono::steady_clock;
+		using	Subsystems	= std::vector<std::unique_ptr<ISubSystem>>;
+
+		struct	Node
+		{
+			ISubSystem*				subsystem		= nullptr;
+			std::vector<uint32_t>	predecessors;
+			std::vector<uint32_t>	successors;
+			double					duration		= 0.0; // Update time in the last frame[ms].
+			double					pathTime		= 0.0; // Longest path ending with this node[ms].
+			uint32_t				pathPrevious	= INVALID_INDEX;
+		};
+
+		struct	Group
+		{
+			uint32_t begin;
+			uint32_t end;
+		};
+
+	public: // constants
+		static const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	public: // data
+		dpl::ReadOnly<double,	SubsystemScheduler> criticalPathTime;	// Last frame[ms].
+		dpl::ReadOnly<double,	SubsystemScheduler> totalUpdateTime;	// Sum of the subsystem updates in the last frame[ms].
+		dpl::ReadOnly<uint64_t,	SubsystemScheduler> numFrames;
+
+	private: // data
+		std::vector<Node>						m_nodes;
+		std::vector<Group>						m_groups;
+		std::unique_ptr<std::atomic_uint32_t[]>	m_numPending;
+		std::vector<uint32_t>					m_criticalPath;
+		double									m_criticalPathSum;
+		double									m_totalUpdateSum;
+		std::mutex								m_mtx;
+		std::condition_variable					m_groupDone;
+		uint32_t								m_numRunning;	// Nodes of the current group that did not finish yet.
+		std::string								m_error;		// First failure in the current group.
+
+	public: // lifecycle
+		CLASS_CTOR				SubsystemScheduler()
+			: criticalPathTime(0.0)
+			, totalUpdateTime(0.0)
+			, numFrames(0)
+			, m_criticalPathSum(0.0)
+			, m_totalUpdateSum(0.0)
+			, m_numRunning(0)
+		{
+
+		}
+
+	public: // functions
+		inline uint32_t			get_numGroups() const
+		{
+			return static_cast<uint32_t>(m_groups.size());
+		}
+
+		/*
+			Returns labels of the subsystems on the critical path of the last frame.
+		*/
+		std::string				get_critical_path() const
+		{
+			std::string result;
+			for(const uint32_t INDEX : m_criticalPath)
+			{
+				if(!result.empty()) result += " -> ";
+				result += m_nodes[INDEX].subsystem->get_label();
+			}
+			return result;
+		}
+
+		void					build(				const Subsystems&		SUBSYSTEMS)
+		{
+			m_nodes.clear();
+			m_groups.clear();
+			m_nodes.resize(SUBSYSTEMS.size());
+			m_numPending = std::make_unique<std::atomic_uint32_t[]>(SUBSYSTEMS.size());
+			reset_diagnostic();
+
+			for(uint32_t index = 0; index < m_nodes.size(); ++index)
+			{
+				m_nodes[index].subsystem = SUBSYSTEMS[index].get();
+				const AccessSet& ACCESS = m_nodes[index].subsystem->m_access;
+
+				if(ACCESS.bExclusive() || m_groups.empty() || is_exclusive(m_groups.back()))
+				{
+					m_groups.push_back(Group{index, index + 1});
+				}
+				else
+				{
+					Group& group = m_groups.back();
+					for(uint32_t previous = group.begin; previous < index; ++previous)
+					{
+						if(m_nodes[previous].subsystem->m_access.conflicts_with(ACCESS))
+						{
+							m_nodes[previous].successors.push_back(index);
+							m_nodes[index].predecessors.push_back(previous);
+						}
+					}
+					group.end = index + 1;
+				}
+			}
+		}
+
+		/*
+			Waits only for the subsystems of this scheduler(pool may be shared with other schedulers).
+		*/
+		void					run(				dpl::ThreadPool&		threadPool)
+		{
+			for(const Group& GROUP : m_groups)
+			{
+				if(GROUP.end - GROUP.begin == 1)
+				{
+					update_node(GROUP.begin);
+					continue;
+				}
+
+				for(uint32_t index = GROUP.begin; index < GROUP.end; ++index)
+				{
+					m_numPending[index] = static_cast<uint32_t>(m_nodes[index].predecessors.size());
+				}
+
+				{std::lock_guard lk(m_mtx);
+					m_numRunning = GROUP.end - GROUP.begin;
+					m_error.clear();
+				}
+
+				for(uint32_t index = GROUP.begin; index < GROUP.end; ++index)
+				{
+					if(m_nodes[index].predecessors.empty()) launch_node(index, threadPool);
+				}
+
+				wait_for_group();
+			}
+
+			update_critical_path();
+		}
+
+		void					log_diagnostic() const
+		{
+			if(numFrames() == 0) return;
+			const double AVR_PATH	= m_criticalPathSum / static_cast<double>(numFrames());
+			const double AVR_TOTAL	= m_totalUpdateSum / static_cast<double>(numFrames());
+			dpl::Logger::ref().push_info("groups:             " + std::to_string(m_groups.size()));
+			dpl::Logger::ref().push_info("avr critical path:  " + std::to_string(AVR_PATH) + "[ms]");
+			dpl::Logger::ref().push_info("avr total update:   " + std::to_string(AVR_TOTAL) + "[ms]");
+			dpl::Logger::ref().push_info("last critical path: " + get_critical_path());
+		}
+
+	private: // functions
+		inline bool				is_exclusive(		const Group&			GROUP) const
+		{
+			return m_nodes[GROUP.begin].subsystem->m_access.bExclusive();
+		}
+
+		inline void				reset_diagnostic()
+		{
+			criticalPathTime	= 0.0;
+			totalUpdateTime		= 0.0;
+			numFrames			= 0;
+			m_criticalPathSum	= 0.0;
+			m_totalUpdateSum	= 0.0;
+			m_criticalPath.clear();
+		}
+
+		inline void				update_node(		const uint32_t			INDEX)
+		{
+			Node&				node	= m_nodes[INDEX];
+			const auto			START	= Clock::now();
+			node.subsystem->update();
+			node.duration = std::chrono::duration<double, std::milli>(Clock::now() - START).count();
+		}
+
+		/*
+			Updates node on the worker thread and launches successors that are no longer blocked.
+			Exceptions are caught, so they do not terminate the shared pool, and the remaining nodes of the group are skipped.
+		*/
+		inline void				launch_node(		const uint32_t			INDEX,
+													dpl::ThreadPool&		threadPool)
+		{
+			threadPool.add_task([this, INDEX, &threadPool]()
+			{
+				try
+				{
+					if(!has_failed()) update_node(INDEX);
+				}
+				catch(const std::exception& EXCEPTION)
+				{
+					set_error(INDEX, EXCEPTION.what());
+				}
+				catch(...)
+				{
+					set_error(INDEX, "Unknown exception");
+				}
+
+				for(const uint32_t SUCCESSOR : m_nodes[INDEX].successors)
+				{
+					if(--m_numPending[SUCCESSOR] == 0) launch_node(SUCCESSOR, threadPool);
+				}
+
+				std::lock_guard lk(m_mtx);
+				if(--m_numRunning == 0) m_groupDone.notify_all();
+			});
+		}
+
+		inline bool				has_failed()
+		{
+			std::lock_guard lk(m_mtx);
+			return !m_error.empty();
+		}
+
+		inline void				set_error(			const uint32_t			INDEX,
+													const char*				MESSAGE)
+		{
+			std::lock_guard lk(m_mtx);
+			if(m_error.empty()) m_error = m_nodes[INDEX].subsystem->get_label() + ": " + MESSAGE;
+		}
+
+		void					wait_for_group()
+		{
+			std::unique_lock lk(m_mtx);
+			m_groupDone.wait(lk, [&]
+			{
+				return m_numRunning == 0;
+			});
+
+			if(!m_error.empty())
+				throw dpl::Logger::ref().push_error("Subsystem failed: %s", m_error.c_str());
+		}
+
+		void					update_critical_path()
+		{
+			double frameTime	= 0.0;
+			double totalTime	= 0.0;
+			m_criticalPath.clear();
+
+			for(const Group& GROUP : m_groups)
+			{
+				uint32_t lastNode = GROUP.begin;
+				for(uint32_t index = GROUP.begin; index < GROUP.end; ++index)
+				{
+					Node& node = m_nodes[index];
+					node.pathTime		= 0.0;
+					node.pathPrevious	= INVALID_INDEX;
+					for(const uint32_t PREDECESSOR : node.predecessors)
+					{
+						if(m_nodes[PREDECESSOR].pathTime > node.pathTime)
+						{
+							node.pathTime		= m_nodes[PREDECESSOR].pathTime;
+							node.pathPrevious	= PREDECESSOR;
+						}
+					}
+					node.pathTime	+= node.duration;
+					totalTime		+= node.duration;
+					if(node.pathTime > m_nodes[lastNode].pathTime) lastNode = index;
+				}
+
+				frameTime += m_nodes[lastNode].pathTime;
+				const size_t GROUP_PATH_BEGIN = m_criticalPath.size();
+				for(uint32_t index = lastNode; index != INVALID_INDEX; index = m_nodes[index].pathPrevious)
+				{
+					m_criticalPath.push_back(index);
+				}
+				std::reverse(m_criticalPath.begin() + GROUP_PATH_BEGIN, m_criticalPath.end());
+			}
+
+			criticalPathTime	= frameTime;
+			totalUpdateTime		= totalTime;
+			++(*numFrames);
+			m_criticalPathSum	+= frameTime;
+			m_totalUpdateSum	+= totalTime;
+		}
+	};
 }
 
 // system manager / supra system
 namespace complex
 {
+	/*
+		Updates parallel systems on a small set of pooled workers.
+		Each system ticks once per frame(signaled by the system manager) or with its fixed rate.
+		Workers sleep on the condition variable between the ticks and are joined when stopped.
+		System is never updated by two workers at the same time.
+	*/
+	class	ParallelTicker
+	{
+	private: // subtypes
+		using	Clock		= std::chrono::steady_clock;
+		using	Systems		= std::vector<std::unique_ptr<ISupraSystem>>;
+
+		struct	Entry
+		{
+			ISupraSystem*		system		= nullptr;
+			Clock::time_point	nextTick;
+			Clock::time_point	lastStart;
+			uint64_t			lastFrame	= 0;
+			bool				bRunning	= false;
+			uint64_t			numTicks	= 0;
+			double				busyTime	= 0.0;	// [s]
+			double				meanInterval= 0.0;	// [ms]
+			double				sumSquares	= 0.0;	// Sum of squared differences from the mean interval.
+		};
+
+	public: // subtypes
+		struct	Statistics
+		{
+			uint64_t	numTicks		= 0;
+			double		cpuUsage		= 0.0; // Fraction of the time spent in updates.
+			double		meanInterval	= 0.0; // [ms]
+			double		jitter			= 0.0; // Standard deviation of the interval[ms].
+		};
+
+	private: // data
+		mutable std::mutex			m_mtx;
+		std::condition_variable		m_signal;
+		std::vector<Entry>			m_entries;
+		std::vector<std::thread>	m_workers;
+		Clock::time_point			m_launchTime;
+		uint64_t					m_frame;
+		bool						bStop;
+		std::atomic_bool			bFailure;
+
+	public: // lifecycle
+		CLASS_CTOR					ParallelTicker()
+			: m_frame(0)
+			, bStop(false)
+			, bFailure(false)
+		{
+
+		}
+
+		CLASS_DTOR					~ParallelTicker()
+		{
+			stop();
+		}
+
+	public: // functions
+		inline bool					is_running() const
+		{
+			return !m_workers.empty();
+		}
+
+		inline bool					has_failed() const
+		{
+			return bFailure;
+		}
+
+		void						start(				Systems&				systems,
+														dpl::Logger&			logger)
+		{
+			if(is_running()) return;
+
+			m_launchTime	= Clock::now();
+			m_frame			= 0;
+			bStop			= false;
+			bFailure		= false;
+			m_entries.clear();
+			for(auto& it : systems)
+			{
+				Entry&	entry			= m_entries.emplace_back();
+						entry.system	= it.get();
+						entry.nextTick	= m_launchTime;
+			}
+
+			const size_t NUM_WORKERS = std::min<size_t>(m_entries.size(), std::max(1u, std::thread::hardware_concurrency()));
+			for(size_t index = 0; index < NUM_WORKERS; ++index)
+			{
+				m_workers.emplace_back([&](){work(logger);});
+			}
+		}
+
+		/*
+			Wakes up workers of the systems updated once per frame.
+		*/
+		inline void					notify_frame()
+		{
+			{std::lock_guard lock(m_mtx);
+				++m_frame;
+			}
+
+			m_signal.notify_all();
+		}
+
+		/*
+			Waits until all workers finish their current tick.
+		*/
+		void						stop()
+		{
+			{std::lock_guard lock(m_mtx);
+				bStop = true;
+			}
+
+			m_signal.notify_all();
+			for(std::thread& worker : m_workers)
+			{
+				worker.join();
+			}
+			m_workers.clear();
+		}
+
+		Statistics					get_statistics(		const SystemInterface&	SYSTEM) const
+		{
+			std::lock_guard lock(m_mtx);
+			for(const Entry& ENTRY : m_entries)
+			{
+				if(ENTRY.system == &SYSTEM) return make_statistics(ENTRY);
+			}
+			return Statistics();
+		}
+
+		void						log_diagnostic() const
+		{
+			std::lock_guard lock(m_mtx);
+			for(const Entry& ENTRY : m_entries)
+			{
+				const Statistics STATISTICS = make_statistics(ENTRY);
+				dpl::Logger::ref().push_info("-----[PARALLEL TICK DIAGNOSTIC]-----");
+				dpl::Logger::ref().push_info("name:               " + ENTRY.system->get_label());
+				dpl::Logger::ref().push_info("ticks:              " + std::to_string(STATISTICS.numTicks));
+				dpl::Logger::ref().push_info("cpu usage:          " + std::to_string(100.0 * STATISTICS.cpuUsage) + "[%]");
+				dpl::Logger::ref().push_info("avr tick interval:  " + std::to_string(STATISTICS.meanInterval) + "[ms]");
+				dpl::Logger::ref().push_info("tick jitter:        " + std::to_string(STATISTICS.jitter) + "[ms]");
+			}
+		}
+
+	private: // functions
+		Statistics					make_statistics(	const Entry&			ENTRY) const
+		{
+			Statistics	result;
+						result.numTicks		= ENTRY.numTicks;
+						result.meanInterval	= ENTRY.meanInterval;
+						result.jitter		= (ENTRY.numTicks > 2)? std::sqrt(ENTRY.sumSquares / static_cast<double>(ENTRY.numTicks - 2)) : 0.0;
+
+			const double WALL_TIME = std::chrono::duration<double>(Clock::now() - m_launchTime).count();
+			result.cpuUsage = (WALL_TIME > 0.0)? ENTRY.busyTime / WALL_TIME : 0.0;
+			return result;
+		}
+
+		inline bool					is_due(				const Entry&			ENTRY,
+														const Clock::time_point	NOW) const
+		{
+			if(ENTRY.bRunning) return false;
+			return (ENTRY.system->m_tickRate > 0.0)? ENTRY.nextTick <= NOW : ENTRY.lastFrame != m_frame;
+		}
+
+		/*
+			Returns entry that should be updated now, or nullptr and the time of the next fixed tick.
+		*/
+		Entry*						find_due_entry(		Clock::time_point&		wakeUp)
+		{
+			const auto NOW = Clock::now();
+			wakeUp = Clock::time_point::max();
+			for(Entry& entry : m_entries)
+			{
+				if(is_due(entry, NOW)) return &entry;
+				if(!entry.bRunning && entry.system->m_tickRate > 0.0) wakeUp = std::min(wakeUp, entry.nextTick);
+			}
+			return nullptr;
+		}
+
+		void						begin_tick(			Entry&					entry,
+														const Clock::time_point	NOW)
+		{
+			entry.bRunning	= true;
+			entry.lastFrame	= m_frame;
+
+			const double RATE = entry.system->m_tickRate;
+			if(RATE > 0.0)
+			{
+				const auto PERIOD = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / RATE));
+				entry.nextTick = std::max(entry.nextTick + PERIOD, NOW); // Missed ticks are skipped.
+			}
+
+			if(entry.numTicks > 0) // Welford's algorithm
+			{
+				const double INTERVAL	= std::chrono::duration<double, std::milli>(NOW - entry.lastStart).count();
+				const double NUM_VALUES	= static_cast<double>(entry.numTicks);
+				const double DELTA		= INTERVAL - entry.meanInterval;
+				entry.meanInterval		+= DELTA / NUM_VALUES;
+				entry.sumSquares		+= DELTA * (INTERVAL - entry.meanInterval);
+			}
+
+			entry.lastStart = NOW;
+			++entry.numTicks;
+		}
+
+		void						work(				dpl::Logger&			logger)
+		{
+			std::unique_lock lock(m_mtx);
+			while(!bStop)
+			{
+				Clock::time_point wakeUp;
+				Entry* entry = find_due_entry(wakeUp);
+				if(!entry)
+				{
+					if(wakeUp == Clock::time_point::max())	m_signal.wait(lock);
+					else									m_signal.wait_until(lock, wakeUp);
+					continue;
+				}
+
+				const auto START = Clock::now();
+				begin_tick(*entry, START);
+				lock.unlock();
+
+				bool bSuccess = true;
+				try
+				{
+					entry->system->update();
+				}
+				catch(const dpl::GeneralException& ERROR)
+				{
+					logger.push_error("[" + entry->system->get_label() + "]: " + ERROR.what());
+					bSuccess = false;
+				}
+				catch(...)
+				{
+					logger.push_error("[" + entry->system->get_label() + "]: Unknown exception");
+					bSuccess = false;
+				}
+
+				const double BUSY_TIME = std::chrono::duration<double>(Clock::now() - START).count();
+				lock.lock();
+				entry->bRunning	= false;
+				entry->busyTime	+= BUSY_TIME;
+				if(!bSuccess)
+				{
+					bFailure	= true;
+					bStop		= true;
+					m_signal.notify_all();
+				}
+			}
+		}
+	};
+
+
 	class	SystemManager : public dpl::Singleton<SystemManager>
 	{
 	private: // subtypes
@@ -268,17 +938,15 @@ namespace complex
 		dpl::Labeler<char>		m_labeler;
 		dpl::Logger				m_logger;
 		dpl::ParallelPhase		m_phase; // All tasks must be done between system updates(call ThreadPool::wait when phase is done).
-		std::atomic_uint32_t	m_parallelWorkers;
-		std::atomic_bool		bParallelUpdate;
-		std::atomic_bool		bParallelFailure;
+		dpl::ThreadPool			m_subsystemPool; // Runs non-conflicting subsystems concurrently(never together with the phase, caller waits meanwhile).
+		ParallelTicker			m_parallelTicker;
 
 	public: // lifecycle
 		CLASS_CTOR				SystemManager(				const std::string&				SETTINGS_FILE,
 															const uint32_t					NUM_THREADS = std::thread::hardware_concurrency())
 			: m_settingsFile(SETTINGS_FILE)
 			, m_phase(NUM_THREADS)
-			, m_parallelWorkers(0)
-			, bParallelUpdate(false)
+			, m_subsystemPool((NUM_THREADS > 1)? NUM_THREADS - 1 : 1)
 		{
 
 		}
@@ -309,13 +977,17 @@ namespace complex
 			return m_logger;
 		}
 
+		inline const ParallelTicker&	get_parallel_ticker() const
+		{
+			return m_parallelTicker;
+		}
+
 	protected: // functions
 		template<	dpl::is_TypeList PhaseSystems, 
 					dpl::is_TypeList ParallelSystems>
 		void					install_all_systems()
 		{
 			SystemManager::throw_if_systems_already_installed();
-			bParallelFailure = false;
 			m_logger.clear();
 			m_logger.push_info("Installing...");
 			SystemManager::install_systems(PhaseSystems(), m_phaseSystems);
@@ -477,60 +1149,24 @@ namespace complex
 		}
 
 	private: // functions
-		inline void				launch_parallel_system(		SystemInterface&				system)
-		{
-			std::thread([&]
-			{
-				++m_parallelWorkers;
-				while(bParallelUpdate)
-				{
-					try
-					{
-						system.update();
-					}
-					catch(const dpl::GeneralException& ERROR)
-					{
-						m_logger.push_error("[" + system.get_label() + "]: " + ERROR.what());
-						bParallelUpdate		= false;
-						bParallelFailure	= true;
-					}
-					catch(...)
-					{
-						m_logger.push_error("[" + system.get_label() + "]: Unknown exception");
-						bParallelUpdate		= false;
-						bParallelFailure	= true;
-					}
-				}
-				--m_parallelWorkers;
-
-			}).detach();
-		}
-
 		inline void				parallel_update()
 		{
-			if(!bParallelUpdate)
-			{
-				if(bParallelFailure)
-					throw dpl::GeneralException(this, __LINE__, "Exception in parallel system.");
-				
-				bParallelUpdate = true;
-
-				for(auto& it : m_parallelSystems)
-				{
-					launch_parallel_system(*it);
-				}
+			if(m_parallelTicker.has_failed())
+				throw dpl::GeneralException(this, __LINE__, "Exception in parallel system.");
 
-				std::this_thread::sleep_for(std::chrono::microseconds(10));
+			if(!m_parallelTicker.is_running())
+			{
+				m_parallelTicker.start(m_parallelSystems, m_logger);
 			}
+
+			m_parallelTicker.notify_frame();
 		}
 
 		inline void				stop_parallel_update()
 		{
-			bParallelUpdate = false;
-			while(m_parallelWorkers > 0)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
-			}
+			if(!m_parallelTicker.is_running()) return;
+			m_parallelTicker.stop();
+			m_parallelTicker.log_diagnostic();
 		}
 	};
 
@@ -556,7 +1192,8 @@ namespace complex
 		friend class	ParallelSystem;
 
 	private: // data
-		MySubsystems m_subsystems;
+		MySubsystems		m_subsystems;
+		SubsystemScheduler	m_scheduler;
 
 	private: // lifecycle
 		CLASS_CTOR			SupraSystem()
@@ -576,28 +1213,32 @@ namespace complex
 			for(auto& it : m_subsystems) CALLBACK(*it);
 		}
 
+	public: // functions
+		inline const SubsystemScheduler&	get_scheduler() const
+		{
+			return m_scheduler;
+		}
+
 	private: // implementation
 		virtual void		on_install() final override
 		{
 			on_start_install();
 			install_subsystems();
+			m_scheduler.build(m_subsystems);
 			on_subsystems_installed();
 		}
 
 		virtual void		on_update() final override
 		{
 			on_start_update();
-			for(auto& it : m_subsystems)
-			{
-				SystemInterface*	subsystem = it.get();
-									subsystem->update();
-			}
+			m_scheduler.run(SystemManager::ref().m_subsystemPool);
 			on_subsystems_updated();
 		}
 
 		virtual void		on_uninstall() final override
 		{
 			on_start_uninstall();
+			m_scheduler.log_diagnostic();
 			for(auto& it : m_subsystems)
 			{
 				SystemInterface*	subsystem = it.get();
@@ -639,7 +1280,7 @@ namespace complex
 		CLASS_CTOR					PhaseSubSystem()
 			: ISubSystem(SystemManager::ref().m_labeler, MyNamedBase::typeName())
 		{
-
+			m_access = AccessSet::of<SubT>();
 		}
 
 	protected: // functions
@@ -699,99 +1340,21 @@ namespace complex
 	class	ParallelSystem<SysT, dpl::TypeList<SubTs...>> : public SupraSystem<SysT, dpl::TypeList<SubTs...>>
 	{
 	protected: // lifecycle
-		CLASS_CTOR	ParallelSystem() = default;
-	};
-}
-
-// tests
-namespace complex
-{
-	class SystemA : public PhaseSubSystem<SystemA>
-	{
-	public: // implementation
-		virtual void	on_update() final override
-		{
-			dpl::Logger::ref().push_info("A updated");
-		}
-	};
-
-	class SystemB : public PhaseSubSystem<SystemB>
-	{
-	public: // implementation
-		virtual void	on_update() final override
-		{
-			dpl::Logger::ref().push_info("B updated");
-		}
-	};
-
-	class SystemC : public PhaseSubSystem<SystemC>
-	{
-	public: // implementation
-		virtual void	on_update() final override
-		{
-			dpl::Logger::ref().push_info("C updated");
-		}
-	};
-
-	class SystemABC : public PhaseSystem<SystemABC, dpl::TypeList<SystemA, SystemB, SystemC>>{};
-
-	class SystemX : public ParallelSubSystem<SystemX>
-	{
-	public: // implementation
-		virtual void	on_update()
-		{
-			dpl::Logger::ref().push_info("X updated");
-		}
-	};
-
-	class SystemY : public ParallelSubSystem<SystemY>
-	{
-	public: // implementation
-		virtual void	on_update()
-		{
-			dpl::Logger::ref().push_info("Y updated");
-		}
-	};
-
-	class SystemZ : public ParallelSubSystem<SystemZ>
-	{
-	public: // implementation
-		virtual void	on_update()
-		{
-			dpl::Logger::ref().push_info("Z updated");
-		}
-	};
+		CLASS_CTOR		ParallelSystem() = default;
 
-	class SystemXYZ : public ParallelSystem<SystemXYZ, dpl::TypeList<SystemX, SystemY, SystemZ>>{};
-
-	class MyEngine : public SystemManager
-	{
-	public:
-		MyEngine()
-			: SystemManager("settings.bset")
+	public: // functions
+		inline double	get_tick_rate() const
 		{
-
+			return this->m_tickRate;
 		}
 
-		inline void start()
+	protected: // functions
+		/*
+			Sets number of updates per second, or 0 to update once per frame(default).
+		*/
+		inline void		set_tick_rate(	const double	HZ)
 		{
-			install_all_systems<dpl::TypeList<SystemABC>, dpl::TypeList<SystemXYZ>>();
-			update_all_systems();
-			uninstall_all_systems();
+			this->m_tickRate = std::max(HZ, 0.0);
 		}
 	};
-
-	inline void test_systems()
-	{
-		MyEngine	engine;
-					engine.start();
-
-		dpl::Logger& logger = engine.get_logger();
-		for(const auto& LINE : logger.lines())
-		{
-			std::cout << LINE.str << '\n';
-		}
-
-		int breakpoint = 0;
-	}
 }
\ No newline at end of file
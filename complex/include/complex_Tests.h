@@ -0,0 +1,20 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+namespace complex
+{
+	/*
+		Installs phase and parallel test systems, updates them once and prints the log.
+	*/
+	void test_systems();
+
+	/*
+		Headless run of the pipeline with a null renderer.
+		Simulation changes the live state while the renderer reads only the extracted snapshots.
+		Throws if the renderer sees data of another frame or the latency bound is broken.
+	*/
+	void test_frame_pipeline(	const uint64_t		NUM_FRAMES = 1000);
+}
\ No newline at end of file
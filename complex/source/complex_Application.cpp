@@ -110,9 +110,7 @@ namespace complex
 			try
 			{
 				update_states(get_logger());
-				update_all_systems();
-				update_events();
-				mainWindow()->update(*this);
+				flags().at(PIPELINED)? update_pipelined_frame() : update_serial_frame();
 			}
 			catch(const dpl::GeneralException& e)
 			{
@@ -132,6 +130,36 @@ namespace complex
 		return true;
 	}
 
+	void		Application::update_serial_frame()
+	{
+		m_framePipeline.submit_last_frame(); //<-- Pipelined mode could be disabled in the previous cycle.
+		update_all_systems();
+		update_events();
+		dispatcher.flush(); //<-- Deliver events queued during this cycle.
+		mainWindow()->update(*this);
+	}
+
+	void		Application::update_pipelined_frame()
+	{
+		m_framePipeline.run_frame([&]()
+		{
+			update_all_systems();
+		});
+
+		// SDL events and the main window(ImGui, GL) read the live state, so they stay on the main thread, after the sync point.
+		update_events();
+		dispatcher.flush();
+		mainWindow()->update(*this);
+	}
+
+	void		Application::enable_pipelined_frames(		const bool						bENABLE)
+	{
+		if(bENABLE && !m_framePipeline.is_ready())
+			throw dpl::GeneralException(this, __LINE__, "Pipelined frames require a frame renderer and at least one extractor.");
+
+		flags->set_at(PIPELINED, bENABLE); //<-- Takes effect in the next cycle.
+	}
+
 	void		Application::shutdown()
 	{
 		if(flags().at(WORKING))
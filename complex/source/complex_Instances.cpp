@@ -8,10 +8,11 @@ namespace complex
 	void	InstancePack::AttachmentOperation::attach(	InstancePack& pack)
 	{
 		auto& group = InstanceManager::ref().get_group(groupName);
-		if(complex::ss_size(state->binary) != 0)
+		if(!state->is_empty())
 		{
 			state->reset_in();
 			group.attach_instance_pack(pack, &state->binary);
+			state->release();
 		}
 		else
 		{
@@ -172,6 +173,14 @@ namespace complex
 		});
 	}
 
+	void			InstanceGroup::rearrange_instances(		const dpl::DeltaArray&		DELTA)
+	{
+		Chain::for_each([&](InstancePack& pack)
+		{
+			pack.rearrange_instances(DELTA);
+		});
+	}
+
 	void			InstanceGroup::import_all_from(			std::istream&				binaryState)
 	{
 		const auto				NUM_PACKS = dpl::import_t<uint32_t>(binaryState);
@@ -214,6 +223,95 @@ namespace complex
 	}
 }
 
+// InstanceGroup sort keys
+namespace complex
+{
+	/*
+		Inserts two zero bits between each of the lower 10 bits.
+	*/
+	static uint32_t	spread_bits(	uint32_t			value)
+	{
+		value = (value * 0x00010001u) & 0xFF0000FFu;
+		value = (value * 0x00000101u) & 0x0F00F00Fu;
+		value = (value * 0x00000011u) & 0xC30C30C3u;
+		value = (value * 0x00000005u) & 0x49249249u;
+		return value;
+	}
+
+	uint32_t		InstanceGroup::morton_key(				const glm::vec3&			POSITION,
+															const glm::vec3&			MIN,
+															const glm::vec3&			MAX)
+	{
+		const glm::vec3 EXTENT	= glm::max(MAX - MIN, glm::vec3(1e-6f));
+		const glm::vec3 CELL	= glm::clamp((POSITION - MIN) / EXTENT, 0.f, 1.f) * 1023.f;
+		return	spread_bits(static_cast<uint32_t>(CELL.x))
+			|	(spread_bits(static_cast<uint32_t>(CELL.y)) << 1)
+			|	(spread_bits(static_cast<uint32_t>(CELL.z)) << 2);
+	}
+
+	std::vector<uint32_t> InstanceGroup::sort_permutation(	const std::vector<uint32_t>&	KEYS)
+	{
+		const uint32_t			NUM_KEYS = static_cast<uint32_t>(KEYS.size());
+		std::vector<uint64_t>	items(NUM_KEYS); //<-- Key in the upper half, old index in the lower one.
+		std::vector<uint64_t>	sorted(NUM_KEYS);
+
+		for(uint32_t index = 0; index < NUM_KEYS; ++index)
+		{
+			items[index] = (static_cast<uint64_t>(KEYS[index]) << 32) | index;
+		}
+
+		for(uint32_t shift = 32; shift < 64; shift += 8) // LSD radix sort of the keys(stable).
+		{
+			uint32_t offsets[257] = {};
+			for(const uint64_t ITEM : items) ++offsets[((ITEM >> shift) & 0xFF) + 1];
+			if(std::find(std::begin(offsets), std::end(offsets), NUM_KEYS) != std::end(offsets)) continue; //<-- All keys have the same byte.
+
+			for(uint32_t digit = 1; digit < 257; ++digit) offsets[digit] += offsets[digit - 1];
+			for(const uint64_t ITEM : items) sorted[offsets[(ITEM >> shift) & 0xFF]++] = ITEM;
+			items.swap(sorted);
+		}
+
+		std::vector<uint32_t> newPositions(NUM_KEYS);
+		for(uint32_t newIndex = 0; newIndex < NUM_KEYS; ++newIndex)
+		{
+			newPositions[static_cast<uint32_t>(items[newIndex])] = newIndex;
+		}
+
+		return newPositions;
+	}
+
+	bool			InstanceGroup::is_permutation(			const std::vector<uint32_t>&	NEW_POSITIONS,
+															const uint32_t					NUM_INSTANCES)
+	{
+		if(NEW_POSITIONS.size() != NUM_INSTANCES) return false;
+
+		std::vector<bool> bTaken(NUM_INSTANCES, false);
+		for(const uint32_t NEW_POSITION : NEW_POSITIONS)
+		{
+			if(NEW_POSITION >= NUM_INSTANCES || bTaken[NEW_POSITION]) return false;
+			bTaken[NEW_POSITION] = true;
+		}
+
+		return true;
+	}
+
+	bool			InstanceGroup::reorder(					const std::vector<uint32_t>&	NEW_POSITIONS)
+	{
+		const uint32_t NUM_INSTANCES = query_numInstances();
+		if(!is_permutation(NEW_POSITIONS, NUM_INSTANCES)) return false;
+		if(NUM_INSTANCES < 2) return true;
+
+		dpl::DeltaArray delta(NUM_INSTANCES);
+		for(uint32_t oldIndex = 0; oldIndex < NUM_INSTANCES; ++oldIndex)
+		{
+			delta[oldIndex] = NEW_POSITIONS[oldIndex];
+		}
+
+		rearrange_instances(delta);
+		return true;
+	}
+}
+
 // InstanceGroup::CreateCommand
 namespace complex
 {
@@ -263,6 +361,7 @@ namespace complex
 			m_state.reset_in();
 			group.change_label(m_name);
 			group.import_all_from(m_state.binary);
+			m_state.release();
 		});
 	}
 }
@@ -303,10 +402,11 @@ namespace complex
 	{
 		auto& group = InstanceManager::ref().get_group(groupName);
 
-		if(complex::ss_size(state->binary) != 0)
+		if(!state->is_empty())
 		{
 			state->reset_in();
 			group.import_tail_from(state->binary);
+			state->release();
 		}
 		else
 		{
@@ -346,10 +446,11 @@ namespace complex
 	{
 		auto&	group = InstanceManager::ref().get_group(groupName);
 
-		if(complex::ss_size(state->binary) != 0)
+		if(!state->is_empty())
 		{
 			state->reset_in();
 			group.import_tail_from(state->binary);
+			state->release();
 		}
 		else // This should never happen!
 		{
@@ -385,6 +486,45 @@ namespace complex
 	}
 }
 
+// InstanceGroup::ReorderCommand
+namespace complex
+{
+	bool	InstanceGroup::ReorderCommand::valid() const
+	{
+		const auto* GROUP = InstanceManager::ref().find_group(groupName);
+		if(!GROUP) return dpl::Logger::ref().push_error("[Fail to reorder instances] Instance group could not be found: %s", groupName().c_str());
+		const uint32_t NUM_INSTANCES = GROUP->query_numInstances();
+		if(newPositions().size() != NUM_INSTANCES) return dpl::Logger::ref().push_error("[Fail to reorder instances] Invalid number of positions: %d", static_cast<uint32_t>(newPositions().size()));
+		if(!is_permutation(newPositions(), NUM_INSTANCES)) return dpl::Logger::ref().push_error("[Fail to reorder instances] Positions are not a permutation.");
+		return NUM_INSTANCES > 1;
+	}
+
+	void	InstanceGroup::ReorderCommand::execute()
+	{
+		dpl::DeltaArray delta(static_cast<uint32_t>(newPositions().size()));
+		fill_delta(delta, false);
+		InstanceManager::ref().get_group(groupName).rearrange_instances(delta);
+	}
+
+	void	InstanceGroup::ReorderCommand::unexecute()
+	{
+		dpl::DeltaArray delta(static_cast<uint32_t>(newPositions().size()));
+		fill_delta(delta, true);
+		InstanceManager::ref().get_group(groupName).rearrange_instances(delta);
+	}
+
+	void	InstanceGroup::ReorderCommand::fill_delta(	dpl::DeltaArray&	delta,
+														const bool			INVERSE) const
+	{
+		const auto& NEW_POSITIONS = newPositions();
+		for(uint32_t oldIndex = 0; oldIndex < NEW_POSITIONS.size(); ++oldIndex)
+		{
+			if(INVERSE)	delta[NEW_POSITIONS[oldIndex]]	= oldIndex;
+			else		delta[oldIndex]					= NEW_POSITIONS[oldIndex];
+		}
+	}
+}
+
 // InstanceGroup::DestroyInstanceCommand
 namespace complex
 {
@@ -409,10 +549,11 @@ namespace complex
 	{
 		auto&	group = InstanceManager::ref().get_group(groupName);
 
-		if(complex::ss_size(state->binary) != 0)
+		if(!state->is_empty())
 		{
 			state->reset_in();
 			group.import_tail_from(state->binary);
+			state->release();
 		}
 		else // This should never happen!
 		{
@@ -421,4 +562,36 @@ namespace complex
 
 		group.swap_instances(instanceIndex(), group.query_numInstances()-1);
 	}
+}
+
+// InstanceManager
+namespace complex
+{
+	void		InstanceManager::export_groups_to(		dpl::ChunkFileWriter&		writer)
+	{
+		DynamicOwner::for_each_property([&](InstanceGroup& group)
+		{
+			writer.add_chunk(GROUP_CHUNK_PREFIX + group.get_label(), [&group](std::ostream& binary)
+			{
+				group.export_all_to(binary);
+			});
+		});
+	}
+
+	uint32_t	InstanceManager::import_groups_from(	dpl::ChunkFileReader&		reader,
+														dpl::ThreadPool*			threadPool)
+	{
+		const size_t PREFIX_LENGTH = std::char_traits<char>::length(GROUP_CHUNK_PREFIX);
+		return reader.load_chunks(GROUP_CHUNK_PREFIX, [&](const dpl::ChunkInfo& INFO, std::istream& binary)
+		{
+			push_group([&](InstanceGroup& group)
+			{
+				const std::string NAME = INFO.name.substr(PREFIX_LENGTH);
+				if(!group.change_label(NAME))
+					dpl::Logger::ref().push_error("[Fail to import instance group] Name is already taken: %s, imported as: %s", NAME.c_str(), group.get_label().c_str());
+
+				group.import_all_from(binary);
+			});
+		}, threadPool);
+	}
 }
\ No newline at end of file
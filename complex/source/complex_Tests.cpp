@@ -0,0 +1,165 @@
+#include "..//include/complex_Tests.h"
+#include "..//include/complex_Systems.h"
+#include "..//include/complex_FramePipeline.h"
+#include <iostream>
+
+
+namespace complex
+{
+	namespace
+	{
+		namespace TestData
+		{
+			struct	Position{};
+			struct	Velocity{};
+			struct	AudioQueue{};
+		}
+
+		class SystemA : public PhaseSubSystem<SystemA>
+		{
+		public: // subtypes
+			using Access = dpl::TypeList<Reads<TestData::Velocity>, Writes<TestData::Position>>;
+
+		public: // implementation
+			virtual void	on_update() final override
+			{
+				dpl::Logger::ref().push_info("A updated");
+			}
+		};
+
+		class SystemB : public PhaseSubSystem<SystemB>
+		{
+		public: // subtypes
+			using Access = dpl::TypeList<Reads<TestData::Velocity>, Writes<TestData::AudioQueue>>;
+
+		public: // implementation
+			virtual void	on_update() final override
+			{
+				dpl::Logger::ref().push_info("B updated");
+			}
+		};
+
+		class SystemC : public PhaseSubSystem<SystemC>
+		{
+		public: // implementation
+			virtual void	on_update() final override
+			{
+				dpl::Logger::ref().push_info("C updated");
+			}
+		};
+
+		class SystemABC : public PhaseSystem<SystemABC, dpl::TypeList<SystemA, SystemB, SystemC>>{};
+
+		class SystemX : public ParallelSubSystem<SystemX>
+		{
+		public: // implementation
+			virtual void	on_update()
+			{
+				dpl::Logger::ref().push_info("X updated");
+			}
+		};
+
+		class SystemY : public ParallelSubSystem<SystemY>
+		{
+		public: // implementation
+			virtual void	on_update()
+			{
+				dpl::Logger::ref().push_info("Y updated");
+			}
+		};
+
+		class SystemZ : public ParallelSubSystem<SystemZ>
+		{
+		public: // implementation
+			virtual void	on_update()
+			{
+				dpl::Logger::ref().push_info("Z updated");
+			}
+		};
+
+		class SystemXYZ : public ParallelSystem<SystemXYZ, dpl::TypeList<SystemX, SystemY, SystemZ>>{};
+
+		class MyEngine : public SystemManager
+		{
+		public:
+			MyEngine()
+				: SystemManager("settings.bset")
+			{
+
+			}
+
+			inline void start()
+			{
+				install_all_systems<dpl::TypeList<SystemABC>, dpl::TypeList<SystemXYZ>>();
+				update_all_systems();
+				uninstall_all_systems();
+			}
+		};
+	}
+
+	void test_systems()
+	{
+		MyEngine	engine;
+					engine.start();
+
+		dpl::Logger& logger = engine.get_logger();
+		for(const auto& LINE : logger.lines())
+		{
+			std::cout << LINE.str << '\n';
+		}
+
+		int breakpoint = 0;
+	}
+
+	void test_frame_pipeline(	const uint64_t		NUM_FRAMES)
+	{
+		struct	Snapshot
+		{
+			uint64_t frame = 0;
+			uint64_t value = 0;
+		};
+
+		class	SnapshotRenderer : public NullFrameRenderer
+		{
+		public: // data
+			const FrameBuffered<Snapshot>* snapshots = nullptr;
+
+		public: // interface
+			virtual void	submit(		const uint64_t		FRAME) override
+			{
+				const Snapshot& SNAPSHOT = snapshots->read(FRAME);
+				if(SNAPSHOT.frame != FRAME || SNAPSHOT.value != FRAME * 3)
+					throw dpl::GeneralException(this, __LINE__, "Renderer read data of the frame: " + std::to_string(SNAPSHOT.frame));
+
+				NullFrameRenderer::submit(FRAME);
+			}
+		};
+
+		uint64_t					liveState = 0; // Written only by the simulation.
+		FrameBuffered<Snapshot>		snapshots;
+		SnapshotRenderer			renderer;
+		FramePipeline				pipeline;
+
+		renderer.snapshots = &snapshots;
+		pipeline.set_renderer(&renderer);
+		pipeline.add_extractor([&](const uint64_t FRAME)
+		{
+			snapshots.write(FRAME) = {FRAME, liveState};
+		});
+
+		for(uint64_t frameID = 0; frameID < NUM_FRAMES; ++frameID)
+		{
+			pipeline.run_frame([&]()
+			{
+				liveState += 3;
+			});
+
+			if(pipeline.get_latency() > FramePipeline::MAX_FRAME_LATENCY)
+				throw dpl::GeneralException(__FILE__, __LINE__, "Frame latency exceeded.");
+		}
+
+		pipeline.submit_last_frame();
+		if(renderer.numSubmitted() != NUM_FRAMES || renderer.lastFrame() != NUM_FRAMES || pipeline.get_latency() != 0)
+			throw dpl::GeneralException(__FILE__, __LINE__, "Not all frames were submitted.");
+	}
+}
\ No newline at end of file
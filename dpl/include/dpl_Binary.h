@@ -2,6 +2,10 @@
 
 
 #include <iostream>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include "dpl_ClassInfo.h"
 
 
 namespace dpl
@@ -118,4 +122,96 @@ namespace dpl
 		dpl::export_t(binary, SIZE);
 		dpl::export_t<typename ContainerT::value_type>(binary, SIZE, CONTAINER.data());
 	}
+
+
+	/*
+		Reads binary data directly from memory(e.g. mapped file or decompressed chunk).
+		Counterpart of the std::istream for trivially copyable types, arrays are read with a single memcpy.
+	*/
+	class ByteReader
+	{
+	private: // data
+		const uint8_t*	m_begin;
+		const uint8_t*	m_current;
+		const uint8_t*	m_end;
+		bool			bFailed;
+
+	public: // lifecycle
+		CLASS_CTOR				ByteReader(		const uint8_t*	DATA,
+												const size_t	SIZE)
+			: m_begin(DATA)
+			, m_current(DATA)
+			, m_end(DATA + SIZE)
+			, bFailed(false)
+		{
+
+		}
+
+	public: // functions
+		/*
+			Returns false if any read went past the end of the data.
+		*/
+		inline bool				good() const
+		{
+			return !bFailed;
+		}
+
+		inline size_t			position() const
+		{
+			return m_current - m_begin;
+		}
+
+		inline size_t			remaining() const
+		{
+			return m_end - m_current;
+		}
+
+		/*
+			Returns address of the next SIZE bytes and moves past them, or nullptr if there is not enough data.
+		*/
+		inline const uint8_t*	skip(			const size_t	SIZE)
+		{
+			if(bFailed || SIZE > remaining())
+			{
+				bFailed = true;
+				return nullptr;
+			}
+
+			const uint8_t* BYTES = m_current;
+			m_current += SIZE;
+			return BYTES;
+		}
+
+		inline bool				read(			void*			destination,
+												const size_t	SIZE)
+		{
+			const uint8_t* BYTES = skip(SIZE);
+			if(!BYTES) return false;
+			std::memcpy(destination, BYTES, SIZE);
+			return true;
+		}
+	};
+
+	template<typename T> requires std::is_trivially_copyable_v<T>
+	inline void				import_t(					ByteReader&				bytes,
+														T&						data)
+	{
+		bytes.read(&data, sizeof(T));
+	}
+
+	template<typename T> requires std::is_trivially_copyable_v<T>
+	inline void				import_t(					ByteReader&				bytes,
+														const size_t			SIZE,
+														T*						data)
+	{
+		bytes.read(data, SIZE * sizeof(T));
+	}
+
+	template<typename T> requires std::is_trivially_copyable_v<T>
+	inline T				import_t(					ByteReader&				bytes)
+	{
+		T data{};
+		bytes.read(&data, sizeof(T));
+		return data;
+	}
 }
\ No newline at end of file
@@ -302,6 +302,10 @@ namespace dpl
 				const uint32_t NEW_INDEX = DELTA[oldIndex];
 				source.throw_if_invalid_index(NEW_INDEX);
 				Buffer::construct_at(NEW_INDEX, std::move(source.at(oldIndex)));
+				if constexpr (!std::is_trivially_destructible_v<T>)
+				{
+					source.destroy_at(oldIndex);
+				}
 			}
 		}
 
@@ -0,0 +1,289 @@
+#pragma once
+
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <cstring>
+#include <climits>
+#include <iostream>
+#include <stdint.h>
+#include "dpl_ClassInfo.h"
+
+
+namespace dpl
+{
+	/*
+		Pool of byte buffers reused by the binary states(e.g. states of the undoable commands).
+		Buffers are grouped by power of two capacity, so released buffer can be reused by any state of similar size.
+		Buffers above the pooling limit are freed immediately.
+	*/
+	class BytePool
+	{
+	public: // subtypes
+		using	Bytes		= std::vector<uint8_t>;
+
+	public: // constants
+		static const uint32_t	MIN_EXPONENT		= 8;
+		static const uint32_t	NUM_BUCKETS			= 40;
+		static const uint64_t	MAX_POOLED_BYTES	= 64 * 1024 * 1024;
+
+	private: // data
+		mutable std::mutex							m_mtx;
+		std::array<std::vector<Bytes>, NUM_BUCKETS>	m_buckets;
+		uint64_t									m_numPooledBytes;
+
+	private: // lifecycle
+		CLASS_CTOR				BytePool()
+			: m_numPooledBytes(0)
+		{
+
+		}
+
+		CLASS_CTOR				BytePool(		const BytePool&		OTHER) = delete;
+
+		BytePool&				operator=(		const BytePool&		OTHER) = delete;
+
+	public: // functions
+		/*
+			Pool is never destroyed, so states of the static objects can still release their buffers at exit.
+		*/
+		static inline BytePool&	ref()
+		{
+			static BytePool* pool = new BytePool();
+			return *pool;
+		}
+
+		inline uint64_t			get_numPooledBytes() const
+		{
+			std::lock_guard lock(m_mtx);
+			return m_numPooledBytes;
+		}
+
+		/*
+			Returns buffer with size of at least MIN_SIZE bytes(size of the buffer is its capacity).
+		*/
+		Bytes					acquire(		const size_t		MIN_SIZE)
+		{
+			const uint32_t BUCKET = bucket_of(MIN_SIZE);
+			{std::lock_guard lock(m_mtx);
+				if(BUCKET < NUM_BUCKETS && !m_buckets[BUCKET].empty())
+				{
+					Bytes bytes = std::move(m_buckets[BUCKET].back());
+					m_buckets[BUCKET].pop_back();
+					m_numPooledBytes -= bytes.size();
+					return bytes;
+				}
+			}
+
+			return Bytes(size_t(1) << (BUCKET + MIN_EXPONENT));
+		}
+
+		void					release(		Bytes&&				bytes)
+		{
+			const size_t SIZE = bytes.size();
+			if(SIZE == 0) return;
+
+			const uint32_t BUCKET = bucket_of(SIZE);
+			if(BUCKET < NUM_BUCKETS && (size_t(1) << (BUCKET + MIN_EXPONENT)) == SIZE)
+			{
+				std::lock_guard lock(m_mtx);
+				if(m_numPooledBytes + SIZE <= MAX_POOLED_BYTES)
+				{
+					m_numPooledBytes += SIZE;
+					m_buckets[BUCKET].push_back(std::move(bytes));
+				}
+			}
+
+			Bytes().swap(bytes);
+		}
+
+		/*
+			Frees all pooled buffers.
+		*/
+		void					clear()
+		{
+			std::lock_guard lock(m_mtx);
+			for(auto& bucket : m_buckets) bucket.clear();
+			m_numPooledBytes = 0;
+		}
+
+	private: // functions
+		static inline uint32_t	bucket_of(		const size_t		SIZE)
+		{
+			uint32_t bucket = 0;
+			while((size_t(1) << (bucket + MIN_EXPONENT)) < SIZE) ++bucket;
+			return bucket;
+		}
+	};
+
+
+	/*
+		Binary stream that writes into the buffer from the BytePool.
+		Unlike std::stringstream, written bytes are read in place(no copy of the whole state),
+		and the buffer returns to the pool when the state is no longer needed.
+
+		Usage:
+			stream.reset_out();	<-- Before export.
+			stream.reset_in();	<-- Before import.
+			stream.release();	<-- When the state was consumed.
+	*/
+	class PooledStream : public std::iostream
+	{
+	private: // subtypes
+		class	Buffer : public std::streambuf
+		{
+		private: // data
+			BytePool::Bytes	m_bytes;
+			size_t			m_size; // Number of bytes written before the last reset_in.
+
+		public: // lifecycle
+			CLASS_CTOR				Buffer()
+				: m_size(0)
+			{
+
+			}
+
+			CLASS_DTOR				~Buffer()
+			{
+				release();
+			}
+
+		public: // functions
+			inline size_t			size() const
+			{
+				return pbase()? static_cast<size_t>(pptr() - pbase()) : m_size;
+			}
+
+			inline size_t			capacity() const
+			{
+				return m_bytes.size();
+			}
+
+			inline void				reset_out()
+			{
+				m_size = 0;
+				setg(nullptr, nullptr, nullptr);
+				setp(begin(), begin() + capacity());
+			}
+
+			inline void				reset_in()
+			{
+				m_size = size();
+				setp(nullptr, nullptr);
+				setg(begin(), begin(), begin() + m_size);
+			}
+
+			inline void				release()
+			{
+				setp(nullptr, nullptr);
+				setg(nullptr, nullptr, nullptr);
+				BytePool::ref().release(std::move(m_bytes));
+				m_size = 0;
+			}
+
+		protected: // streambuf
+			virtual int_type		overflow(		int_type			character) override
+			{
+				if(traits_type::eq_int_type(character, traits_type::eof())) return traits_type::not_eof(character);
+				if(!pbase()) reset_out();
+				grow(size() + 1);
+				*pptr() = traits_type::to_char_type(character);
+				pbump(1);
+				return character;
+			}
+
+			virtual std::streamsize	xsputn(			const char_type*	CHARACTERS,
+													std::streamsize		count) override
+			{
+				if(count <= 0) return 0;
+				if(!pbase()) reset_out();
+				if(epptr() - pptr() < count) grow(size() + count);
+				std::memcpy(pptr(), CHARACTERS, count);
+				advance(count);
+				return count;
+			}
+
+		private: // functions
+			inline char*			begin()
+			{
+				return reinterpret_cast<char*>(m_bytes.data());
+			}
+
+			/*
+				Moves written bytes to the larger buffer.
+			*/
+			void					grow(			const size_t		MIN_CAPACITY)
+			{
+				const size_t	WRITTEN		= size();
+				BytePool::Bytes	newBytes	= BytePool::ref().acquire(std::max(MIN_CAPACITY, 2 * capacity()));
+				if(WRITTEN > 0) std::memcpy(newBytes.data(), m_bytes.data(), WRITTEN);
+				BytePool::ref().release(std::move(m_bytes));
+				m_bytes = std::move(newBytes);
+				setp(begin(), begin() + capacity());
+				advance(WRITTEN);
+			}
+
+			inline void				advance(		size_t				count)
+			{
+				for(; count > INT_MAX; count -= INT_MAX) pbump(INT_MAX);
+				pbump(static_cast<int>(count));
+			}
+		};
+
+	private: // data
+		Buffer m_buffer;
+
+	public: // lifecycle
+		CLASS_CTOR				PooledStream()
+			: std::iostream(nullptr)
+		{
+			rdbuf(&m_buffer);
+		}
+
+		CLASS_CTOR				PooledStream(	const PooledStream&	OTHER) = delete;
+
+		PooledStream&			operator=(		const PooledStream&	OTHER) = delete;
+
+	public: // functions
+		/*
+			Returns number of bytes written since the last reset_out.
+		*/
+		inline size_t			size() const
+		{
+			return m_buffer.size();
+		}
+
+		inline bool				empty() const
+		{
+			return size() == 0;
+		}
+
+		inline size_t			capacity() const
+		{
+			return m_buffer.capacity();
+		}
+
+		inline void				reset_out()
+		{
+			m_buffer.reset_out();
+			clear();
+		}
+
+		inline void				reset_in()
+		{
+			m_buffer.reset_in();
+			clear();
+		}
+
+		/*
+			Returns buffer to the pool, stream becomes empty.
+		*/
+		inline void				release()
+		{
+			m_buffer.release();
+			clear();
+		}
+	};
+}
\ No newline at end of file
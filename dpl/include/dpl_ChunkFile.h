@@ -0,0 +1,651 @@
+#pragma once
+
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include "dpl_Binary.h"
+#include "dpl_MappedFile.h"
+#include "dpl_ThreadPool.h"
+#include "dpl_GeneralException.h"
+
+
+namespace dpl
+{
+	/*
+		LZ77 block codec in the spirit of LZ4(byte-aligned sequences, no entropy coding).
+		Designed for fast decompression of binary states rather than for the compression ratio.
+
+		Sequence:
+			token				[4 bits: number of literals, 4 bits: match length - MIN_MATCH]
+			literal length		[optional bytes of 255 ended with smaller one, when the nibble is 15]
+			literals
+			offset				[2 bytes, little endian]
+			match length		[optional bytes of 255 ended with smaller one, when the nibble is 15]
+
+		The last sequence contains only literals.
+	*/
+	class BlockCodec
+	{
+	public: // constants
+		static constexpr uint32_t	MIN_MATCH		= 4;
+		static constexpr uint32_t	LAST_LITERALS	= 5;		// Number of bytes at the end of the block that are never matched.
+		static constexpr uint32_t	MAX_OFFSET		= 0xFFFF;
+		static constexpr uint32_t	MAX_RATIO		= 255;		// Each byte of the block decompresses to at most that many bytes.
+		static constexpr uint32_t	HASH_BITS		= 12;
+		static constexpr uint32_t	INVALID_POS		= 0xFFFFFFFF;
+
+	public: // functions
+		/*
+			Appends compressed block to the output and returns its size.
+		*/
+		static size_t			compress(			const uint8_t*			SOURCE,
+													const size_t			SIZE,
+													std::vector<uint8_t>&	output)
+		{
+			const size_t			FIRST	= output.size();
+			std::vector<uint32_t>	table(1 << HASH_BITS, INVALID_POS);
+			size_t					anchor	= 0;
+			size_t					pos		= 0;
+
+			if(SIZE >= MIN_MATCH + LAST_LITERALS)
+			{
+				const size_t LIMIT = SIZE - LAST_LITERALS;
+				while(pos + MIN_MATCH <= LIMIT)
+				{
+					const uint32_t	SEQUENCE	= read32(SOURCE + pos);
+					uint32_t&		entry		= table[hash(SEQUENCE)];
+					const uint32_t	CANDIDATE	= entry;
+									entry		= static_cast<uint32_t>(pos);
+
+					if(CANDIDATE == INVALID_POS || pos - CANDIDATE > MAX_OFFSET || read32(SOURCE + CANDIDATE) != SEQUENCE)
+					{
+						++pos;
+						continue;
+					}
+
+					size_t length = MIN_MATCH;
+					while(pos + length < LIMIT && SOURCE[CANDIDATE + length] == SOURCE[pos + length]) ++length;
+
+					write_sequence(SOURCE + anchor, pos - anchor, pos - CANDIDATE, length, output);
+					pos		+= length;
+					anchor	= pos;
+				}
+			}
+
+			write_sequence(SOURCE + anchor, SIZE - anchor, 0, 0, output);
+			return output.size() - FIRST;
+		}
+
+		/*
+			Returns false if the block is corrupted or does not decompress to exactly RAW_SIZE bytes.
+		*/
+		static bool				decompress(			const uint8_t*			SOURCE,
+													const size_t			SIZE,
+													uint8_t*				destination,
+													const size_t			RAW_SIZE)
+		{
+			size_t in	= 0;
+			size_t out	= 0;
+
+			while(in < SIZE)
+			{
+				const uint8_t	TOKEN		= SOURCE[in++];
+				size_t			numLiterals	= TOKEN >> 4;
+				if(numLiterals == 15 && !read_length(SOURCE, SIZE, in, numLiterals)) return false;
+				if(in + numLiterals > SIZE || out + numLiterals > RAW_SIZE) return false;
+
+				if(numLiterals) std::memcpy(destination + out, SOURCE + in, numLiterals);
+				in	+= numLiterals;
+				out	+= numLiterals;
+				if(in == SIZE) break; // Last sequence.
+
+				if(in + 2 > SIZE) return false;
+				const size_t OFFSET = SOURCE[in] | (SOURCE[in + 1] << 8);
+				in += 2;
+				if(OFFSET == 0 || OFFSET > out) return false;
+
+				size_t length = TOKEN & 15;
+				if(length == 15 && !read_length(SOURCE, SIZE, in, length)) return false;
+				length += MIN_MATCH;
+				if(out + length > RAW_SIZE) return false;
+
+				const uint8_t* match = destination + out - OFFSET;
+				for(size_t index = 0; index < length; ++index) // Byte by byte, since the match may overlap the output.
+				{
+					destination[out + index] = match[index];
+				}
+
+				out += length;
+			}
+
+			return out == RAW_SIZE;
+		}
+
+	private: // functions
+		static inline uint32_t	read32(				const uint8_t*			ADDRESS)
+		{
+			uint32_t value;
+			std::memcpy(&value, ADDRESS, sizeof(uint32_t));
+			return value;
+		}
+
+		static inline uint32_t	hash(				const uint32_t			SEQUENCE)
+		{
+			return (SEQUENCE * 2654435761u) >> (32 - HASH_BITS);
+		}
+
+		static inline void		write_length(		size_t					length,
+													std::vector<uint8_t>&	output)
+		{
+			for(; length >= 255; length -= 255) output.push_back(255);
+			output.push_back(static_cast<uint8_t>(length));
+		}
+
+		static inline bool		read_length(		const uint8_t*			SOURCE,
+													const size_t			SIZE,
+													size_t&					in,
+													size_t&					length)
+		{
+			uint8_t next;
+			do
+			{
+				if(in >= SIZE) return false;
+				next	= SOURCE[in++];
+				length	+= next;
+			}
+			while(next == 255);
+			return true;
+		}
+
+		/*
+			Match length equal to 0 marks the last sequence(literals only).
+		*/
+		static void				write_sequence(		const uint8_t*			LITERALS,
+													const size_t			NUM_LITERALS,
+													const size_t			OFFSET,
+													const size_t			LENGTH,
+													std::vector<uint8_t>&	output)
+		{
+			const size_t MATCH_CODE = (LENGTH > 0)? LENGTH - MIN_MATCH : 0;
+			output.push_back(static_cast<uint8_t>((std::min<size_t>(NUM_LITERALS, 15) << 4) | std::min<size_t>(MATCH_CODE, 15)));
+			if(NUM_LITERALS >= 15) write_length(NUM_LITERALS - 15, output);
+			output.insert(output.end(), LITERALS, LITERALS + NUM_LITERALS);
+			if(LENGTH == 0) return;
+
+			output.push_back(static_cast<uint8_t>(OFFSET & 0xFF));
+			output.push_back(static_cast<uint8_t>(OFFSET >> 8));
+			if(MATCH_CODE >= 15) write_length(MATCH_CODE - 15, output);
+		}
+	};
+
+
+	/*
+		Description of the chunk stored in the table of contents.
+	*/
+	struct	ChunkInfo
+	{
+		enum	Flags : uint32_t
+		{
+			COMPRESSED = 1 << 0
+		};
+
+		std::string	name;
+		uint64_t	offset		= 0;	// From the beginning of the file.
+		uint64_t	storedSize	= 0;	// Number of bytes in the file.
+		uint64_t	rawSize		= 0;	// Number of bytes after decompression.
+		uint32_t	flags		= 0;
+
+		static constexpr uint64_t MIN_EXPORTED_SIZE = sizeof(std::string::size_type) + 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+		inline bool	is_compressed() const
+		{
+			return (flags & COMPRESSED) != 0;
+		}
+
+		/*
+			Returns true if the chunk lies between DATA_BEGIN and FILE_SIZE and its raw size is reachable from the stored one.
+		*/
+		inline bool	is_within(		const uint64_t	DATA_BEGIN,
+									const uint64_t	FILE_SIZE) const
+		{
+			if(offset < DATA_BEGIN || offset > FILE_SIZE || storedSize > FILE_SIZE - offset) return false;
+			return is_compressed()? rawSize / BlockCodec::MAX_RATIO <= storedSize : rawSize == storedSize;
+		}
+
+		/*
+			Sets failbit of the stream if the name is longer than MAX_NAME_SIZE(it is not allocated then).
+		*/
+		void		import_from(	std::istream&	binary,
+									const uint64_t	MAX_NAME_SIZE)
+		{
+			const auto NAME_SIZE = dpl::import_t<std::string::size_type>(binary);
+			if(!binary.good() || NAME_SIZE > MAX_NAME_SIZE)
+			{
+				binary.setstate(std::ios::failbit);
+				return;
+			}
+
+			name.resize(NAME_SIZE);
+			dpl::import_t(binary, NAME_SIZE, name.data());
+			dpl::import_t(binary, offset);
+			dpl::import_t(binary, storedSize);
+			dpl::import_t(binary, rawSize);
+			dpl::import_t(binary, flags);
+		}
+
+		void		export_to(		std::ostream&	binary) const
+		{
+			dpl::export_container(binary, name);
+			dpl::export_t(binary, offset);
+			dpl::export_t(binary, storedSize);
+			dpl::export_t(binary, rawSize);
+			dpl::export_t(binary, flags);
+		}
+	};
+
+
+	/*
+		File layout:
+			header				[MAGIC, VERSION, number of chunks, size of the table of contents]
+			table of contents	[ChunkInfo per chunk]
+			chunks				[stored one after another]
+
+		Table of contents is placed right after the header, so any chunk can be read without scanning the file.
+	*/
+	struct	ChunkFile
+	{
+		static constexpr uint32_t MAGIC			= 0x4B484344; // "DCHK"
+		static constexpr uint32_t VERSION		= 1;
+		static constexpr uint64_t HEADER_SIZE	= 4 * sizeof(uint32_t);
+	};
+
+
+	/*
+		Collects exporters of the named chunks and writes them to a single file.
+
+		Exporters are called on the thread that calls 'save'(they may read state owned by it, e.g. transferred buffers),
+		only compression of the exported chunks runs in parallel when thread pool is given.
+		Data referenced by the exporters must stay valid until 'save' returns.
+	*/
+	class ChunkFileWriter
+	{
+	public: // subtypes
+		using	Exporter = std::function<void(std::ostream&)>;
+
+	private: // subtypes
+		struct	Pending
+		{
+			ChunkInfo				info;
+			Exporter				exporter;
+			std::string				raw;
+			std::vector<uint8_t>	stored;
+		};
+
+	private: // data
+		std::vector<Pending> m_chunks;
+
+	public: // functions
+		inline uint32_t		get_numChunks() const
+		{
+			return static_cast<uint32_t>(m_chunks.size());
+		}
+
+		/*
+			Chunk is compressed only if that makes it smaller.
+		*/
+		void				add_chunk(		const std::string&	NAME,
+											const Exporter&		EXPORTER,
+											const bool			COMPRESS = true)
+		{
+			for(const Pending& CHUNK : m_chunks)
+			{
+				if(CHUNK.info.name == NAME) throw GeneralException(this, __LINE__, "Chunk already exists: " + NAME);
+			}
+
+			Pending& chunk = m_chunks.emplace_back();
+			chunk.info.name		= NAME;
+			chunk.info.flags	= COMPRESS? ChunkInfo::COMPRESSED : 0;
+			chunk.exporter		= EXPORTER;
+		}
+
+		/*
+			Writes all chunks and removes them from the writer.
+			Returns false if the file could not be written.
+		*/
+		bool				save(			const std::string&	FILE_PATH,
+											ThreadPool*			threadPool = nullptr)
+		{
+			for(Pending& chunk : m_chunks) serialize(chunk);
+
+			if(threadPool && m_chunks.size() > 1)
+			{
+				for(Pending& chunk : m_chunks)
+				{
+					threadPool->add_task([&chunk](){encode(chunk);});
+				}
+
+				threadPool->wait();
+			}
+			else
+			{
+				for(Pending& chunk : m_chunks) encode(chunk);
+			}
+
+			std::stringstream toc;
+			for(const Pending& CHUNK : m_chunks) CHUNK.info.export_to(toc);
+
+			// Offsets do not change the size of the table of contents, so it can be written twice.
+			uint64_t offset = ChunkFile::HEADER_SIZE + toc.str().size();
+			toc.str(std::string());
+			for(Pending& chunk : m_chunks)
+			{
+				chunk.info.offset	= offset;
+				offset				+= chunk.info.storedSize;
+				chunk.info.export_to(toc);
+			}
+
+			std::ofstream file(FILE_PATH, std::ios::binary | std::ios::trunc);
+			if(file.fail() || file.bad()) return false;
+
+			const std::string TOC = toc.str();
+			dpl::export_t(file, ChunkFile::MAGIC);
+			dpl::export_t(file, ChunkFile::VERSION);
+			dpl::export_t(file, static_cast<uint32_t>(m_chunks.size()));
+			dpl::export_t(file, static_cast<uint32_t>(TOC.size()));
+			file.write(TOC.data(), TOC.size());
+			for(const Pending& CHUNK : m_chunks)
+			{
+				file.write(reinterpret_cast<const char*>(CHUNK.stored.data()), CHUNK.stored.size());
+			}
+
+			m_chunks.clear();
+			return file.good();
+		}
+
+	private: // functions
+		static void			serialize(		Pending&			chunk)
+		{
+			std::stringstream binary;
+			chunk.exporter(binary);
+			chunk.raw			= binary.str();
+			chunk.info.rawSize	= chunk.raw.size();
+		}
+
+		/*
+			Touches only the chunk, so chunks can be encoded in parallel.
+		*/
+		static void			encode(			Pending&			chunk)
+		{
+			const std::string RAW = std::move(chunk.raw);
+
+			if(chunk.info.is_compressed())
+			{
+				chunk.stored.reserve(RAW.size());
+				BlockCodec::compress(reinterpret_cast<const uint8_t*>(RAW.data()), RAW.size(), chunk.stored);
+				if(chunk.stored.size() >= RAW.size()) chunk.info.flags &= ~ChunkInfo::COMPRESSED;
+			}
+
+			if(!chunk.info.is_compressed())
+			{
+				chunk.stored.assign(RAW.begin(), RAW.end());
+			}
+
+			chunk.info.storedSize = chunk.stored.size();
+		}
+	};
+
+
+	/*
+		Reads table of contents on open, chunks are read only when requested.
+
+		When the file is mapped, uncompressed chunks can be read in place(see 'read_chunk'),
+		which lets trivially copyable arrays be imported with a single copy from the mapped pages.
+	*/
+	class ChunkFileReader
+	{
+	public: // subtypes
+		using	Importer		= std::function<void(std::istream&)>;
+		using	NamedImporter	= std::function<void(const ChunkInfo&, std::istream&)>;
+		using	Reader			= std::function<void(ByteReader&)>;
+
+	private: // data
+		std::ifstream			m_file;
+		uint64_t				m_fileSize = 0;
+		MappedFile				m_mapping;
+		std::vector<ChunkInfo>	m_chunks;
+
+	public: // lifecycle
+		CLASS_CTOR				ChunkFileReader() = default;
+
+		CLASS_CTOR				ChunkFileReader(const ChunkFileReader&	OTHER) = delete;
+
+		ChunkFileReader&		operator=(		const ChunkFileReader&	OTHER) = delete;
+
+	public: // functions
+		/*
+			Returns false if the file could not be opened, or it is not a chunk file.
+			Table of contents is validated against the file size, so corrupted files never cause oversized allocations.
+			File is also mapped into memory if MAP is true.
+		*/
+		bool					open(			const std::string&		FILE_PATH,
+												const bool				MAP = false)
+		{
+			close();
+			m_file.open(FILE_PATH, std::ios::binary);
+			if(m_file.fail() || m_file.bad()) return false;
+
+			m_file.seekg(0, std::ios::end);
+			m_fileSize = static_cast<uint64_t>(m_file.tellg());
+			m_file.seekg(0, std::ios::beg);
+
+			const uint32_t MAGIC		= dpl::import_t<uint32_t>(m_file);
+			const uint32_t VERSION		= dpl::import_t<uint32_t>(m_file);
+			const uint32_t NUM_CHUNKS	= dpl::import_t<uint32_t>(m_file);
+			const uint32_t TOC_SIZE		= dpl::import_t<uint32_t>(m_file);
+			const uint64_t TOC_END		= ChunkFile::HEADER_SIZE + uint64_t(TOC_SIZE);
+			if(!m_file.good() || MAGIC != ChunkFile::MAGIC || VERSION != ChunkFile::VERSION
+				|| TOC_END > m_fileSize || NUM_CHUNKS > TOC_SIZE / ChunkInfo::MIN_EXPORTED_SIZE)
+			{
+				close();
+				return false;
+			}
+
+			m_chunks.resize(NUM_CHUNKS);
+			for(ChunkInfo& chunk : m_chunks)
+			{
+				const uint64_t POSITION = static_cast<uint64_t>(m_file.tellg());
+				chunk.import_from(m_file, (POSITION < TOC_END)? TOC_END - POSITION : 0);
+				if(!m_file.good() || !chunk.is_within(TOC_END, m_fileSize))
+				{
+					close();
+					return false;
+				}
+			}
+
+			if(MAP && !m_mapping.open(FILE_PATH))
+			{
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		inline void				close()
+		{
+			if(m_file.is_open()) m_file.close();
+			m_file.clear();
+			m_fileSize = 0;
+			m_mapping.close();
+			m_chunks.clear();
+		}
+
+		inline bool				is_open() const
+		{
+			return m_file.is_open();
+		}
+
+		inline bool				is_mapped() const
+		{
+			return m_mapping.is_open();
+		}
+
+		inline uint32_t			get_numChunks() const
+		{
+			return static_cast<uint32_t>(m_chunks.size());
+		}
+
+		inline const ChunkInfo&	get_chunk_info(	const uint32_t			INDEX) const
+		{
+			return m_chunks[INDEX];
+		}
+
+		inline const ChunkInfo*	find_chunk(		const std::string&		NAME) const
+		{
+			auto it = std::find_if(m_chunks.begin(), m_chunks.end(), [&](const ChunkInfo& INFO){return INFO.name == NAME;});
+			return (it != m_chunks.end())? &(*it) : nullptr;
+		}
+
+		/*
+			Reads and decompresses single chunk.
+			Returns false if chunk was not found or is corrupted.
+		*/
+		bool					load_chunk(		const std::string&		NAME,
+												const Importer&			IMPORTER)
+		{
+			const ChunkInfo* INFO = find_chunk(NAME);
+			if(!INFO) return false;
+
+			std::vector<uint8_t>	stored;
+			std::string				raw;
+			if(!read_stored(*INFO, stored) || !decode(*INFO, stored, raw)) return false;
+
+			std::istringstream binary(std::move(raw));
+			IMPORTER(binary);
+			return true;
+		}
+
+		/*
+			Gives direct access to the bytes of the chunk.
+			Uncompressed chunks of the mapped file are not copied, otherwise chunk is read(and decompressed) into temporary buffer.
+			Returns false if chunk was not found or is corrupted.
+		*/
+		bool					read_chunk(		const std::string&		NAME,
+												const Reader&			READER)
+		{
+			const ChunkInfo* INFO = find_chunk(NAME);
+			if(!INFO) return false;
+
+			if(is_mapped() && !INFO->is_compressed())
+			{
+				if(!INFO->is_within(0, m_mapping.size())) return false;
+				ByteReader bytes(m_mapping.data() + INFO->offset, INFO->storedSize);
+				READER(bytes);
+				return true;
+			}
+
+			std::vector<uint8_t>	stored;
+			std::string				raw;
+			if(!read_stored(*INFO, stored) || !decode(*INFO, stored, raw)) return false;
+
+			ByteReader bytes(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+			READER(bytes);
+			return true;
+		}
+
+		/*
+			Loads all chunks whose names start with the given prefix.
+			Chunks are read sequentially, decompressed in parallel(if thread pool is given)
+			and imported in the order of the table of contents on the calling thread.
+			Returns number of imported chunks.
+		*/
+		uint32_t				load_chunks(	const std::string&		PREFIX,
+												const NamedImporter&	IMPORTER,
+												ThreadPool*				threadPool = nullptr)
+		{
+			std::vector<const ChunkInfo*>		selected;
+			for(const ChunkInfo& INFO : m_chunks)
+			{
+				if(INFO.name.compare(0, PREFIX.size(), PREFIX) == 0) selected.push_back(&INFO);
+			}
+
+			std::vector<std::vector<uint8_t>>	stored(selected.size());
+			std::vector<std::string>			raw(selected.size());
+			std::vector<char>					valid(selected.size(), 0);
+			for(size_t index = 0; index < selected.size(); ++index)
+			{
+				valid[index] = read_stored(*selected[index], stored[index]);
+			}
+
+			auto decode_at = [&](const size_t INDEX)
+			{
+				if(valid[INDEX]) valid[INDEX] = decode(*selected[INDEX], stored[INDEX], raw[INDEX]);
+				stored[INDEX] = std::vector<uint8_t>();
+			};
+
+			if(threadPool && selected.size() > 1)
+			{
+				for(size_t index = 0; index < selected.size(); ++index)
+				{
+					threadPool->add_task([&, index](){decode_at(index);});
+				}
+
+				threadPool->wait();
+			}
+			else
+			{
+				for(size_t index = 0; index < selected.size(); ++index) decode_at(index);
+			}
+
+			uint32_t numLoaded = 0;
+			for(size_t index = 0; index < selected.size(); ++index)
+			{
+				if(!valid[index]) continue;
+				std::istringstream binary(std::move(raw[index]));
+				IMPORTER(*selected[index], binary);
+				++numLoaded;
+			}
+
+			return numLoaded;
+		}
+
+	private: // functions
+		bool					read_stored(	const ChunkInfo&		INFO,
+												std::vector<uint8_t>&	stored)
+		{
+			if(!INFO.is_within(0, is_mapped()? m_mapping.size() : m_fileSize)) return false;
+
+			stored.resize(INFO.storedSize);
+			if(is_mapped())
+			{
+				std::memcpy(stored.data(), m_mapping.data() + INFO.offset, INFO.storedSize);
+				return true;
+			}
+
+			m_file.clear();
+			m_file.seekg(INFO.offset);
+			m_file.read(reinterpret_cast<char*>(stored.data()), INFO.storedSize);
+			return m_file.good();
+		}
+
+		static bool				decode(			const ChunkInfo&			INFO,
+												const std::vector<uint8_t>&	STORED,
+												std::string&				raw)
+		{
+			if(!INFO.is_compressed())
+			{
+				raw.assign(STORED.begin(), STORED.end());
+				return true;
+			}
+
+			raw.resize(INFO.rawSize);
+			return BlockCodec::decompress(STORED.data(), STORED.size(), reinterpret_cast<uint8_t*>(raw.data()), INFO.rawSize);
+		}
+	};
+}
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <limits>
 #include "dpl_DynamicArray.h"
 #include "dpl_Chain.h"
 #include "dpl_Mask.h"
@@ -31,6 +35,112 @@ namespace dpl
 	};
 
 
+	/*
+		Sorted set of disjoint ranges of modified elements.
+		Ranges closer than MERGE_DISTANCE are coalesced and the number of ranges is limited(ranges with the smallest gap are merged),
+		so the flush never issues more than MAX_RANGES transfers.
+		Note: Not thread-safe, TransferablePack marks ranges under its lock.
+	*/
+	class	DirtyRanges
+	{
+	public: // subtypes
+		using	Range	= dpl::IndexRange<uint32_t>;
+
+	public: // constants
+		static const uint32_t MAX_RANGES		= 16;
+		static const uint32_t MERGE_DISTANCE	= 16; // Number of clean elements between ranges that is cheaper to transfer than to split.
+
+	private: // data
+		std::vector<Range>	m_ranges;
+		bool				bWhole;
+
+	public: // lifecycle
+		CLASS_CTOR						DirtyRanges()
+			: bWhole(false)
+		{
+
+		}
+
+	public: // functions
+		inline bool						empty() const
+		{
+			return !bWhole && m_ranges.empty();
+		}
+
+		inline bool						is_whole() const
+		{
+			return bWhole;
+		}
+
+		inline const std::vector<Range>&	ranges() const
+		{
+			return m_ranges;
+		}
+
+		inline void						mark_whole()
+		{
+			bWhole = true;
+			m_ranges.clear();
+		}
+
+		void							mark(			const uint32_t		BEGIN,
+														const uint32_t		END)
+		{
+			if(bWhole || BEGIN >= END) return;
+
+			uint32_t	newBegin	= BEGIN;
+			uint32_t	newEnd		= END;
+			auto		first		= std::lower_bound(m_ranges.begin(), m_ranges.end(), BEGIN, [](const Range& RANGE, const uint32_t INDEX)
+			{
+				return RANGE.end() + MERGE_DISTANCE < INDEX;
+			});
+
+			auto last = first;
+			while(last != m_ranges.end() && last->begin() <= END + MERGE_DISTANCE)
+			{
+				newBegin	= std::min(newBegin, last->begin());
+				newEnd		= std::max(newEnd, last->end());
+				++last;
+			}
+
+			first = m_ranges.erase(first, last);
+			m_ranges.insert(first, Range(newBegin, newEnd));
+			if(m_ranges.size() > MAX_RANGES) merge_closest();
+		}
+
+		inline void						clear()
+		{
+			bWhole = false;
+			m_ranges.clear();
+		}
+
+		inline void						swap(			DirtyRanges&		other)
+		{
+			m_ranges.swap(other.m_ranges);
+			std::swap(bWhole, other.bWhole);
+		}
+
+	private: // functions
+		void							merge_closest()
+		{
+			size_t		closest = 0;
+			uint32_t	minGap	= std::numeric_limits<uint32_t>::max();
+			for(size_t index = 0; index + 1 < m_ranges.size(); ++index)
+			{
+				const uint32_t GAP = m_ranges[index + 1].begin() - m_ranges[index].end();
+				if(GAP < minGap)
+				{
+					minGap	= GAP;
+					closest	= index;
+				}
+			}
+
+			m_ranges[closest].reset(m_ranges[closest].begin(), m_ranges[closest + 1].end());
+			m_ranges.erase(m_ranges.begin() + closest + 1);
+		}
+	};
+
+
 	template<typename T>
 	class	TransferablePack	: private dpl::Link<BufferTransfer<T>, TransferablePack<T>>
 	{
@@ -61,6 +171,8 @@ namespace dpl
 	private: // data
 		mutable dpl::DynamicArray<T>						container;
 		mutable dpl::Mask32_t								flags;	
+		mutable DirtyRanges									dirty; // Elements modified since the last flush.
+		mutable std::mutex									m_mtx; // Guards flags and dirty ranges when elements are modified from many threads.
 
 	public: // lifecycle
 		CLASS_CTOR					TransferablePack()
@@ -74,6 +186,7 @@ namespace dpl
 			, range(other.range)
 			, container(std::move(other.container))
 			, flags(other.flags)
+			, dirty(std::move(other.dirty))
 		{
 			other.range = 0;
 		}
@@ -92,6 +205,7 @@ namespace dpl
 			range.swap(other.range);
 			container->swap(*other.container);
 			std::swap(flags, other.flags);
+			dirty.swap(other.dirty);
 			return *this;
 		}
 
@@ -120,6 +234,7 @@ namespace dpl
 				flags.set_at(RESIZED,		false);
 				flags.set_at(NEEDS_FLUSH,	false);
 				flags.set_at(KEPT,			true);
+				dirty.clear();
 			}
 		}
 
@@ -145,11 +260,38 @@ namespace dpl
 		*/
 		inline T*					modify()
 		{
+			std::lock_guard<std::mutex> lk(m_mtx);
 			restore();
 			mark_as_modified();
 			return container.data();
 		}
 
+		/*
+			Modify single element.
+			Only this element will be transferred(unless other elements were modified too).
+			Warning! Returned reference may be invalidated when transfer is updated or array is resized.
+		*/
+		inline T&					modify_at(						const uint32_t			INDEX)
+		{
+			return *modify_range(INDEX, INDEX + 1);
+		}
+
+		/*
+			Modify elements in range [BEGIN, END), returns pointer to the first one.
+			Only these elements will be transferred(unless other elements were modified too).
+			Can be called from many threads(parallel jobs) as long as they modify different elements and the array is not resized or flushed meanwhile.
+			Note: Each call takes a lock, jobs should mark their whole chunk at once instead of single elements.
+			Warning! Returned pointer may be invalidated when transfer is updated or array is resized.
+		*/
+		inline T*					modify_range(					const uint32_t			BEGIN,
+																	const uint32_t			END)
+		{
+			std::lock_guard<std::mutex> lk(m_mtx);
+			restore();
+			mark_as_modified(BEGIN, END);
+			return container.data() + BEGIN;
+		}
+
 		inline void					modify_each(					const Invocation&		INVOKE)
 		{
 			modify();
@@ -215,14 +357,15 @@ namespace dpl
 			if(FIRST_INDEX == SECOND_INDEX) return;
 			restore();
 			container.swap_elements(FIRST_INDEX, SECOND_INDEX);
-			mark_as_modified();
+			mark_as_modified(FIRST_INDEX, FIRST_INDEX + 1);
+			mark_as_modified(SECOND_INDEX, SECOND_INDEX + 1);
 		}
 
 		void						fast_erase(						const uint32_t			ELEMENT_INDEX)
 		{
 			restore();
 			container.fast_erase(ELEMENT_INDEX);
-			mark_as_modified();
+			mark_as_modified(ELEMENT_INDEX, ELEMENT_INDEX + 1); //<-- Replaced with the last element.
 			mark_as_resized();
 		}
 
@@ -255,6 +398,22 @@ namespace dpl
 			mark_as_resized();
 		}
 
+		bool						import_from(					ByteReader&				bytes) requires std::is_trivially_copyable_v<T>
+		{
+			const bool RESULT = container.import_from(bytes);
+			mark_as_modified();
+			mark_as_resized();
+			return RESULT;
+		}
+
+		bool						import_tail_from(				ByteReader&				bytes) requires std::is_trivially_copyable_v<T>
+		{
+			const bool RESULT = container.import_tail_from(bytes);
+			mark_as_modified();
+			mark_as_resized();
+			return RESULT;
+		}
+
 		void						export_to(						std::ostream&			binary) const
 		{
 			restore();
@@ -276,13 +435,35 @@ namespace dpl
 			return SIZE;
 		}
 
+		/*
+			Transfers modified ranges, or the whole array if it was resized.
+		*/
 		void						flush() const
 		{
 			if(!flags.at(NEEDS_FLUSH)) return;
 
-			const MyTransfer&	TRANSFER = get_transfer();
-								TRANSFER.on_flush_array(range, container.data());
+			const MyTransfer&	TRANSFER	= get_transfer();
+			const uint32_t		SIZE		= size();
+			if(flags.at(RESIZED) || dirty.is_whole())
+			{
+				TRANSFER.on_flush_array(range, container.data());
+				TRANSFER.count_flushed(SIZE, 0);
+			}
+			else
+			{
+				uint32_t numFlushed = 0;
+				for(const auto& RANGE : dirty.ranges())
+				{
+					const uint32_t BEGIN	= std::min(RANGE.begin(), SIZE);
+					const uint32_t END		= std::min(RANGE.end(), SIZE);
+					if(BEGIN == END) continue;
+					TRANSFER.on_flush_array(Range(offset() + BEGIN, offset() + END), container.data() + BEGIN);
+					numFlushed += END - BEGIN;
+				}
+				TRANSFER.count_flushed(numFlushed, SIZE - numFlushed);
+			}
 			
+			dirty.clear();
 			flags.set_at(RESIZED,		false);
 			flags.set_at(NEEDS_FLUSH,	false);
 			if(flags.at(KEPT)) return;
@@ -308,6 +489,11 @@ namespace dpl
 				flags.set_at(NEEDS_FLUSH, true); //<-- Flush forced by the transfer.
 			}
 
+			if(bMODIFIED_ON_RESIZE)
+			{
+				dirty.mark_whole(); //<-- Offset has changed, or buffer was reallocated.
+			}
+
 			return true;
 		}
 
@@ -326,6 +512,14 @@ namespace dpl
 
 		inline void					mark_as_modified()
 		{
+			dirty.mark_whole();
+			if(!flags.at(NEEDS_FLUSH)) request_flush();
+		}
+
+		inline void					mark_as_modified(				const uint32_t			BEGIN,
+																	const uint32_t			END)
+		{
+			dirty.mark(BEGIN, END);
 			if(!flags.at(NEEDS_FLUSH)) request_flush();
 		}
 
@@ -373,6 +567,8 @@ namespace dpl
 	public: // data
 		mutable dpl::ReadOnly<uint32_t, BufferTransfer>	size; // Total number of data units.
 		dpl::ReadOnly<bool, BufferTransfer>				bKeepFlushedData;
+		mutable dpl::ReadOnly<uint64_t, BufferTransfer>	numFlushedBytes;
+		mutable dpl::ReadOnly<uint64_t, BufferTransfer>	numSkippedBytes; // Bytes of the clean elements that were not transferred.
 	private: // data
 		mutable std::atomic_bool						bResized;
 		mutable std::atomic_bool						bNeedsFlush;
@@ -381,6 +577,8 @@ namespace dpl
 		CLASS_CTOR				BufferTransfer(		const bool						bKEEP_FLUSHED_DATA = true)
 			: size(0)
 			, bKeepFlushedData(bKEEP_FLUSHED_DATA)
+			, numFlushedBytes(0)
+			, numSkippedBytes(0)
 			, bResized(false)
 			, bNeedsFlush(false)
 		{
@@ -393,6 +591,8 @@ namespace dpl
 			: MyChainBase(std::move(other))
 			, size(other.size)
 			, bKeepFlushedData(other.bKeepFlushedData)
+			, numFlushedBytes(other.numFlushedBytes)
+			, numSkippedBytes(other.numSkippedBytes)
 			, bResized(other.bResized.load())
 			, bNeedsFlush(other.bNeedsFlush.load())
 		{
@@ -407,6 +607,8 @@ namespace dpl
 			MyChainBase::operator=(std::move(other));
 			size				= other.size;
 			bKeepFlushedData	= other.bKeepFlushedData;
+			numFlushedBytes		= other.numFlushedBytes;
+			numSkippedBytes		= other.numSkippedBytes;
 			bResized.store(other.bResized.load());
 			bNeedsFlush.store(other.bNeedsFlush.load());
 			return *this;
@@ -450,6 +652,12 @@ namespace dpl
 			}
 		}
 
+		inline void				reset_statistics()
+		{
+			numFlushedBytes = 0;
+			numSkippedBytes = 0;
+		}
+
 	protected: // functions
 		/*
 			Returns true if transfer was performed.
@@ -488,6 +696,13 @@ namespace dpl
 			bResized.store(true, std::memory_order_relaxed);
 		}
 
+		inline void				count_flushed(		const uint32_t					NUM_FLUSHED,
+													const uint32_t					NUM_SKIPPED) const
+		{
+			*numFlushedBytes += sizeof(T) * static_cast<uint64_t>(NUM_FLUSHED);
+			*numSkippedBytes += sizeof(T) * static_cast<uint64_t>(NUM_SKIPPED);
+		}
+
 		inline void				notify_modified() const
 		{
 			bNeedsFlush.store(true, std::memory_order_relaxed);
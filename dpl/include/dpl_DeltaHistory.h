@@ -0,0 +1,552 @@
+#pragma once
+
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cstring>
+#include <span>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <stdint.h>
+#include "dpl_ReadOnly.h"
+#include "dpl_ThreadPool.h"
+#include "dpl_GeneralException.h"
+#include "dpl_Command.h"
+
+
+namespace dpl
+{
+	/*
+		Undo/redo history of raw memory changes(e.g. component rows or buffers).
+
+		Each entry stores XOR of the bytes before and after the change, limited to the runs of bytes that were actually modified.
+		Applying the same delta twice restores the original state, so one record serves both undo and redo.
+
+		Entries are kept in a contiguous ring of bytes with fixed capacity.
+		The oldest entries are evicted when there is not enough space for the new one.
+
+		Usage:
+			history.begin_entry();
+			history.capture(TARGET_ID, OFFSET, SIZE);	<-- Before modification.
+			... modify memory ...
+			history.end_entry();						<-- Compares captured bytes with current state.
+
+		Note: Patches within a single entry must not overlap, since they may be applied in parallel.
+		Note: Size of the target must be the same when the entry is applied as when it was recorded
+		(e.g. row resized by another command must be restored by undoing that command first), otherwise exception is thrown.
+	*/
+	class DeltaHistory
+	{
+	public: // subtypes
+		using Resolver = std::function<std::span<uint8_t>()>; // Returns current address and size of the target memory block.
+
+	public: // constants
+		static const uint32_t	DEFAULT_CAPACITY	= 64 * 1024 * 1024;
+		static const uint32_t	PARALLEL_THRESHOLD	= 256 * 1024;	// Minimum number of bytes applied in parallel.
+		static const uint32_t	CHUNK_SIZE			= 64 * 1024;	// Maximum number of bytes applied by a single task.
+		static const uint64_t	INVALID_ID			= std::numeric_limits<uint64_t>::max();
+
+	private: // subtypes
+		struct	PatchHeader
+		{
+			uint32_t target;
+			uint32_t size;
+			uint64_t offset;
+			uint64_t targetSize;
+		};
+
+		struct	Capture
+		{
+			uint32_t target;
+			uint32_t size;
+			uint64_t offset;
+			uint64_t targetSize;
+			uint64_t snapshotOffset;
+		};
+
+		struct	Entry
+		{
+			uint64_t id;
+			uint64_t begin;
+			uint64_t end;
+			uint64_t numBytes; // Number of delta bytes(without headers).
+		};
+
+		struct	Chunk
+		{
+			uint8_t*		destination;
+			const uint8_t*	DELTA;
+			uint32_t		size;
+		};
+
+	public: // data
+		ReadOnly<uint64_t, DeltaHistory> numEvicted;
+		ReadOnly<uint64_t, DeltaHistory> numRejected;	// Entries larger than the capacity(history was cleared for each of them).
+
+	private: // data
+		std::vector<Resolver>	m_targets;
+		std::vector<uint8_t>	m_ring;
+		std::deque<Entry>		m_entries;
+		uint64_t				m_writePos;
+		uint32_t				m_numApplied;	// Number of entries(from the front) that are currently applied.
+		uint64_t				m_nextID;
+		std::vector<Capture>	m_captures;
+		std::vector<uint8_t>	m_snapshots;
+		std::vector<uint8_t>	m_block;		// Entry being built.
+		std::vector<Chunk>		m_chunks;
+		bool					bRecording;
+
+	public: // lifecycle
+		CLASS_CTOR			DeltaHistory(		const uint32_t		CAPACITY = DEFAULT_CAPACITY)
+			: numEvicted(0)
+			, numRejected(0)
+			, m_ring(CAPACITY)
+			, m_writePos(0)
+			, m_numApplied(0)
+			, m_nextID(0)
+			, bRecording(false)
+		{
+
+		}
+
+		CLASS_CTOR			DeltaHistory(		const DeltaHistory&	OTHER) = delete;
+
+		DeltaHistory&		operator=(			const DeltaHistory&	OTHER) = delete;
+
+	public: // functions
+		inline uint32_t		capacity() const
+		{
+			return static_cast<uint32_t>(m_ring.size());
+		}
+
+		inline uint32_t		get_numEntries() const
+		{
+			return static_cast<uint32_t>(m_entries.size());
+		}
+
+		/*
+			Returns number of bytes used by the stored entries(including headers).
+		*/
+		inline uint64_t		get_numBytesUsed() const
+		{
+			uint64_t numBytes = 0;
+			for(const Entry& ENTRY : m_entries) numBytes += ENTRY.end - ENTRY.begin;
+			return numBytes;
+		}
+
+		inline bool			can_undo() const
+		{
+			return m_numApplied > 0;
+		}
+
+		inline bool			can_redo() const
+		{
+			return m_numApplied < m_entries.size();
+		}
+
+		/*
+			Returns identifier of the newest entry, or INVALID_ID if there are no entries.
+		*/
+		inline uint64_t		get_lastID() const
+		{
+			return m_entries.empty()? INVALID_ID : m_entries.back().id;
+		}
+
+		/*
+			Registers memory block and returns its identifier used by the 'capture' function.
+			Resolver is called each time the entry is applied, so the memory block may be relocated in the meantime(but not resized).
+		*/
+		inline uint32_t		add_target(			const Resolver&		RESOLVER)
+		{
+			m_targets.push_back(RESOLVER);
+			return static_cast<uint32_t>(m_targets.size() - 1);
+		}
+
+		inline void			begin_entry()
+		{
+			if(bRecording) throw GeneralException(this, __LINE__, "Entry was already started.");
+			bRecording = true;
+			m_captures.clear();
+			m_snapshots.clear();
+		}
+
+		/*
+			Stores current state of the given bytes of the target.
+		*/
+		void				capture(			const uint32_t		TARGET_ID,
+												const uint64_t		OFFSET,
+												const uint32_t		SIZE)
+		{
+			if(!bRecording) throw GeneralException(this, __LINE__, "Entry was not started.");
+			const std::span<uint8_t> TARGET = resolve(TARGET_ID);
+			if(OFFSET + SIZE > TARGET.size()) throw GeneralException(this, __LINE__, "Captured bytes are out of the target.");
+
+			const uint64_t SNAPSHOT_OFFSET = m_snapshots.size();
+			m_snapshots.resize(SNAPSHOT_OFFSET + SIZE);
+			std::memcpy(m_snapshots.data() + SNAPSHOT_OFFSET, TARGET.data() + OFFSET, SIZE);
+			m_captures.push_back(Capture{TARGET_ID, SIZE, OFFSET, TARGET.size(), SNAPSHOT_OFFSET});
+		}
+
+		/*
+			Compares captured bytes with their current state and stores the difference.
+			Entries after the current one are discarded.
+			Returns false if nothing changed, or the entry is larger than the capacity of the history.
+			Throws if any captured target was resized after the capture(nothing is recorded).
+		*/
+		bool				end_entry()
+		{
+			if(!bRecording) throw GeneralException(this, __LINE__, "Entry was not started.");
+			bRecording = false;
+
+			for(const Capture& CAPTURE : m_captures)
+			{
+				if(resolve(CAPTURE.target).size() != CAPTURE.targetSize)
+					throw GeneralException(this, __LINE__, "Target " + std::to_string(CAPTURE.target) + " was resized during the entry.");
+			}
+
+			m_block.clear();
+			uint64_t numBytes = 0;
+			for(const Capture& CAPTURE : m_captures)
+			{
+				numBytes += encode(CAPTURE);
+			}
+
+			if(m_block.empty()) return false;
+
+			trim_to_current();
+			if(m_block.size() > m_ring.size())
+			{
+				++(*numRejected);
+				clear(); // History of the previous changes would be inconsistent without this entry.
+				return false;
+			}
+
+			const uint64_t BEGIN = place(m_block.size());
+			std::memcpy(m_ring.data() + BEGIN, m_block.data(), m_block.size());
+			m_writePos = BEGIN + m_block.size();
+			m_entries.push_back(Entry{m_nextID++, BEGIN, m_writePos, numBytes});
+			m_numApplied = get_numEntries();
+			return true;
+		}
+
+		/*
+			Reverts current entry and moves to the previous one.
+			Large entries are applied in parallel if thread pool is given.
+		*/
+		inline bool			undo(				ThreadPool*			threadPool = nullptr)
+		{
+			if(!can_undo()) return false;
+			apply(m_entries[m_numApplied - 1], threadPool);
+			--m_numApplied;
+			return true;
+		}
+
+		/*
+			Applies the entry after the current one.
+			Large entries are applied in parallel if thread pool is given.
+		*/
+		inline bool			redo(				ThreadPool*			threadPool = nullptr)
+		{
+			if(!can_redo()) return false;
+			apply(m_entries[m_numApplied], threadPool);
+			++m_numApplied;
+			return true;
+		}
+
+		/*
+			Same as 'undo', but only if the current entry has the given identifier(returns false otherwise).
+		*/
+		inline bool			undo(				const uint64_t		ENTRY_ID,
+												ThreadPool*			threadPool = nullptr)
+		{
+			if(!can_undo() || m_entries[m_numApplied - 1].id != ENTRY_ID) return false;
+			return undo(threadPool);
+		}
+
+		/*
+			Same as 'redo', but only if the entry after the current one has the given identifier(returns false otherwise).
+		*/
+		inline bool			redo(				const uint64_t		ENTRY_ID,
+												ThreadPool*			threadPool = nullptr)
+		{
+			if(!can_redo() || m_entries[m_numApplied].id != ENTRY_ID) return false;
+			return redo(threadPool);
+		}
+
+		inline bool			clear()
+		{
+			if(m_entries.empty()) return false;
+			m_entries.clear();
+			m_writePos		= 0;
+			m_numApplied	= 0;
+			return true;
+		}
+
+	private: // functions
+		inline std::span<uint8_t> resolve(		const uint32_t		TARGET_ID) const
+		{
+			return m_targets[TARGET_ID]();
+		}
+
+		/*
+			Appends runs of modified bytes to the block and returns their total size.
+			Runs separated by less bytes than the size of the header are merged.
+		*/
+		uint64_t			encode(				const Capture&		CAPTURE)
+		{
+			const uint8_t*	BEFORE		= m_snapshots.data() + CAPTURE.snapshotOffset;
+			const uint8_t*	AFTER		= resolve(CAPTURE.target).data() + CAPTURE.offset;
+			uint64_t		numBytes	= 0;
+			uint32_t		index		= 0;
+
+			while(index < CAPTURE.size)
+			{
+				if(BEFORE[index] == AFTER[index]){++index; continue;}
+
+				const uint32_t	RUN_BEGIN	= index;
+				uint32_t		runEnd		= index + 1;
+				uint32_t		numEqual	= 0;
+				for(index = runEnd; index < CAPTURE.size && numEqual < sizeof(PatchHeader); ++index)
+				{
+					if(BEFORE[index] == AFTER[index])	++numEqual;
+					else							{	numEqual = 0; runEnd = index + 1;}
+				}
+
+				const uint32_t		RUN_SIZE	= runEnd - RUN_BEGIN;
+				const PatchHeader	HEADER		= {CAPTURE.target, RUN_SIZE, CAPTURE.offset + RUN_BEGIN, CAPTURE.targetSize};
+				const size_t		POSITION	= m_block.size();
+				m_block.resize(POSITION + sizeof(PatchHeader) + RUN_SIZE);
+				std::memcpy(m_block.data() + POSITION, &HEADER, sizeof(PatchHeader));
+
+				uint8_t* delta = m_block.data() + POSITION + sizeof(PatchHeader);
+				for(uint32_t offset = 0; offset < RUN_SIZE; ++offset)
+				{
+					delta[offset] = BEFORE[RUN_BEGIN + offset] ^ AFTER[RUN_BEGIN + offset];
+				}
+
+				numBytes	+= RUN_SIZE;
+				index		= runEnd;
+			}
+
+			return numBytes;
+		}
+
+		/*
+			Returns position in the ring where block of the given size can be stored.
+			Evicts the oldest entries if necessary.
+		*/
+		uint64_t			place(				const uint64_t		SIZE)
+		{
+			const uint64_t CAPACITY = m_ring.size();
+			while(true)
+			{
+				if(m_entries.empty())
+				{
+					if(m_writePos + SIZE > CAPACITY) m_writePos = 0;
+					return m_writePos;
+				}
+
+				const uint64_t HEAD = m_entries.front().begin;
+				if(HEAD >= m_writePos) // Free space is between the newest and the oldest entry.
+				{
+					if(m_writePos + SIZE <= HEAD) return m_writePos;
+				}
+				else // Free space is at the end and at the beginning of the ring.
+				{
+					if(m_writePos + SIZE <= CAPACITY)	return m_writePos;
+					if(SIZE <= HEAD)					return m_writePos = 0;
+				}
+
+				evict_oldest();
+			}
+		}
+
+		inline void			evict_oldest()
+		{
+			m_entries.pop_front();
+			if(m_numApplied > 0) --m_numApplied;
+			++(*numEvicted);
+		}
+
+		inline void			trim_to_current()
+		{
+			while(m_entries.size() > m_numApplied)
+			{
+				m_entries.pop_back();
+			}
+
+			if(!m_entries.empty())	m_writePos = m_entries.back().end;
+			else					m_writePos = 0;
+		}
+
+		/*
+			All patches are validated before any of them is applied.
+			Parallel tasks are counted per call, so errors of unrelated tasks in the pool are neither awaited nor rethrown here.
+			Must not be called from the worker of the given pool.
+		*/
+		void				apply(				const Entry&		ENTRY,
+												ThreadPool*			threadPool)
+		{
+			m_chunks.clear();
+			const uint8_t*	CURRENT = m_ring.data() + ENTRY.begin;
+			const uint8_t*	END		= m_ring.data() + ENTRY.end;
+			while(CURRENT < END)
+			{
+				PatchHeader HEADER;
+				std::memcpy(&HEADER, CURRENT, sizeof(PatchHeader));
+				CURRENT += sizeof(PatchHeader);
+
+				const std::span<uint8_t> TARGET = resolve(HEADER.target);
+				if(TARGET.size() != HEADER.targetSize)
+					throw GeneralException(this, __LINE__, "Target " + std::to_string(HEADER.target) + " was resized since the entry was recorded.");
+
+				uint8_t* destination = TARGET.data() + HEADER.offset;
+				for(uint32_t offset = 0; offset < HEADER.size; offset += CHUNK_SIZE)
+				{
+					const uint32_t NUM_LEFT = HEADER.size - offset;
+					m_chunks.push_back(Chunk{destination + offset, CURRENT + offset, (NUM_LEFT < CHUNK_SIZE)? NUM_LEFT : CHUNK_SIZE});
+				}
+
+				CURRENT += HEADER.size;
+			}
+
+			if(!threadPool || ENTRY.numBytes < PARALLEL_THRESHOLD || m_chunks.size() < 2)
+			{
+				for(const Chunk& CHUNK : m_chunks) apply_chunk(CHUNK);
+				return;
+			}
+
+			const size_t NUM_TASKS		= std::min<size_t>(std::max<size_t>(threadPool->get_numWorkers(), 1), m_chunks.size());
+			const size_t CHUNKS_PER_TASK	= (m_chunks.size() + NUM_TASKS - 1) / NUM_TASKS;
+
+			std::mutex				mtx;
+			std::condition_variable	tasksDone;
+			size_t					numRunning = (m_chunks.size() + CHUNKS_PER_TASK - 1) / CHUNKS_PER_TASK;
+			std::string				error;
+			for(size_t first = 0; first < m_chunks.size(); first += CHUNKS_PER_TASK)
+			{
+				const size_t LAST = std::min(first + CHUNKS_PER_TASK, m_chunks.size());
+				threadPool->add_task([&, first, LAST]()
+				{
+					try
+					{
+						for(size_t index = first; index < LAST; ++index) apply_chunk(m_chunks[index]);
+					}
+					catch(const std::exception& EXCEPTION)
+					{
+						std::lock_guard lk(mtx);
+						if(error.empty()) error = EXCEPTION.what();
+					}
+					catch(...)
+					{
+						std::lock_guard lk(mtx);
+						if(error.empty()) error = "Unknown exception";
+					}
+
+					std::lock_guard lk(mtx);
+					if(--numRunning == 0) tasksDone.notify_all();
+				});
+			}
+
+			std::unique_lock lk(mtx);
+			tasksDone.wait(lk, [&]
+			{
+				return numRunning == 0;
+			});
+
+			if(!error.empty()) throw GeneralException(this, __LINE__, "Failed to apply the entry: " + error);
+		}
+
+		static inline void	apply_chunk(		const Chunk&		CHUNK)
+		{
+			for(uint32_t index = 0; index < CHUNK.size; ++index)
+			{
+				CHUNK.destination[index] ^= CHUNK.DELTA[index];
+			}
+		}
+	};
+
+
+	/*
+		Command that keeps its changes in the DeltaHistory instead of its own members(see CommandInvoker::invoke).
+		On the first execution 'record' captures the memory and modifies it, undo/redo only apply the stored delta.
+
+		DeltaHistory must be undone and redone in the same order as the commands(e.g. by a single CommandInvoker).
+		Command that changed nothing does nothing when undone or redone.
+		Throws if the changes could not be recorded(larger than the capacity of the history),
+		or the entry of the command was evicted, discarded or is not the current one when undone or redone.
+	*/
+	class DeltaCommand : public Command
+	{
+	private: // data
+		DeltaHistory&	m_history;
+		ThreadPool*		m_threadPool;
+		uint64_t		m_entryID;
+		bool			bRecorded;
+
+	public: // lifecycle
+		CLASS_CTOR			DeltaCommand(		DeltaHistory&		history,
+												ThreadPool*			threadPool = nullptr)
+			: m_history(history)
+			, m_threadPool(threadPool)
+			, m_entryID(DeltaHistory::INVALID_ID)
+			, bRecorded(false)
+		{
+
+		}
+
+	private: // interface
+		/*
+			Captures memory with history.capture and modifies it.
+		*/
+		virtual void		record(				DeltaHistory&		history) = 0;
+
+	private: // implementation
+		virtual void		execute() final override
+		{
+			if(bRecorded)
+			{
+				if(m_entryID == DeltaHistory::INVALID_ID) return;
+				if(!m_history.redo(m_entryID, m_threadPool))
+					throw GeneralException(this, __LINE__, "Entry " + std::to_string(m_entryID) + " can not be redone(evicted, discarded or out of order).");
+				return;
+			}
+
+			bRecorded = true;
+			m_history.begin_entry();
+			try
+			{
+				record(m_history);
+			}
+			catch(...)
+			{
+				end_recording(); // Changes made before the exception stay undoable.
+				throw;
+			}
+
+			if(!end_recording())
+				throw GeneralException(this, __LINE__, "Changes are larger than the capacity of the history and can not be undone.");
+		}
+
+		virtual void		unexecute() final override
+		{
+			if(m_entryID == DeltaHistory::INVALID_ID) return;
+			if(!m_history.undo(m_entryID, m_threadPool))
+				throw GeneralException(this, __LINE__, "Entry " + std::to_string(m_entryID) + " can not be undone(evicted, discarded or out of order).");
+		}
+
+	private: // functions
+		/*
+			Returns false if the entry was rejected by the history(nothing changed is not a failure).
+		*/
+		inline bool			end_recording()
+		{
+			const uint64_t NUM_REJECTED = m_history.numRejected();
+			if(m_history.end_entry()) m_entryID = m_history.get_lastID();
+			return m_history.numRejected() == NUM_REJECTED;
+		}
+	};
+}
\ No newline at end of file
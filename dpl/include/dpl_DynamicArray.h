@@ -278,7 +278,7 @@ namespace dpl
 
 		inline void					rearrange(						const dpl::DeltaArray&		DELTA)
 		{
-			throw_if_invalid_delta();
+			throw_if_invalid_delta(DELTA);
 			m_buffer.relocate(capacity(), [&](dpl::Buffer<T>& newBuffer)
 			{
 				newBuffer.move_from(m_buffer, DELTA);
@@ -306,6 +306,29 @@ namespace dpl
 			dpl::import_t(binary, TAIL_SIZE, DynamicArray::enlarge(TAIL_SIZE));
 		}
 
+		/*
+			Imports elements directly from memory with a single copy(e.g. from the mapped file).
+			Returns false if there was not enough data.
+		*/
+		bool						import_from(					ByteReader&					bytes) requires std::is_trivially_copyable_v<T>
+		{
+			clear_internal();
+			const uint32_t NEW_SIZE = dpl::import_t<uint32_t>(bytes);
+			if(!bytes.good() || static_cast<uint64_t>(NEW_SIZE) * sizeof(T) > bytes.remaining()) return false;
+			m_buffer.relocate(calculate_exponential_capacity(NEW_SIZE), [&](auto&){}); //<-- Relocate to an empty buffer.
+			m_size = NEW_SIZE;
+			dpl::import_t(bytes, size(), data());
+			return true;
+		}
+
+		bool						import_tail_from(				ByteReader&					bytes) requires std::is_trivially_copyable_v<T>
+		{
+			const uint32_t TAIL_SIZE = dpl::import_t<uint32_t>(bytes);
+			if(!bytes.good() || static_cast<uint64_t>(TAIL_SIZE) * sizeof(T) > bytes.remaining()) return false;
+			dpl::import_t(bytes, TAIL_SIZE, DynamicArray::enlarge(TAIL_SIZE));
+			return true;
+		}
+
 		void						export_to(						std::ostream&				binary) const
 		{
 			dpl::export_t(binary, size());
@@ -7,6 +7,11 @@
 #include "dpl_Variation.h"
 #include "dpl_Subject.h"
 #include <mutex>
+#include <atomic>
+#include <vector>
+#include <span>
+#include <optional>
+#include <bit>
 
 
 namespace dpl
@@ -25,12 +30,18 @@ namespace dpl
 	class Device;
 	class Emitter;
 
+	template<typename EventT>
+	class EventQueue;
+
 	template<typename EventT>	
 	class Transmitter;
 
 	template<typename EventT>
 	class Receiver;
 
+	template<typename EventT>
+	class BatchReceiver;
+
 //============ IMPLEMENTATIONS ============//
 
 	template<typename T>
@@ -39,11 +50,185 @@ namespace dpl
 		static_assert(std::is_base_of<EventType<T>, T>::value, "All events must be derived from the EventType<T>, where T is the type of the event.");
 	}
 
+	/*
+		Lock-free queue with multiple producers and a single consumer.
+		Producers push events onto an atomic stack, consumer takes the whole stack at once and restores the order of arrival.
+
+		Nodes are never freed before the queue is destroyed: consumer returns them to a free list that producers pop from,
+		so the heap is touched only when the pool grows(lock is taken only then).
+		Head of the free list is tagged with a counter against the ABA problem.
+	*/
+	template<typename EventT>
+	class EventQueue
+	{
+	private: // subtypes
+		struct	Node
+		{
+			std::optional<EventT>	event;
+			Node*					next		= nullptr;
+			std::atomic_uint32_t	nextFree	= 0;	// Index + 1 of the next free node, 0 ends the list.
+			uint32_t				index		= 0;
+		};
+
+	public: // constants
+		static const uint32_t FIRST_BLOCK_SIZE	= 64;
+		static const uint32_t MAX_BLOCKS		= 26;	// Block N has FIRST_BLOCK_SIZE << N nodes.
+
+	private: // data
+		std::atomic<Node*>		m_head;
+		std::atomic_uint64_t	m_freeHead;				// Tag in the upper half, index + 1 of the first free node in the lower half.
+		std::mutex				m_growMtx;
+		uint32_t				m_numBlocks;
+		Node*					m_blocks[MAX_BLOCKS];	// Published to producers through m_freeHead.
+
+	public: // lifecycle
+		CLASS_CTOR			EventQueue()
+			: m_head(nullptr)
+			, m_freeHead(0)
+			, m_numBlocks(0)
+			, m_blocks{}
+		{
+
+		}
+
+		CLASS_CTOR			EventQueue(		const EventQueue&		OTHER) = delete;
+
+		CLASS_DTOR			~EventQueue()
+		{
+			for(uint32_t blockID = 0; blockID < m_numBlocks; ++blockID)
+			{
+				delete[] m_blocks[blockID];
+			}
+		}
+
+		EventQueue&			operator=(		const EventQueue&		OTHER) = delete;
+
+	public: // functions
+		/*
+			Can be called from any thread.
+		*/
+		inline void			push(			const EventT&			EVENT)
+		{
+			Node* node = pop_free();
+			node->event.emplace(EVENT);
+			node->next = m_head.load(std::memory_order_relaxed);
+			while(!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		inline bool			empty() const
+		{
+			return m_head.load(std::memory_order_acquire) == nullptr;
+		}
+
+		/*
+			Moves all queued events to the back of the given array(in order of arrival) and returns their number.
+			Must not be called by more than one thread at a time.
+		*/
+		uint32_t			consume_all(	std::vector<EventT>&	events)
+		{
+			Node*		node		= m_head.exchange(nullptr, std::memory_order_acquire);
+			Node*		reversed	= nullptr;
+			uint32_t	count		= 0;
+
+			while(node)
+			{
+				Node* next		= node->next;
+				node->next		= reversed;
+				reversed		= node;
+				node			= next;
+				++count;
+			}
+
+			if(count == 0) return 0;
+
+			Node* first = reversed;
+			Node* last	= nullptr;
+			events.reserve(events.size() + count);
+			for(node = reversed; node; node = node->next)
+			{
+				events.push_back(std::move(*node->event));
+				node->event.reset();
+				if(last) last->nextFree.store(node->index + 1, std::memory_order_relaxed);
+				last = node;
+			}
+
+			push_free(first, last);
+			return count;
+		}
+
+	private: // functions
+		inline Node&		get_node(		const uint32_t			INDEX)
+		{
+			const uint32_t BLOCK_ID = static_cast<uint32_t>(std::bit_width(INDEX / FIRST_BLOCK_SIZE + 1)) - 1;
+			return m_blocks[BLOCK_ID][INDEX - FIRST_BLOCK_SIZE * ((1u << BLOCK_ID) - 1)];
+		}
+
+		inline Node*		pop_free()
+		{
+			uint64_t head = m_freeHead.load(std::memory_order_acquire);
+			while(static_cast<uint32_t>(head) != 0)
+			{
+				// Node may be taken by another producer meanwhile, the tag makes the exchange fail in that case.
+				Node&			node	= get_node(static_cast<uint32_t>(head) - 1);
+				const uint64_t	NEXT	= ((head >> 32) + 1) << 32 | node.nextFree.load(std::memory_order_relaxed);
+				if(m_freeHead.compare_exchange_weak(head, NEXT, std::memory_order_acquire, std::memory_order_acquire))
+					return &node;
+			}
+			return grow();
+		}
+
+		/*
+			Returns chain of nodes linked with 'nextFree' to the free list.
+		*/
+		inline void			push_free(		Node*					first,
+											Node*					last)
+		{
+			uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+			uint64_t newHead;
+			do
+			{
+				last->nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+				newHead = ((head >> 32) + 1) << 32 | (first->index + 1);
+			}
+			while(!m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/*
+			Allocates next block, returns its first node and puts the rest to the free list.
+		*/
+		Node*				grow()
+		{
+			std::lock_guard lock(m_growMtx);
+			if(m_numBlocks == MAX_BLOCKS)
+				throw GeneralException(this, __LINE__, "Event queue is full.");
+
+			const uint32_t	BLOCK_ID	= m_numBlocks;
+			const uint32_t	BLOCK_SIZE	= FIRST_BLOCK_SIZE << BLOCK_ID;
+			const uint32_t	OFFSET		= FIRST_BLOCK_SIZE * ((1u << BLOCK_ID) - 1);
+			Node*			block		= new Node[BLOCK_SIZE];
+
+			for(uint32_t nodeID = 0; nodeID < BLOCK_SIZE; ++nodeID)
+			{
+				block[nodeID].index = OFFSET + nodeID;
+				if(nodeID + 1 < BLOCK_SIZE) block[nodeID].nextFree.store(OFFSET + nodeID + 2, std::memory_order_relaxed);
+			}
+
+			m_blocks[BLOCK_ID] = block;
+			++m_numBlocks;
+			push_free(&block[1], &block[BLOCK_SIZE - 1]);
+			return &block[0];
+		}
+	};
+
+
 	/*
 		Base class for Transmitter types.
 	*/
 	class Device : public Variant<EventDispatcher, Device>
 	{
+	public: // relations
+		friend EventDispatcher;
+
 	public: // functions
 		CLASS_CTOR			Device(		const Binding&		BINDING)
 			: Variant(BINDING)
@@ -52,6 +237,12 @@ namespace dpl
 		}
 
 		CLASS_DTOR virtual	~Device(){}
+
+	private: // interface
+		/*
+			Delivers queued events.
+		*/
+		virtual void		flush(){}
 	};
 
 
@@ -69,29 +260,67 @@ namespace dpl
 
 	public: // relations
 		friend Receiver<EventT>;
+		friend BatchReceiver<EventT>;
 
 	private: // data
-		const EventT*	EVENT;
+		const EventT*			EVENT;
+		uint32_t				m_numEvents;
+		EventQueue<EventT>		m_queue;
+		std::vector<EventT>		m_batch;
 
 	public: // lifecycle
-		CLASS_CTOR	Transmitter(const Binding&	BINDING)
+		CLASS_CTOR		Transmitter(const Binding&	BINDING)
 			: Device(BINDING)
 			, EVENT(nullptr)
+			, m_numEvents(0)
 		{
 			dpl::validate_event_type<EventT>();
 		}
 
 	public: // functions
-		inline void update(		const EventT&	NEW_EVENT)
+		inline void		update(		const EventT&	NEW_EVENT)
 		{
-			this->EVENT	= &NEW_EVENT;
+			deliver(&NEW_EVENT, 1);
+		}
+
+		/*
+			Queues event until the next flush. Can be called from any thread.
+		*/
+		inline void		enqueue(	const EventT&	NEW_EVENT)
+		{
+			m_queue.push(NEW_EVENT);
+		}
+
+	private: // functions
+		inline void		deliver(	const EventT*	EVENTS,
+									const uint32_t	NUM_EVENTS)
+		{
+			this->EVENT			= EVENTS;
+			this->m_numEvents	= NUM_EVENTS;
 			MyReceivers::notify_observers();
 		}
+
+		inline std::span<const EventT> get_events() const
+		{
+			return std::span<const EventT>(EVENT, m_numEvents);
+		}
+
+	private: // implementation
+		virtual void	flush() final override
+		{
+			if(m_queue.empty()) return;
+			m_queue.consume_all(m_batch);
+			deliver(m_batch.data(), static_cast<uint32_t>(m_batch.size()));
+			m_batch.clear();
+		}
 	};
 
 
 	/*
 		Broadcasts events.
+
+		Events can be sent synchronously with 'broadcast', or queued from any thread with 'enqueue'.
+		Queued events are delivered in batches(one notification per event type) when 'flush' is called.
 	*/
 	class EventDispatcher	: public Singleton<EventDispatcher>
 							, private Variation<EventDispatcher, Device>
@@ -107,8 +336,20 @@ namespace dpl
 		friend MyEmitters;
 		friend Emitter;
 
+		template<typename>
+		friend class BatchReceiver;
+
 	private: // data
-		std::mutex m_mtx;
+		std::mutex				m_mtx;
+		const uint64_t			m_generation; // Invalidates thread local transmitter caches of the previous dispatchers.
+		std::vector<Device*>	m_flushed;
+
+	public: // lifecycle
+		CLASS_CTOR					EventDispatcher()
+			: m_generation(next_generation())
+		{
+
+		}
 
 	public: // functions
 		template<typename EventT>
@@ -123,6 +364,40 @@ namespace dpl
 			}
 		}
 
+		template<typename EventT>
+		/*
+			Queues event for all listening receivers. Can be called from any thread.
+			Event is dropped if no receiver listens to this type of events.
+		*/
+		inline void					enqueue(	const EventT&	EVENT)
+		{
+			if(Transmitter<EventT>* transmitter = find_cached_transmitter<EventT>())
+			{
+				transmitter->enqueue(EVENT);
+			}
+		}
+
+		/*
+			Delivers all queued events. Should be called once per frame from the main thread.
+		*/
+		void						flush()
+		{
+			{
+				std::lock_guard lock(m_mtx);
+				m_flushed.clear();
+				MyTransmitters::for_each_variant([&](Device& device)
+				{
+					m_flushed.push_back(&device);
+				});
+			}
+
+			// Receivers may start listening during delivery, so the lock must be released.
+			for(Device* device : m_flushed)
+			{
+				device->flush();
+			}
+		}
+
 	private: template<typename> friend class Receiver;
 		template<typename EventT>
 		inline Transmitter<EventT>*	find_transmitter()
@@ -138,6 +413,30 @@ namespace dpl
 			auto result = MyTransmitters::create_variant<Transmitter<EventT>>();
 			return result.get();
 		}
+
+		/*
+			Transmitters live as long as the dispatcher, so they can be cached without the lock.
+		*/
+		template<typename EventT>
+		inline Transmitter<EventT>*	find_cached_transmitter()
+		{
+			thread_local uint64_t				cachedGeneration	= 0;
+			thread_local Transmitter<EventT>*	cachedTransmitter	= nullptr;
+
+			if(cachedGeneration != m_generation)
+			{
+				cachedTransmitter = find_transmitter<EventT>();
+				if(cachedTransmitter) cachedGeneration = m_generation;
+			}
+
+			return cachedTransmitter;
+		}
+
+		static inline uint64_t		next_generation()
+		{
+			static std::atomic<uint64_t> generation = 0;
+			return ++generation;
+		}
 	};
 
 
@@ -172,6 +471,15 @@ namespace dpl
 			}
 		}
 
+		template<typename EventT>
+		inline void			enqueue(	const EventT&		EVENT)
+		{
+			if(EventDispatcher* dispatcher = get_chain())
+			{
+				dispatcher->enqueue(EVENT);
+			}
+		}
+
 	protected: // functions
 		inline void			setup(		EventDispatcher*	newDispatcher)
 		{
@@ -231,7 +539,63 @@ namespace dpl
 	private: // implementation
 		virtual void	on_update(	Transmitter<EventT>&	transmitter) final override
 		{
-			this->on_event(*transmitter.EVENT);
+			for(const EventT& EVENT : transmitter.get_events())
+			{
+				this->on_event(EVENT);
+			}
+		}
+	};
+
+
+	/*
+		Receives all events of the given type with a single call.
+		Synchronous broadcast is delivered as a batch of one event.
+	*/
+	template<typename EventT>
+	class BatchReceiver : private Observer<Transmitter<EventT>>
+	{
+	public: // subtypes
+		using MyBase = Observer<Transmitter<EventT>>;
+
+	public: // relations
+		friend MyBase;
+		friend Transmitter<EventT>;
+
+	public: // lifecycle
+		CLASS_CTOR		BatchReceiver()
+		{
+			dpl::validate_event_type<EventT>();
+		}
+
+		CLASS_CTOR		BatchReceiver(	EventDispatcher&			dispatcher)
+			: BatchReceiver()
+		{
+			listen(dispatcher);
+		}
+
+	protected: // functions
+		inline void		listen(			Transmitter<EventT>&		transmitter)
+		{
+			MyBase::observe(transmitter);
+		}
+
+		inline void		listen(			EventDispatcher&			dispatcher)
+		{
+			MyBase::observe(*dispatcher.get_transmitter<EventT>());
+		}
+
+		inline void		disable()
+		{
+			MyBase::stop_observation();
+		}
+
+	private: // functions
+		virtual void	on_events(		std::span<const EventT>		events) = 0;
+
+	private: // implementation
+		virtual void	on_update(		Transmitter<EventT>&		transmitter) final override
+		{
+			this->on_events(transmitter.get_events());
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,341 @@
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "dpl_ClassInfo.h"
+#include "dpl_GeneralException.h"
+
+
+namespace dpl
+{
+//============ DECLARATIONS ============//
+	template<typename CharT = char>
+	class	LabelPool;
+
+	template<typename CharT = char>
+	class	InternedLabel;
+
+//============ DEFINITIONS ============//
+	/*
+		Process-wide storage of unique label strings.
+		Each string is stored once and referenced with a 32-bit handle.
+		Records are reference counted and their slots are recycled when the last InternedLabel is destroyed.
+
+		Records live in fixed-size chunks that are never relocated,
+		so the string and its precomputed hash can be read without locking as long as the caller holds a handle.
+		Short labels fit in the small buffer of the record string, so they are stored in the chunk without a separate allocation.
+		Copies only touch the atomic counter of the record, the lock is taken when strings are inserted or erased.
+		Pool is never destroyed, so labels owned by other static objects can be released at any time.
+	*/
+	template<typename CharT>
+	class LabelPool
+	{
+	public: // relations
+		friend InternedLabel<CharT>;
+
+	public: // subtypes
+		using String	= std::basic_string<CharT>;
+		using View		= std::basic_string_view<CharT>;
+
+	public: // constants
+		static const uint32_t	INVALID_HANDLE	= 0xFFFFFFFF;
+		static const uint32_t	CHUNK_BITS		= 12;
+		static const uint32_t	CHUNK_SIZE		= 1 << CHUNK_BITS;
+		static const uint32_t	MAX_CHUNKS		= 1 << 12;
+
+	private: // subtypes
+		struct	Record
+		{
+			String					string;
+			size_t					hash		= 0;
+			std::atomic_uint32_t	numRefs		= 0;
+			bool					bStored		= false; // Record is in the lookup(guarded by the mutex).
+		};
+
+		using	Chunk		= std::array<Record, CHUNK_SIZE>;
+		using	Chunks		= std::array<std::unique_ptr<Chunk>, MAX_CHUNKS>;
+		using	Lookup		= std::unordered_map<View, uint32_t>;
+
+	private: // data
+		mutable std::mutex		m_mtx;
+		Chunks					m_chunks;
+		Lookup					m_lookup;
+		std::vector<uint32_t>	m_freeHandles;
+		uint32_t				m_numChunks;
+		uint32_t				m_numRecords;
+
+	public: // lifecycle
+		CLASS_CTOR				LabelPool()
+			: m_numChunks(0)
+			, m_numRecords(0)
+		{
+
+		}
+
+	private: // lifecycle
+		CLASS_CTOR				LabelPool(				const LabelPool&	OTHER) = delete;
+
+		LabelPool&				operator=(				const LabelPool&	OTHER) = delete;
+
+	public: // functions
+		static inline LabelPool&	ref()
+		{
+			static LabelPool* pool = new LabelPool(); // Leaked on purpose(see class description).
+			return *pool;
+		}
+
+		/*
+			Returns number of unique strings currently stored in the pool.
+		*/
+		inline uint32_t			size() const
+		{
+			std::lock_guard lock(m_mtx);
+			return static_cast<uint32_t>(m_lookup.size());
+		}
+
+		inline const String&	get_string(				const uint32_t		HANDLE) const
+		{
+			return get_record(HANDLE).string;
+		}
+
+		inline size_t			get_hash(				const uint32_t		HANDLE) const
+		{
+			return get_record(HANDLE).hash;
+		}
+
+	private: // functions
+		inline const Record&	get_record(				const uint32_t		HANDLE) const
+		{
+			return (*m_chunks[HANDLE >> CHUNK_BITS])[HANDLE & (CHUNK_SIZE-1)];
+		}
+
+		inline Record&			get_record(				const uint32_t		HANDLE)
+		{
+			return (*m_chunks[HANDLE >> CHUNK_BITS])[HANDLE & (CHUNK_SIZE-1)];
+		}
+
+		/*
+			Returns handle to the stored string (with incremented reference counter).
+			String is added to the pool if it was not found.
+		*/
+		uint32_t				acquire(				const View			STRING)
+		{
+			std::lock_guard lock(m_mtx);
+			auto it = m_lookup.find(STRING);
+			if(it != m_lookup.end())
+			{
+				get_record(it->second).numRefs.fetch_add(1, std::memory_order_relaxed);
+				return it->second;
+			}
+
+			const uint32_t	HANDLE	= create_record();
+			Record&			record	= get_record(HANDLE);
+							record.string	= STRING;
+							record.hash		= std::hash<View>()(STRING);
+							record.bStored	= true;
+							record.numRefs.store(1, std::memory_order_relaxed);
+			m_lookup.emplace(View(record.string), HANDLE);
+			return HANDLE;
+		}
+
+		/*
+			Returns handle to the stored string (with incremented reference counter), or INVALID_HANDLE if string is not in the pool.
+		*/
+		uint32_t				acquire_existing(		const View			STRING)
+		{
+			std::lock_guard lock(m_mtx);
+			auto it = m_lookup.find(STRING);
+			if(it == m_lookup.end()) return INVALID_HANDLE;
+			get_record(it->second).numRefs.fetch_add(1, std::memory_order_relaxed);
+			return it->second;
+		}
+
+		inline void				add_reference(			const uint32_t		HANDLE)
+		{
+			get_record(HANDLE).numRefs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/*
+			Record is erased by the thread that dropped the last reference,
+			unless it was acquired again from the lookup before the lock was taken(counter is checked again under the lock).
+		*/
+		void					release(				const uint32_t		HANDLE)
+		{
+			Record& record = get_record(HANDLE);
+			if(record.numRefs.fetch_sub(1, std::memory_order_acq_rel) > 1) return;
+
+			std::lock_guard lock(m_mtx);
+			if(!record.bStored || record.numRefs.load(std::memory_order_acquire) > 0) return;
+			record.bStored = false;
+			m_lookup.erase(View(record.string));
+			record.string.clear();
+			record.string.shrink_to_fit();
+			m_freeHandles.push_back(HANDLE);
+		}
+
+		inline uint32_t			create_record()
+		{
+			if(!m_freeHandles.empty())
+			{
+				const uint32_t HANDLE = m_freeHandles.back();
+				m_freeHandles.pop_back();
+				return HANDLE;
+			}
+
+			if(m_numRecords == m_numChunks * CHUNK_SIZE)
+			{
+				if(m_numChunks == MAX_CHUNKS) throw GeneralException(this, __LINE__, "Label pool is full.");
+				m_chunks[m_numChunks++] = std::make_unique<Chunk>();
+			}
+
+			return m_numRecords++;
+		}
+	};
+
+
+	/*
+		Reference to the string stored in the LabelPool.
+		Comparison is done by handle and hashing uses value precomputed by the pool.
+	*/
+	template<typename CharT>
+	class InternedLabel
+	{
+	public: // subtypes
+		using MyPool	= LabelPool<CharT>;
+		using String	= typename MyPool::String;
+		using View		= typename MyPool::View;
+
+	private: // data
+		uint32_t m_handle;
+
+	public: // lifecycle
+		CLASS_CTOR				InternedLabel()
+			: m_handle(MyPool::INVALID_HANDLE)
+		{
+
+		}
+
+		explicit				InternedLabel(			const View				STRING)
+			: m_handle(MyPool::ref().acquire(STRING))
+		{
+
+		}
+
+		CLASS_CTOR				InternedLabel(			const InternedLabel&	OTHER)
+			: m_handle(OTHER.m_handle)
+		{
+			if(is_valid()) MyPool::ref().add_reference(m_handle);
+		}
+
+		CLASS_CTOR				InternedLabel(			InternedLabel&&			other) noexcept
+			: m_handle(other.m_handle)
+		{
+			other.m_handle = MyPool::INVALID_HANDLE;
+		}
+
+		CLASS_DTOR				~InternedLabel()
+		{
+			reset();
+		}
+
+		InternedLabel&			operator=(				const InternedLabel&	OTHER)
+		{
+			if(m_handle != OTHER.m_handle)
+			{
+				reset();
+				m_handle = OTHER.m_handle;
+				if(is_valid()) MyPool::ref().add_reference(m_handle);
+			}
+
+			return *this;
+		}
+
+		InternedLabel&			operator=(				InternedLabel&&			other) noexcept
+		{
+			if(this != &other)
+			{
+				reset();
+				m_handle		= other.m_handle;
+				other.m_handle	= MyPool::INVALID_HANDLE;
+			}
+
+			return *this;
+		}
+
+	public: // operators
+		inline bool				operator==(				const InternedLabel&	OTHER) const
+		{
+			return m_handle == OTHER.m_handle;
+		}
+
+		inline bool				operator!=(				const InternedLabel&	OTHER) const
+		{
+			return m_handle != OTHER.m_handle;
+		}
+
+	public: // functions
+		/*
+			Returns interned label of the given string if it already exists in the pool,
+			otherwise returns invalid label (pool is not modified).
+		*/
+		static inline InternedLabel	find(				const View				STRING)
+		{
+			InternedLabel result;
+			result.m_handle = MyPool::ref().acquire_existing(STRING);
+			return result;
+		}
+
+		inline bool				is_valid() const
+		{
+			return m_handle != MyPool::INVALID_HANDLE;
+		}
+
+		inline uint32_t			handle() const
+		{
+			return m_handle;
+		}
+
+		inline size_t			hash() const
+		{
+			return is_valid()? MyPool::ref().get_hash(m_handle) : 0;
+		}
+
+		inline const String&	str() const
+		{
+			static const String EMPTY;
+			return is_valid()? MyPool::ref().get_string(m_handle) : EMPTY;
+		}
+
+		inline View				view() const
+		{
+			return View(str());
+		}
+
+		inline void				reset()
+		{
+			if(!is_valid()) return;
+			MyPool::ref().release(m_handle);
+			m_handle = MyPool::INVALID_HANDLE;
+		}
+	};
+}
+
+
+namespace std
+{
+	template<typename CharT>
+	struct hash<dpl::InternedLabel<CharT>>
+	{
+		inline size_t operator()(const dpl::InternedLabel<CharT>& LABEL) const
+		{
+			return LABEL.hash();
+		}
+	};
+}
\ No newline at end of file
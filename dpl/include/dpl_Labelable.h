@@ -5,7 +5,10 @@
 #include <string>
 #include <functional>
 #include <random>
+#include <limits>
+#include <unordered_map>
 #include "dpl_Archive.h"
+#include "dpl_LabelPool.h"
 #include "dpl_GeneralException.h"
 #include "dpl_Binary.h"
 
@@ -42,23 +45,33 @@ namespace dpl
 
 	/*
 		Labels labelable objects with unique names.
+		Names are interned in the LabelPool, so entries are compared by handle and hashed with precomputed values.
 	*/
 	template<typename CharT>
-	class Labeler : private Archive<Labelable<CharT>, typename Label<CharT>::Type>
+	class Labeler : private Archive<Labelable<CharT>, InternedLabel<CharT>>
 	{
 	private: // subtypes
 		using MyLabel		= typename Label<CharT>::Type;
+		using MyView		= typename Label<CharT>::View;
+		using MyInterned	= InternedLabel<CharT>;
 		using MyLabelable	= Labelable<CharT>;
-		using MyBase		= Archive<MyLabelable, MyLabel>;
+		using MyBase		= Archive<MyLabelable, MyInterned>;
+		using MyCounters	= std::unordered_map<size_t, uint32_t>; // Indexed by the hash of the base name(collision only skips some postfixes).
+
+	public: // relations
+		friend MyLabelable;
 
 	public: // constants
 		static const uint32_t	MIN_CHARACTERS	= 2;
 		static const uint32_t	MAX_CHARACTERS	= 256;
+		static const uint32_t	MAX_COUNTERS	= 4096; // Counters are only hints, they are cleared when there are too many base names.
 
 	public: // subtypes
-		using Indexer		= std::function<uint32_t()>;
 		using MyBase::find_entry;
 
+	private: // data
+		MyCounters m_postfixCounters; // Next free postfix index of each base name.
+
 	public: // lifecycle
 		CLASS_CTOR				Labeler() = default;
 
@@ -75,6 +88,7 @@ namespace dpl
 		inline Labeler&			operator=(				Swap<Labeler>&			other)
 		{
 			MyBase::operator=(Swap<MyBase>(*other));
+			m_postfixCounters.swap(other->m_postfixCounters);
 			return *this;
 		}
 
@@ -82,51 +96,53 @@ namespace dpl
 		inline void				label(					MyLabelable&			labelable,
 														const MyLabel&			LABEL)
 		{
-			if(!is_valid_numCharacters((uint32_t)LABEL.size())) throw_name_invalid(LABEL);
-			if(!label_internal(labelable, LABEL))				throw_name_not_unique(LABEL);
-		}
-
-		void					label_with_postfix(		MyLabelable&			labelable,
-														const MyLabel&			LABEL,
-														const Indexer&			INDEXER,
-														const uint32_t			MAX_RANDOM_ATTEMPTS = 10)
-		{
-			if(label_by_index(labelable, LABEL, INDEXER))				return;
-			if(label_by_pointer(labelable, LABEL))						return;
-			if(label_by_random(labelable, LABEL, MAX_RANDOM_ATTEMPTS))	return;
-			throw_name_generation_failed();
+			if(!is_valid_numCharacters((uint32_t)LABEL.size()))	throw_name_invalid(LABEL);
+			if(!label_internal(labelable, MyInterned(LABEL)))	throw_name_not_unique(LABEL);
 		}
 
 		inline void				label_with_postfix(		MyLabelable&			labelable,
-														const MyLabel&			LABEL,
-														const uint32_t			MAX_RANDOM_ATTEMPTS = 10)
+														const MyLabel&			LABEL)
 		{
-			return label_with_postfix(labelable, LABEL, get_default_indexer(), MAX_RANDOM_ATTEMPTS);
+			if(!label_internal(labelable, generate_unique_label(LABEL))) throw_name_generation_failed();
 		}
 
-		inline std::string		generate_indexed_label(	const MyLabel&			LABEL,
-														const Indexer&			INDEXER) const
+		/*
+			Returns name composed of the given base and the first free postfix index.
+			Each base name has its own counter, so the name is usually found at the first attempt.
+			Retries only happen when the user explicitly took the generated name before, or the counters were cleared.
+			Base names are not interned, so they are released with the last object that uses them.
+		*/
+		MyInterned				generate_unique_label(	const MyLabel&			LABEL)
 		{
-			return LABEL + std::to_string(INDEXER());
-		}
+			if(m_postfixCounters.size() >= MAX_COUNTERS) m_postfixCounters.clear();
+			uint32_t&		counter		= m_postfixCounters[std::hash<MyView>()(LABEL)];
+			MyLabel			candidate	= LABEL;
+			const size_t	BASE_SIZE	= LABEL.size();
 
-		inline std::string		generate_indexed_label(	const MyLabel&			LABEL) const
-		{
-			return LABEL + std::to_string(get_default_indexer());
+			while(counter < std::numeric_limits<uint32_t>::max())
+			{
+				candidate.resize(BASE_SIZE);
+				append_index(candidate, counter++);
+				const MyInterned EXISTING = MyInterned::find(candidate);
+				if(!EXISTING.is_valid())				return MyInterned(candidate);
+				if(!MyBase::find_entry(EXISTING))		return EXISTING;
+			}
+
+			throw_name_generation_failed();
+			return MyInterned();
 		}
 
-		inline std::string		generate_pointer_label(	const MyLabel&			LABEL,
-														const void*				ADDRESS) const
+		inline MyLabelable*		find_entry(				const MyView			LABEL)
 		{
-			return LABEL + std::to_string(uint64_t(ADDRESS));
+			const MyInterned INTERNED = MyInterned::find(LABEL);
+			return INTERNED.is_valid()? MyBase::find_entry(INTERNED) : nullptr;
 		}
 
-		inline std::string		generate_random_label(	const MyLabel&			LABEL) const
+		inline const MyLabelable*	find_entry(			const MyView			LABEL) const
 		{
-			static const std::uniform_int_distribution<uint64_t> UINT_DIST;
-			thread_local std::mt19937	rng;
-			return LABEL + std::to_string(UINT_DIST(rng));
-		}	
+			const MyInterned INTERNED = MyInterned::find(LABEL);
+			return INTERNED.is_valid()? MyBase::find_entry(INTERNED) : nullptr;
+		}
 
 	private: // functions
 		inline bool				is_valid_numCharacters(	const uint32_t			NUM_CHARACTERS) const
@@ -134,42 +150,17 @@ namespace dpl
 			return NUM_CHARACTERS >= MIN_CHARACTERS && NUM_CHARACTERS <= MAX_CHARACTERS;
 		}
 
-		inline const Indexer	get_default_indexer()
-		{
-			// Delegated to a function because compiler complains about the same function name.
-			return [&](){return MyBase::get_numEntries();};
-		}
-
 		inline bool				label_internal(			MyLabelable&			labelable,
-														const MyLabel&			LABEL)
+														const MyInterned&		LABEL)
 		{
 			return MyBase::add_entry(labelable, LABEL);
 		}
 
-		inline bool				label_by_index(			MyLabelable&			labelable,
-														const MyLabel&			LABEL,
-														const Indexer&			INDEXER)
-		{
-			return label_internal(labelable, generate_indexed_label(LABEL, INDEXER));
-		}
-
-		inline bool				label_by_pointer(		MyLabelable&			labelable,
-														const MyLabel&			LABEL)
-		{
-			return label_internal(labelable, LABEL + generate_pointer_label(&labelable));
-		}
-
-		inline bool				label_by_random(		MyLabelable&			labelable,
-														const MyLabel&			LABEL,
-														uint32_t				attempts = 10)
+		static inline void		append_index(			MyLabel&				label,
+														const uint32_t			INDEX)
 		{
-			while(attempts-- > 0)
-			{
-				if(label_internal(labelable, generate_random_label(LABEL)))
-					return true; // success!
-			}
-
-			return false;
+			if constexpr (std::is_same_v<CharT, wchar_t>)	label += std::to_wstring(INDEX);
+			else											label += std::to_string(INDEX);
 		}
 
 	private: // exceptions
@@ -194,12 +185,13 @@ namespace dpl
 		Interface for uniquely named objects.
 	*/
 	template<typename CharT>
-	class Labelable : public Entry<Labelable<CharT>, typename Label<CharT>::Type>
+	class Labelable : public Entry<Labelable<CharT>, InternedLabel<CharT>>
 	{
 	private: // subtypes
 		using MyLabel		= typename Label<CharT>::Type;
+		using MyInterned	= InternedLabel<CharT>;
 		using MyLabeler		= Labeler<CharT>;
-		using MyEntryType	= Entry<Labelable<CharT>, MyLabel>;
+		using MyEntryType	= Entry<Labelable<CharT>, MyInterned>;
 
 	public: // relations
 		friend MyLabeler;
@@ -231,7 +223,7 @@ namespace dpl
 
 		const MyLabel&				get_label() const
 		{
-			if(MyEntryType::archive()) return MyEntryType::get_key_value();
+			if(MyEntryType::archive()) return MyEntryType::get_key_value().str();
 			if constexpr (std::is_same_v<MyLabel, typename Label<char>::Type>)
 			{
 				static const std::string MISSING = "??text_missing??";
@@ -244,6 +236,15 @@ namespace dpl
 			}
 		}
 
+		/*
+			Returns pooled label of this object. Interned labels can be compared by handle.
+		*/
+		inline const MyInterned&	get_interned_label() const
+		{
+			static const MyInterned INVALID;
+			return MyEntryType::archive()? MyEntryType::get_key_value() : INVALID;
+		}
+
 	protected: // functions
 		inline MyLabeler*			get_labeler()
 		{
@@ -257,7 +258,7 @@ namespace dpl
 
 		inline bool					change_label(				const MyLabel&			NEW_NAME)
 		{
-			return NEW_NAME.size() > 0 ? MyEntryType::change_key_value(NEW_NAME) : false;
+			return NEW_NAME.size() > 0 ? MyEntryType::change_key_value(MyInterned(NEW_NAME)) : false;
 		}
 
 		bool						change_to_generic_label(	const MyLabel&			GENERIC_NAME)
@@ -266,9 +267,7 @@ namespace dpl
 			{
 				if(!GENERIC_NAME.empty())
 				{
-					if(MyEntryType::change_key_value(labeler->generate_indexed_label(GENERIC_NAME)))		return true;
-					if(MyEntryType::change_key_value(labeler->generate_pointer_label(GENERIC_NAME, this)))	return true;
-					if(MyEntryType::change_key_value(labeler->generate_random_label(GENERIC_NAME)))			return true;
+					return MyEntryType::change_key_value(labeler->generate_unique_label(GENERIC_NAME));
 				}
 			}
 
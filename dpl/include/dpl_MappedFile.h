@@ -0,0 +1,74 @@
+#pragma once
+
+
+#include <string>
+#include <stdint.h>
+#include "dpl_ClassInfo.h"
+
+
+#ifdef _MSC_VER
+#pragma comment(lib, "dpl.lib")
+#endif
+
+
+namespace dpl
+{
+	/*
+		Read-only view of the whole file mapped into memory.
+		Pages are loaded by the system on first access, so only the parts that are actually read cost I/O.
+		System calls are implemented in dpl_MappedFile.cpp, so that windows.h(and its macros) never leaks into the includers.
+	*/
+	class MappedFile
+	{
+	private: // data
+		const uint8_t*	m_data;
+		size_t			m_size;
+		void*			m_file;		// HANDLE on Windows.
+		void*			m_mapping;	// HANDLE on Windows.
+
+	public: // lifecycle
+		CLASS_CTOR				MappedFile()
+			: m_data(nullptr)
+			, m_size(0)
+			, m_file(nullptr)
+			, m_mapping(nullptr)
+		{
+
+		}
+
+		CLASS_CTOR				MappedFile(	const MappedFile&	OTHER) = delete;
+
+		CLASS_DTOR				~MappedFile()
+		{
+			close();
+		}
+
+		MappedFile&				operator=(	const MappedFile&	OTHER) = delete;
+
+	public: // functions
+		inline bool				is_open() const
+		{
+			return m_data != nullptr;
+		}
+
+		inline const uint8_t*	data() const
+		{
+			return m_data;
+		}
+
+		inline size_t			size() const
+		{
+			return m_size;
+		}
+
+		/*
+			Returns false if the file could not be mapped(empty files are never mapped).
+		*/
+		bool					open(		const std::string&	FILE_PATH);
+
+		/*
+			Always returns false(helps to close the file on failure).
+		*/
+		bool					close();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+
+
+#include <vector>
+#include <limits>
+#include "dpl_Chain.h"
+
+
+#pragma pack(push, 4)
+
+// declarations
+namespace dpl
+{
+	template<typename ChainT, typename LinkT, uint32_t ID = 0>
+	class PackedChain;
+
+	template<typename ChainT, typename LinkT, uint32_t ID = 0>
+	class PackedLink;
+}
+
+// implementations
+namespace dpl
+{
+	/*
+		Link that remembers its position in the dense array of the PackedChain.
+		Note: ChainT must be publicly derived from the PackedChain.
+	*/
+	template<typename ChainT, typename LinkT, uint32_t ID>
+	class PackedLink : public Link<ChainT, LinkT, ID>
+	{
+	protected: // subtypes
+		using	MyBase			= Link<ChainT, LinkT, ID>;
+		using	MyPackedChain	= PackedChain<ChainT, LinkT, ID>;
+
+	public: // relations
+		friend	MyPackedChain;
+
+	public: // constants
+		static const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	private: // data
+		uint32_t m_packedIndex;
+
+	protected: // lifecycle
+		CLASS_CTOR				PackedLink()
+			: m_packedIndex(INVALID_INDEX)
+		{
+
+		}
+
+		CLASS_CTOR				PackedLink(		MyPackedChain&		chain)
+			: PackedLink()
+		{
+			chain.attach_back(*this);
+		}
+
+		CLASS_CTOR				PackedLink(		const PackedLink&	OTHER) = delete;
+
+		CLASS_CTOR				PackedLink(		PackedLink&&		other) noexcept
+			: MyBase(std::move(other))
+			, m_packedIndex(other.m_packedIndex)
+		{
+			other.m_packedIndex = INVALID_INDEX;
+			update_packed_entry();
+		}
+
+		CLASS_DTOR				~PackedLink()
+		{
+			remove_packed_entry();
+		}
+
+		PackedLink&				operator=(		const PackedLink&	OTHER) = delete;
+
+		PackedLink&				operator=(		PackedLink&&		other) noexcept
+		{
+			remove_packed_entry();
+			MyBase::operator=(std::move(other));
+			m_packedIndex		= other.m_packedIndex;
+			other.m_packedIndex = INVALID_INDEX;
+			update_packed_entry();
+			return *this;
+		}
+
+		inline PackedLink&		operator=(		Swap<PackedLink>	other)
+		{
+			MyBase::operator=(Swap<MyBase>(*other));
+			std::swap(m_packedIndex, other->m_packedIndex);
+			this->update_packed_entry();
+			other->update_packed_entry();
+			return *this;
+		}
+
+		inline PackedLink&		operator=(		Swap<LinkT>			other)
+		{
+			return operator=(Swap<PackedLink>(*other));
+		}
+
+	public: // functions
+		/*
+			Returns index of this link in the dense array of the chain, or INVALID_INDEX if link is not attached.
+		*/
+		inline uint32_t			get_packed_index() const
+		{
+			return m_packedIndex;
+		}
+
+	protected: // functions
+		/*
+			Remove this link from the chain.
+		*/
+		inline void				detach()
+		{
+			remove_packed_entry();
+			MyBase::detach();
+		}
+
+	private: // functions
+		inline LinkT*			cast()
+		{
+			return static_cast<LinkT*>(this);
+		}
+
+		inline const LinkT*		cast() const
+		{
+			return static_cast<const LinkT*>(this);
+		}
+
+		inline MyPackedChain*	get_packed_chain()
+		{
+			return static_cast<MyPackedChain*>(MyBase::get_chain());
+		}
+
+		/*
+			Points dense array entry at this link(called after relocation).
+		*/
+		inline void				update_packed_entry()
+		{
+			if(m_packedIndex != INVALID_INDEX)
+			{
+				get_packed_chain()->m_packed[m_packedIndex] = this;
+			}
+		}
+
+		inline void				remove_packed_entry()
+		{
+			if(m_packedIndex != INVALID_INDEX)
+			{
+				get_packed_chain()->erase_packed(*this);
+			}
+		}
+	};
+
+
+	/*
+		Chain that keeps pointers to its links in a dense array next to the intrusive sequence.
+		Iteration over the array does not chase pointers scattered across the heap.
+
+		Links are removed from the array with swap-remove, so the order of the array is not preserved.
+		Use sequence functions of the base Chain when the order of links matters.
+	*/
+	template<typename ChainT, typename LinkT, uint32_t ID>
+	class PackedChain : public Chain<ChainT, LinkT, ID>
+	{
+	protected: // subtypes
+		using	MyBase			= Chain<ChainT, LinkT, ID>;
+		using	MyPackedLink	= PackedLink<ChainT, LinkT, ID>;
+
+	public: // relations
+		friend	MyPackedLink;
+
+	private: // data
+		std::vector<MyPackedLink*> m_packed;
+
+	protected: // lifecycle
+		CLASS_CTOR				PackedChain() = default;
+
+		CLASS_CTOR				PackedChain(			const PackedChain&					OTHER) = delete;
+
+		CLASS_CTOR				PackedChain(			PackedChain&&						other) noexcept
+			: MyBase(std::move(other))
+			, m_packed(std::move(other.m_packed))
+		{
+			other.m_packed.clear();
+		}
+
+		CLASS_DTOR				~PackedChain()
+		{
+			remove_all_links();
+		}
+
+		PackedChain&			operator=(				const PackedChain&					OTHER) = delete;
+
+		PackedChain&			operator=(				PackedChain&&						other) noexcept
+		{
+			remove_all_links();//<-- Indices of our links must be invalidated before the base removes them.
+			MyBase::operator=(std::move(other));
+			m_packed = std::move(other.m_packed);
+			other.m_packed.clear();
+			return *this;
+		}
+
+		PackedChain&			operator=(				Swap<PackedChain>					other)
+		{
+			MyBase::operator=(Swap<MyBase>(*other));
+			m_packed.swap(other->m_packed);
+			return *this;
+		}
+
+		inline PackedChain&		operator=(				Swap<ChainT>						other)
+		{
+			return operator=(Swap<PackedChain>(*other));
+		}
+
+	public: // functions
+		inline void				reserve_packed(			const uint32_t						NUM_LINKS)
+		{
+			m_packed.reserve(NUM_LINKS);
+		}
+
+		inline const LinkT&		get_packed(				const uint32_t						INDEX) const
+		{
+			return *m_packed[INDEX]->cast();
+		}
+
+		/*
+			Loops over the dense array of links and returns their number.
+			Order of the links may differ from the order of the sequence.
+		*/
+		template<typename FunctionT>
+		inline uint32_t			for_each_packed(		FunctionT&&							FUNCTION) const
+		{
+			for(const MyPackedLink* LINK : m_packed)
+			{
+				FUNCTION(*LINK->cast());
+			}
+
+			return static_cast<uint32_t>(m_packed.size());
+		}
+
+	protected: // functions
+		inline LinkT&			get_packed(				const uint32_t						INDEX)
+		{
+			return *m_packed[INDEX]->cast();
+		}
+
+		/*
+			Link may detach itself from the chain during the call(link that takes its place is called next).
+		*/
+		template<typename FunctionT>
+		inline uint32_t			for_each_packed(		FunctionT&&							function)
+		{
+			uint32_t numCalls = 0;
+			for(uint32_t index = 0; index < m_packed.size(); ++numCalls)
+			{
+				MyPackedLink* link = m_packed[index];
+				function(*link->cast());
+				if(index < m_packed.size() && m_packed[index] == link) ++index;
+			}
+
+			return numCalls;
+		}
+
+		/*
+			Adds given link at the front of the chain.
+			Returns false if link is already attached.
+		*/
+		bool					attach_front(			MyPackedLink&						newLink)
+		{
+			if(newLink.is_linked(*this)) return false;
+			newLink.remove_packed_entry();
+			MyBase::attach_front(newLink);
+			push_packed(newLink);
+			return true;
+		}
+
+		/*
+			Adds given link at the end of the chain.
+			Returns false if link is already attached.
+		*/
+		bool					attach_back(			MyPackedLink&						newLink)
+		{
+			if(newLink.is_linked(*this)) return false;
+			newLink.remove_packed_entry();
+			MyBase::attach_back(newLink);
+			push_packed(newLink);
+			return true;
+		}
+
+		inline bool				detach_link(			MyPackedLink&						link)
+		{
+			if(!link.is_linked(*this)) return false;
+			link.detach();
+			return true;
+		}
+
+		/*
+			Removes all links from this chain.
+		*/
+		bool					remove_all_links()
+		{
+			for(MyPackedLink* link : m_packed)
+			{
+				link->m_packedIndex = MyPackedLink::INVALID_INDEX;
+			}
+
+			m_packed.clear();
+			return MyBase::remove_all_links();
+		}
+
+	private: // functions
+		inline void				push_packed(			MyPackedLink&						link)
+		{
+			link.m_packedIndex = static_cast<uint32_t>(m_packed.size());
+			m_packed.push_back(&link);
+		}
+
+		inline void				erase_packed(			MyPackedLink&						link)
+		{
+			MyPackedLink* lastLink = m_packed.back();
+			m_packed[link.m_packedIndex] = lastLink;
+			lastLink->m_packedIndex = link.m_packedIndex;
+			m_packed.pop_back();
+			link.m_packedIndex = MyPackedLink::INVALID_INDEX;
+		}
+	};
+}
+
+#pragma pack(pop)
\ No newline at end of file
@@ -0,0 +1,275 @@
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_set>
+#include "dpl_ClassInfo.h"
+
+
+namespace dpl
+{
+	/*
+		Lightweight profiler of the scoped zones.
+
+		Each thread records zones into its own ring buffer(no locking on the hot path),
+		the oldest zones are overwritten when the ring is full.
+		Ring of the finished thread is kept for the export until another thread takes it over, so memory is bounded by the number of concurrent threads.
+		When profiler is disabled, zone costs a single relaxed atomic load.
+
+		Note: Zone names are stored as pointers, so they must outlive the export(string literals or names returned by intern).
+	*/
+	class Profiler
+	{
+	public: // subtypes
+		using	Clock	= std::chrono::steady_clock;
+
+		struct	Zone
+		{
+			const char*	name;
+			int64_t		begin;	// [ns] since the start of the profiler
+			int64_t		end;	// [ns] since the start of the profiler
+		};
+
+	public: // constants
+		static const uint32_t RING_SIZE = 1 << 16; // Number of zones stored per thread.
+
+	private: // subtypes
+		struct	Ring
+		{
+			std::unique_ptr<Zone[]>	zones;
+			std::atomic_uint64_t	numZones;	// Total number of recorded zones(also index of the next one).
+			uint32_t				threadID;
+
+			CLASS_CTOR				Ring()
+				: zones(std::make_unique<Zone[]>(RING_SIZE))
+				, numZones(0)
+				, threadID(0)
+			{
+
+			}
+		};
+
+		/*
+			Returns ring to the profiler when the thread ends.
+		*/
+		struct	ThreadRing
+		{
+			Ring* ring = nullptr;
+
+			CLASS_DTOR				~ThreadRing()
+			{
+				if(ring) Profiler::ref().release_ring(*ring);
+			}
+		};
+
+	private: // data
+		mutable std::mutex					m_mtx;
+		std::vector<std::unique_ptr<Ring>>	m_rings;
+		std::vector<Ring*>					m_freeRings;	// Rings of the finished threads(their zones can still be exported).
+		uint32_t							m_nextThreadID;
+		std::mutex							m_namesMtx;
+		std::unordered_set<std::string>		m_names;		// Node based, so pointers to the names stay valid.
+		std::atomic_bool					bEnabled;
+		const Clock::time_point				START;
+
+	private: // lifecycle
+		CLASS_CTOR				Profiler()
+			: m_nextThreadID(0)
+			, bEnabled(false)
+			, START(Clock::now())
+		{
+
+		}
+
+		CLASS_CTOR				Profiler(		const Profiler&		OTHER) = delete;
+
+		Profiler&				operator=(		const Profiler&		OTHER) = delete;
+
+	public: // functions
+		/*
+			Profiler is never destroyed, so threads ending during the static destruction can still release their rings.
+		*/
+		static inline Profiler&	ref()
+		{
+			static Profiler* profiler = new Profiler();
+			return *profiler;
+		}
+
+		inline bool				is_enabled() const
+		{
+			return bEnabled.load(std::memory_order_relaxed);
+		}
+
+		inline void				enable()
+		{
+			bEnabled.store(true, std::memory_order_relaxed);
+		}
+
+		inline void				disable()
+		{
+			bEnabled.store(false, std::memory_order_relaxed);
+		}
+
+		inline int64_t			now() const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - START).count();
+		}
+
+		/*
+			Returns copy of the name that lives as long as the profiler(for names that may be destroyed before the export).
+		*/
+		inline const char*		intern(			const std::string&	NAME)
+		{
+			std::lock_guard lock(m_namesMtx);
+			return m_names.emplace(NAME).first->c_str();
+		}
+
+		/*
+			Stores zone in the ring of the calling thread.
+		*/
+		inline void				record(			const char*			NAME,
+												const int64_t		BEGIN,
+												const int64_t		END)
+		{
+			Ring&			ring	= get_thread_ring();
+			const uint64_t	INDEX	= ring.numZones.load(std::memory_order_relaxed);
+			ring.zones[INDEX % RING_SIZE] = Zone{NAME, BEGIN, END};
+			ring.numZones.store(INDEX + 1, std::memory_order_release);
+		}
+
+		/*
+			Removes all recorded zones.
+			Note: Should not be called while other threads record zones.
+		*/
+		void					clear()
+		{
+			std::lock_guard lock(m_mtx);
+			for(auto& ring : m_rings)
+			{
+				ring->numZones.store(0, std::memory_order_release);
+			}
+		}
+
+		/*
+			Exports recorded zones in the Chrome trace format(chrome://tracing, Perfetto).
+			Note: Profiler should be disabled during export, otherwise the oldest zones may be overwritten while they are read.
+		*/
+		bool					export_chrome_trace(const std::string&	FILE_PATH) const
+		{
+			std::ofstream file(FILE_PATH, std::ios::trunc);
+			if(file.fail() || file.bad()) return false;
+
+			file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+			bool bFirst = true;
+
+			std::lock_guard lock(m_mtx);
+			for(const auto& RING : m_rings)
+			{
+				const uint64_t NUM_ZONES	= RING->numZones.load(std::memory_order_acquire);
+				const uint64_t FIRST		= (NUM_ZONES > RING_SIZE)? NUM_ZONES - RING_SIZE : 0;
+				for(uint64_t index = FIRST; index < NUM_ZONES; ++index)
+				{
+					const Zone& ZONE = RING->zones[index % RING_SIZE];
+					if(!bFirst) file << ',';
+					bFirst = false;
+
+					file << "\n{\"name\":\"";
+					write_escaped(file, ZONE.name);
+					file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << RING->threadID
+						 << ",\"ts\":"	<< ZONE.begin / 1000.0
+						 << ",\"dur\":"	<< (ZONE.end - ZONE.begin) / 1000.0 << '}';
+				}
+			}
+
+			file << "\n]}";
+			return file.good();
+		}
+
+	private: // functions
+		inline Ring&			get_thread_ring()
+		{
+			thread_local ThreadRing thread;
+			if(!thread.ring)
+			{
+				std::lock_guard lock(m_mtx);
+				if(m_freeRings.empty())
+				{
+					thread.ring = m_rings.emplace_back(std::make_unique<Ring>()).get();
+				}
+				else
+				{
+					thread.ring = m_freeRings.back();
+					m_freeRings.pop_back();
+					thread.ring->numZones.store(0, std::memory_order_release);
+				}
+				thread.ring->threadID = m_nextThreadID++;
+			}
+			return *thread.ring;
+		}
+
+		inline void				release_ring(	Ring&				ring)
+		{
+			std::lock_guard lock(m_mtx);
+			m_freeRings.push_back(&ring);
+		}
+
+		static void				write_escaped(	std::ostream&		stream,
+												const char*			NAME)
+		{
+			for(const char* it = NAME; *it != '\0'; ++it)
+			{
+				if(*it == '"' || *it == '\\')	stream << '\\' << *it;
+				else if(*it >= ' ')				stream << *it;
+			}
+		}
+	};
+
+
+	/*
+		Records time between construction and destruction of the object.
+	*/
+	class ProfileZone
+	{
+	private: // data
+		const char*	m_name; // Null if profiler was disabled when zone started.
+		int64_t		m_begin;
+
+	public: // lifecycle
+		/*
+			NAME must outlive the export(e.g. string literal).
+		*/
+		CLASS_CTOR				ProfileZone(	const char*			NAME)
+			: m_name(Profiler::ref().is_enabled()? NAME : nullptr)
+			, m_begin(m_name? Profiler::ref().now() : 0)
+		{
+
+		}
+
+		/*
+			Name is interned by the profiler(only when it is enabled).
+		*/
+		CLASS_CTOR				ProfileZone(	const std::string&	NAME)
+			: m_name(Profiler::ref().is_enabled()? Profiler::ref().intern(NAME) : nullptr)
+			, m_begin(m_name? Profiler::ref().now() : 0)
+		{
+
+		}
+
+		CLASS_DTOR				~ProfileZone()
+		{
+			if(m_name) Profiler::ref().record(m_name, m_begin, Profiler::ref().now());
+		}
+
+		CLASS_CTOR				ProfileZone(	const ProfileZone&	OTHER) = delete;
+
+		ProfileZone&			operator=(		const ProfileZone&	OTHER) = delete;
+	};
+}
\ No newline at end of file
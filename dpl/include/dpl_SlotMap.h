@@ -0,0 +1,335 @@
+#pragma once
+
+
+#include <vector>
+#include <stdint.h>
+#include <limits>
+#include "dpl_Repository.h"
+
+
+namespace dpl
+{
+	/*
+		Stores values in a dense array and gives access to them through generational handles.
+		Insertion and removal are O(1). Removed value is replaced with the last one(swap-remove),
+		so iteration over the values never visits holes, but their order is not preserved.
+
+		Handle becomes stale when its value is removed. Stale handles are detected with the generation counter
+		of the slot, even after the slot was reused by another value.
+	*/
+	template<typename T>
+	class	SlotMap
+	{
+	public: // constants
+		static const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+	public: // subtypes
+		class	Handle
+		{
+		public: // relations
+			friend SlotMap;
+
+		public: // data
+			uint32_t index;
+			uint32_t generation;
+
+		public: // lifecycle
+			CLASS_CTOR		Handle()
+				: index(INVALID_INDEX)
+				, generation(0)
+			{
+
+			}
+
+		private: // lifecycle
+			CLASS_CTOR		Handle(		const uint32_t	INDEX,
+										const uint32_t	GENERATION)
+				: index(INDEX)
+				, generation(GENERATION)
+			{
+
+			}
+
+		public: // operators
+			inline bool		operator==(	const Handle&	OTHER) const
+			{
+				return index == OTHER.index && generation == OTHER.generation;
+			}
+
+			inline bool		operator!=(	const Handle&	OTHER) const
+			{
+				return !operator==(OTHER);
+			}
+
+		public: // functions
+			inline bool		is_valid() const
+			{
+				return index != INVALID_INDEX;
+			}
+		};
+
+	private: // subtypes
+		struct	Slot
+		{
+			uint32_t	target;		// Index of the value in the dense array, or index of the next free slot.
+			uint32_t	generation;	// Odd if the slot is occupied.
+		};
+
+	private: // data
+		std::vector<T>			m_values;
+		std::vector<uint32_t>	m_owners;	// Slot of the value at the same index.
+		std::vector<Slot>		m_slots;
+		uint32_t				m_freeSlot;	// Head of the list of free slots.
+
+	public: // lifecycle
+		CLASS_CTOR				SlotMap()
+			: m_freeSlot(INVALID_INDEX)
+		{
+
+		}
+
+		CLASS_CTOR				SlotMap(		const SlotMap&		OTHER) = default;
+
+		CLASS_CTOR				SlotMap(		SlotMap&&			other) noexcept
+			: m_values(std::move(other.m_values))
+			, m_owners(std::move(other.m_owners))
+			, m_slots(std::move(other.m_slots))
+			, m_freeSlot(other.m_freeSlot)
+		{
+			other.m_freeSlot = INVALID_INDEX;
+		}
+
+		SlotMap&				operator=(		const SlotMap&		OTHER) = default;
+
+		SlotMap&				operator=(		SlotMap&&			other) noexcept
+		{
+			m_values			= std::move(other.m_values);
+			m_owners			= std::move(other.m_owners);
+			m_slots				= std::move(other.m_slots);
+			m_freeSlot			= other.m_freeSlot;
+			other.m_freeSlot	= INVALID_INDEX;
+			return *this;
+		}
+
+	public: // functions
+		inline uint32_t			size() const
+		{
+			return static_cast<uint32_t>(m_values.size());
+		}
+
+		inline bool				empty() const
+		{
+			return m_values.empty();
+		}
+
+		inline void				reserve(		const uint32_t		CAPACITY)
+		{
+			m_values.reserve(CAPACITY);
+			m_owners.reserve(CAPACITY);
+			m_slots.reserve(CAPACITY);
+		}
+
+		/*
+			Returns true if handle points to the existing value.
+		*/
+		inline bool				contains(		const Handle		HANDLE) const
+		{
+			return HANDLE.index < m_slots.size() && m_slots[HANDLE.index].generation == HANDLE.generation;
+		}
+
+		inline T*				find(			const Handle		HANDLE)
+		{
+			return contains(HANDLE) ? &m_values[m_slots[HANDLE.index].target] : nullptr;
+		}
+
+		inline const T*			find(			const Handle		HANDLE) const
+		{
+			return contains(HANDLE) ? &m_values[m_slots[HANDLE.index].target] : nullptr;
+		}
+
+		inline T&				get(			const Handle		HANDLE)
+		{
+			validate(HANDLE);
+			return m_values[m_slots[HANDLE.index].target];
+		}
+
+		inline const T&			get(			const Handle		HANDLE) const
+		{
+			validate(HANDLE);
+			return m_values[m_slots[HANDLE.index].target];
+		}
+
+		/*
+			Returns handle of the value at the given position in the dense array.
+		*/
+		inline Handle			get_handle(		const uint32_t		DENSE_INDEX) const
+		{
+			const uint32_t SLOT_INDEX = m_owners[DENSE_INDEX];
+			return Handle(SLOT_INDEX, m_slots[SLOT_INDEX].generation);
+		}
+
+		inline T*				data()
+		{
+			return m_values.data();
+		}
+
+		inline const T*			data() const
+		{
+			return m_values.data();
+		}
+
+		template<typename... CTOR>
+		Handle					emplace(		CTOR&&...			args)
+		{
+			const uint32_t	SLOT_INDEX	= acquire_slot();
+			Slot&			slot		= m_slots[SLOT_INDEX];
+							slot.target	= size();
+							++slot.generation;
+
+			m_values.emplace_back(std::forward<CTOR>(args)...);
+			m_owners.push_back(SLOT_INDEX);
+			return Handle(SLOT_INDEX, slot.generation);
+		}
+
+		/*
+			Returns false if handle is stale.
+		*/
+		bool					erase(			const Handle		HANDLE)
+		{
+			if(!contains(HANDLE)) return false;
+
+			Slot&			slot			= m_slots[HANDLE.index];
+			const uint32_t	DENSE_INDEX		= slot.target;
+			const uint32_t	LAST_INDEX		= size() - 1;
+
+			if(DENSE_INDEX != LAST_INDEX)
+			{
+				m_values[DENSE_INDEX]					= std::move(m_values[LAST_INDEX]);
+				m_owners[DENSE_INDEX]					= m_owners[LAST_INDEX];
+				m_slots[m_owners[DENSE_INDEX]].target	= DENSE_INDEX;
+			}
+
+			m_values.pop_back();
+			m_owners.pop_back();
+			release_slot(HANDLE.index);
+			return true;
+		}
+
+		/*
+			Removes all values. All handles become stale.
+		*/
+		void					clear()
+		{
+			m_values.clear();
+			m_owners.clear();
+			for(uint32_t index = 0; index < m_slots.size(); ++index)
+			{
+				if(is_occupied(m_slots[index])) release_slot(index);
+			}
+		}
+
+		template<typename FunctionT>
+		inline void				for_each(		FunctionT&&			function)
+		{
+			for(T& value : m_values)
+			{
+				function(value);
+			}
+		}
+
+		template<typename FunctionT>
+		inline void				for_each(		FunctionT&&			FUNCTION) const
+		{
+			for(const T& VALUE : m_values)
+			{
+				FUNCTION(VALUE);
+			}
+		}
+
+	public: // iterators
+		inline auto				begin()
+		{
+			return m_values.begin();
+		}
+
+		inline auto				begin() const
+		{
+			return m_values.begin();
+		}
+
+		inline auto				end()
+		{
+			return m_values.end();
+		}
+
+		inline auto				end() const
+		{
+			return m_values.end();
+		}
+
+	public: // import/export
+		template<typename ImportF = DefaultImport<T>>
+		void					import_from(	std::istream&		binary,
+												ImportF				on_import = DefaultImport<T>())
+		{
+			m_values.clear();
+			dpl::import_dynamic_container(binary, m_owners);
+			dpl::import_dynamic_container(binary, m_slots);
+			dpl::import_t(binary, m_freeSlot);
+			m_values.resize(m_owners.size());
+			for(T& value : m_values)
+			{
+				on_import(value, binary);
+			}
+		}
+
+		template<typename ExportF = DefaultExport<T>>
+		void					export_to(		std::ostream&		binary,
+												ExportF				on_export = DefaultExport<T>()) const
+		{
+			dpl::export_container(binary, m_owners);
+			dpl::export_container(binary, m_slots);
+			dpl::export_t(binary, m_freeSlot);
+			for(const T& VALUE : m_values)
+			{
+				on_export(VALUE, binary);
+			}
+		}
+
+	private: // functions
+		static inline bool		is_occupied(	const Slot&			SLOT)
+		{
+			return (SLOT.generation & 1) != 0;
+		}
+
+		inline void				validate(		const Handle		HANDLE) const
+		{
+#ifdef _DEBUG
+			if(!contains(HANDLE))
+				throw GeneralException(this, __LINE__, "Invalid handle.");
+#endif // _DEBUG
+		}
+
+		inline uint32_t			acquire_slot()
+		{
+			if(m_freeSlot != INVALID_INDEX)
+			{
+				const uint32_t SLOT_INDEX = m_freeSlot;
+				m_freeSlot = m_slots[SLOT_INDEX].target;
+				return SLOT_INDEX;
+			}
+
+			if(m_slots.size() == INVALID_INDEX) throw GeneralException(this, __LINE__, "Too many slots.");
+			m_slots.push_back(Slot{INVALID_INDEX, 0});
+			return static_cast<uint32_t>(m_slots.size() - 1);
+		}
+
+		inline void				release_slot(	const uint32_t		SLOT_INDEX)
+		{
+			Slot&	slot			= m_slots[SLOT_INDEX];
+					slot.target		= m_freeSlot;
+					++slot.generation;
+			m_freeSlot = SLOT_INDEX;
+		}
+	};
+}
\ No newline at end of file
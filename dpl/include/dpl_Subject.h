@@ -2,7 +2,7 @@
 
 
 #include "dpl_Unique.h"
-#include "dpl_Chain.h"
+#include "dpl_PackedChain.h"
 #include "dpl_GeneralException.h"
 
 
@@ -23,19 +23,22 @@ namespace dpl
 {
 	/*
 		Observable object with build-in unique identifier.
+		Observers are notified in the order of the dense array of links(order of observation until any observer is removed).
 	*/
 	template<typename SubjectT>
 	class Subject	: public Unique<Subject<SubjectT>> 
-					, private Chain<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>
+					, private PackedChain<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>
 	{
 	private: // subtypes
 		using MyObserver	= Observer<SubjectT>;
 		using MyUnique		= Unique<Subject<SubjectT>>;
-		using MyChain		= Chain<Subject<SubjectT>, MyObserver, SUBJECT_CHAIN_ID>;
+		using MyChain		= PackedChain<Subject<SubjectT>, MyObserver, SUBJECT_CHAIN_ID>;
 
 	public: // relations
 		friend MyObserver;
 		friend MyChain;
+		friend Chain<Subject<SubjectT>, MyObserver, SUBJECT_CHAIN_ID>;
+		friend PackedLink<Subject<SubjectT>, MyObserver, SUBJECT_CHAIN_ID>;
 
 	protected: // lifecycle
 		CLASS_CTOR				Subject() = default;
@@ -85,7 +88,7 @@ namespace dpl
 		inline void				notify_observers()
 		{
 			SubjectT& subject = *cast();
-			MyChain::for_each_link([&](MyObserver& observer)
+			MyChain::for_each_packed([&](MyObserver& observer)
 			{
 				observer.on_update(subject);
 			});
@@ -119,16 +122,18 @@ namespace dpl
 		Person/device that observes the Subject.
 	*/
 	template<typename SubjectT>
-	class Observer : private Link<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>
+	class Observer : private PackedLink<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>
 	{
 	private: // subtypes
 		using MySubject = Subject<SubjectT>;
-		using MyBase	= Link<MySubject, Observer<SubjectT>, SUBJECT_CHAIN_ID>;
+		using MyBase	= PackedLink<MySubject, Observer<SubjectT>, SUBJECT_CHAIN_ID>;
 
 	public: // relations
 		friend MySubject;
 		friend MyBase;
+		friend Link<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>;
 		friend Chain<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>;
+		friend PackedChain<Subject<SubjectT>, Observer<SubjectT>, SUBJECT_CHAIN_ID>;
 		friend Sequenceable<Observer<SubjectT>, SUBJECT_CHAIN_ID>;
 
 	protected: // lifecycle
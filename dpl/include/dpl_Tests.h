@@ -0,0 +1,16 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+namespace dpl
+{
+	/*
+		Compares synchronous broadcast with events queued from NUM_PRODUCERS threads and delivered by flush.
+		Each test sends NUM_EVENTS events per producer, queue is flushed after every test(warm pool after the first one).
+	*/
+	void test_event_dispatch(	const uint32_t		NUM_EVENTS,
+								const uint32_t		NUM_PRODUCERS,
+								const uint32_t		NUM_TESTS);
+}
\ No newline at end of file
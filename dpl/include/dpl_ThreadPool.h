@@ -12,6 +12,7 @@
 #include "dpl_ReadOnly.h"
 #include "dpl_DynamicArray.h"
 #include "dpl_Logger.h"
+#include "dpl_Profiler.h"
 
 
 #pragma warning(disable : 26812)
@@ -58,7 +59,6 @@ namespace dpl
 
 	private: // data
 		mutable std::mutex			m_mtx;
-		std::thread::id				m_mainThreadID;
 		std::condition_variable		m_finished; // Notifies when worker finishes the task.
 		std::condition_variable		m_order;	// Notifies when there is a job to do, or when thread pool needs to terminate.
 		std::queue<Task>			m_tasks;
@@ -69,8 +69,7 @@ namespace dpl
 
 	public: // lifecycle
 		CLASS_CTOR							ThreadPool(							const uint32_t			NUM_THREADS = std::thread::hardware_concurrency())
-			: m_mainThreadID(std::this_thread::get_id())
-			, m_numTasks(0)
+			: m_numTasks(0)
 			, m_numWorkers(0)
 			, bTerminate(false)
 		{
@@ -140,8 +139,8 @@ namespace dpl
 		void								wait(								const ErrorCallback&	ERROR_CALLBACK = &log_and_throw_first_worker_error)
 		{
 #ifdef _DEBUG
-			if(std::this_thread::get_id() != m_mainThreadID)
-				push_error(std::numeric_limits<uint32_t>::max(), "ThreadPool::wait must be called in the main thread.");
+			if(current_pool() == this) // Worker would wait for itself.
+				push_error(std::numeric_limits<uint32_t>::max(), "ThreadPool::wait must not be called by the worker of the same pool.");
 #endif // _DEBUG
 
 			std::unique_lock lk(m_mtx);
@@ -174,6 +173,15 @@ namespace dpl
 		}
 
 	private: // functions
+		/*
+			Returns pool that owns the calling thread(nullptr if caller is not a worker).
+		*/
+		static inline const ThreadPool*&	current_pool()
+		{
+			thread_local const ThreadPool* pool = nullptr;
+			return pool;
+		}
+
 		template <class T>
 		inline std::reference_wrapper<T>	wrap(								T&						val)
 		{
@@ -198,6 +206,7 @@ namespace dpl
 		{
 			std::thread([&, WORKER_ID]
 			{
+				current_pool() = this;
 				{std::lock_guard lk(m_mtx);
 					++m_numWorkers;
 				}
@@ -359,10 +368,12 @@ namespace dpl
 
 		void			start(			const ErrorCallback&	ERROR_CALLBACK = &ThreadPool::log_and_throw_first_worker_error)
 		{
+			ProfileZone zone("ParallelPhase::start");
 			jobs.for_each([&](Job& job)
 			{
 				ThreadPool::add_task([&]()
 				{
+					ProfileZone jobZone("ParallelPhase::job");
 					for(auto& iTask : job.tasks)
 					{
 						iTask();
@@ -0,0 +1,75 @@
+#include "../include/dpl_MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace dpl
+{
+//=====> MappedFile public: // functions
+	bool		MappedFile::open(		const std::string&	FILE_PATH)
+	{
+		close();
+#ifdef _WIN32
+		const HANDLE FILE = CreateFileA(FILE_PATH.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(FILE == INVALID_HANDLE_VALUE) return false;
+		m_file = FILE;
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(FILE, &fileSize) || fileSize.QuadPart == 0) return close();
+
+		m_mapping = CreateFileMappingA(FILE, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(!m_mapping) return close();
+
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if(!m_data) return close();
+		m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		const int FILE = ::open(FILE_PATH.c_str(), O_RDONLY);
+		if(FILE < 0) return false;
+
+		struct stat fileInfo;
+		if(fstat(FILE, &fileInfo) != 0 || fileInfo.st_size == 0)
+		{
+			::close(FILE);
+			return false;
+		}
+
+		void* address = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, FILE, 0);
+		::close(FILE); //<-- Mapping stays valid after the descriptor is closed.
+		if(address == MAP_FAILED) return false;
+
+		m_data = static_cast<const uint8_t*>(address);
+		m_size = static_cast<size_t>(fileInfo.st_size);
+#endif
+		return true;
+	}
+
+	bool		MappedFile::close()
+	{
+#ifdef _WIN32
+		if(m_data)		UnmapViewOfFile(m_data);
+		if(m_mapping)	CloseHandle(m_mapping);
+		if(m_file)		CloseHandle(m_file);
+#else
+		if(m_data)		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+		m_data		= nullptr;
+		m_size		= 0;
+		m_file		= nullptr;
+		m_mapping	= nullptr;
+		return false;
+	}
+}
\ No newline at end of file
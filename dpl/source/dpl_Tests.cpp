@@ -0,0 +1,128 @@
+#include "../include/dpl_Tests.h"
+#include "../include/dpl_EventDispatcher.h"
+#include <optional>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+
+namespace dpl
+{
+	namespace
+	{
+		namespace TestData
+		{
+			struct	TestEvent : public EventType<TestEvent>
+			{
+				uint64_t value = 0;
+			};
+
+			class	TestReceiver : public BatchReceiver<TestEvent>
+			{
+			public: // data
+				uint64_t numEvents	= 0;
+				uint64_t sum		= 0;
+
+			public: // lifecycle
+				CLASS_CTOR		TestReceiver(	EventDispatcher&				dispatcher)
+					: BatchReceiver(dispatcher)
+				{
+
+				}
+
+				CLASS_DTOR		~TestReceiver()
+				{
+					disable();
+				}
+
+			private: // implementation
+				virtual void	on_events(		std::span<const TestEvent>		events) final override
+				{
+					numEvents += events.size();
+					for(const TestEvent& EVENT : events)
+					{
+						sum += EVENT.value;
+					}
+				}
+			};
+		}
+	}
+
+	void test_event_dispatch(	const uint32_t		NUM_EVENTS,
+								const uint32_t		NUM_PRODUCERS,
+								const uint32_t		NUM_TESTS)
+	{
+		using namespace TestData;
+
+		// EventDispatcher is a singleton: use the running one(if any), otherwise create a local one.
+		std::optional<EventDispatcher>	localDispatcher;
+		EventDispatcher*				dispatcherPtr = EventDispatcher::get();
+		if(!dispatcherPtr) dispatcherPtr = &localDispatcher.emplace();
+
+		EventDispatcher&	dispatcher = *dispatcherPtr;
+		TestReceiver		receiver(dispatcher);
+
+		const auto MEASURE = [&](const char* NAME, const auto& SEND)
+		{
+			receiver.numEvents	= 0;
+			receiver.sum		= 0;
+			double timeTotal	= 0.0;
+			for(uint32_t testID = 0; testID < NUM_TESTS; ++testID)
+			{
+				auto start	= std::chrono::steady_clock::now();
+				SEND();
+				dispatcher.flush();
+				auto end	= std::chrono::steady_clock::now();
+				timeTotal	+= std::chrono::duration<double, std::milli>(end - start).count();
+			}
+
+			const uint64_t EXPECTED = uint64_t(NUM_TESTS) * NUM_EVENTS * NUM_PRODUCERS;
+			std::cout << NAME << ": " << timeTotal / NUM_TESTS << "ms";
+			if(receiver.numEvents != EXPECTED) std::cout << " (lost " << EXPECTED - receiver.numEvents << " events)";
+			std::cout << std::endl;
+		};
+
+		const auto PRODUCE = [&](const bool QUEUED)
+		{
+			for(uint32_t eventID = 0; eventID < NUM_EVENTS; ++eventID)
+			{
+				TestEvent event;
+				event.value = eventID;
+				if(QUEUED)	dispatcher.enqueue(event);
+				else		dispatcher.broadcast(event);
+			}
+		};
+
+		std::cout << "events: " << NUM_EVENTS * NUM_PRODUCERS << std::endl;
+
+		MEASURE("broadcast", [&]()
+		{
+			for(uint32_t producerID = 0; producerID < NUM_PRODUCERS; ++producerID)
+			{
+				PRODUCE(false);
+			}
+		});
+
+		MEASURE("enqueue(1 thread)", [&]()
+		{
+			for(uint32_t producerID = 0; producerID < NUM_PRODUCERS; ++producerID)
+			{
+				PRODUCE(true);
+			}
+		});
+
+		MEASURE("enqueue(producers)", [&]()
+		{
+			std::vector<std::thread> producers;
+			for(uint32_t producerID = 0; producerID < NUM_PRODUCERS; ++producerID)
+			{
+				producers.emplace_back(PRODUCE, true);
+			}
+
+			for(std::thread& producer : producers)
+			{
+				producer.join();
+			}
+		});
+	}
+}
\ No newline at end of file